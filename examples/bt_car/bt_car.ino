@@ -62,6 +62,12 @@ SOFTWARE.
  */
 #define ENABLE_BT
 
+/**
+ * @brief Enable the labeled text debug output on the serial port.
+ *
+ */
+// #define ENABLE_DEBUG_TEXT
+
 /**
  * @brief Time interval for update cycle.
  *
@@ -74,6 +80,12 @@ SOFTWARE.
  */
 #define DEBUG_UPDATE_INTERVAL_MS 100
 
+/**
+ * @brief Update cycle lateness that stops the motors.
+ *
+ */
+#define LATENESS_BUDGET_MS 200
+
 #if defined(ENABLE_PID)
 
 /**
@@ -122,70 +134,16 @@ SOFTWARE.
 // #define BT_PIN "1234"
 
 /**
- * @brief Bluetooth Forward command.
- *
- */
-#define CMD_FORWARD 'F'
-
-/**
- * @brief Bluetooth Left turn command.
- *
- */
-#define CMD_LEFT_TURN 'L'
-
-/**
- * @brief Bluetooth Backward command.
- *
- */
-#define CMD_BACKWARD 'B'
-
-/**
- * @brief Bluetooth Right turn command.
- *
- */
-#define CMD_RIGHT_TURN 'R'
-
-/**
- * @brief Bluetooth Stop command.
- *
- */
-#define CMD_STOP 'S'
-
-/**
- * @brief Bluetooth Toggle M command.
- *
- */
-#define CMD_TOGGLE_M 'M'
-
-/**
- * @brief Bluetooth Toggle m command.
- *
- */
-#define CMD_TOGGLE_m 'm'
-
-/**
- * @brief Bluetooth Toggle N command.
+ * @brief Telemetry link budget in bytes per second.
  *
  */
-#define CMD_TOGGLE_N 'N'
+#define TELEMETRY_BUDGET_BPS 2000
 
 /**
- * @brief Bluetooth Toggle n command.
+ * @brief Telemetry channel id of the servo J position.
  *
  */
-#define CMD_TOGGLE_n 'n'
-
-/**
- * @brief Bluetooth Servo J position command.
- *
- */
-#define CMD_SERVO_J 'J'
-
-/**
- * @brief Bluetooth Servo K position command.
- *
- */
-#define CMD_SERVO_K 'K'
+#define TM_SERVO_J TM_USER
 
 #if !defined(CONFIG_BT_ENABLED) || !defined(CONFIG_BLUEDROID_ENABLED)
 #error Bluetooth is not enabled!Please run `make menu config` to and enable it
@@ -205,7 +163,7 @@ SOFTWARE.
 #define PWM_ABSOLUTE_MAX 255
 
 /**
- * @brief Motors PWM software limitation.
+ * @brief Motors PWM software limitation, the board configuration default.
  *
  */
 #define PWM_MAX 200
@@ -217,14 +175,6 @@ SOFTWARE.
 #define PWM_STEP 5
 #endif // ENABLE_MOTORS
 
-#if defined(ENABLE_SONAR_SERVO) || defined(ENABLE_BT)
-/**
- * @brief Sonar default servo position.
- *
- */
-#define DEFAULT_SERVO_POS 90
-#endif // defined(ENABLE_SONAR_SERVO) || defined(ENABLE_BT)
-
 #pragma endregion
 
 #pragma region Headers
@@ -255,10 +205,22 @@ SOFTWARE.
 void send_sensors();
 
 /**
- * @brief Read bluetooth commands.
+ * @brief Read the bluetooth and serial commands.
  *
  */
 void read_bt_serial();
+
+/**
+ * @brief Left encoder telemetry source.
+ *
+ */
+float get_left_encoder();
+
+/**
+ * @brief Right encoder telemetry source.
+ *
+ */
+float get_right_encoder();
 #endif // ENABLE_BT
 
 #if defined(ENABLE_MOTORS)
@@ -268,6 +230,12 @@ void read_bt_serial();
  */
 void update_direction_control();
 
+/**
+ * @brief Stop the motors when the update cycle runs too late.
+ *
+ */
+void safe_stop();
+
 /** @brief Interrupt Service Routine for handling left encoder.
  *  @return Void.
  */
@@ -279,18 +247,12 @@ void ISR_Left_Encoder();
 void ISR_Right_Encoder();
 #endif // ENABLE_MOTORS
 
-#pragma endregion
-
-#pragma region Enums
-
-enum Directions_t : uint8_t
-{
-    Stop = 0,
-    Forward = 1,
-    Backward = 2,
-    LeftTurn = 4,
-    RightTurn = 8
-};
+#if defined(ENABLE_SONAR)
+/** @brief Interrupt Service Routine for handling sonar echo.
+ *  @return Void.
+ */
+void ISR_Echo();
+#endif // ENABLE_SONAR
 
 #pragma endregion
 
@@ -311,34 +273,28 @@ int StateStatusLED_g = LOW;
 BluetoothSerial SerialBT_g;
 
 /**
- * @brief Received command.
- *
- */
-char RecvCmd_g;
-
-/**
- * @brief Bluetooth number parser.
+ * @brief Command router of the link and the serial port.
  *
  */
-String CmdNumPart_g = "";
+CommandRouter Commands_g;
 
 /**
- * @brief LED 1 flag.
+ * @brief Batched binary telemetry.
  *
  */
-bool LED1_g = false;
+Telemetry Telemetry_g;
 
 /**
- * @brief LED 2 flag.
+ * @brief Control link latency.
  *
  */
-bool LED2_g = false;
+LinkLatency Latency_g;
 
 /**
- * @brief Servo K position.
+ * @brief Latency percentiles sent with the telemetry.
  *
  */
-int ServoKPos_g = DEFAULT_SERVO_POS;
+LatencyReport_t LatencyReport_g;
 
 /**
  * @brief Measured temperature.
@@ -348,14 +304,6 @@ float Temp_g = 0.0;
 
 #endif // ENABLE_BT
 
-#if defined(ENABLE_MOTORS)
-/**
- * @brief Robot direction.
- *
- */
-Directions_t Direction_g;
-#endif // ENABLE_MOTORS
-
 #if defined(ENABLE_MOTORS) || defined(ENABLE_BT) || defined(ENABLE_PID)
 /**
  * @brief Left motor PWM.
@@ -377,14 +325,6 @@ double PWMRight_g = 0;
 Servo UsServo_g;
 #endif // ENABLE_SONAR_SERVO
 
-#if defined(ENABLE_SONAR_SERVO) || defined(ENABLE_BT)
-/**
- * @brief Servo J position.
- *
- */
-int SonarServoPos_g = DEFAULT_SERVO_POS;
-#endif // defined(ENABLE_SONAR_SERVO) || defined(ENABLE_BT)
-
 #if defined(ENABLE_SONAR) || defined(ENABLE_BT)
 /**
  * @brief Distance from sonar.
@@ -437,27 +377,33 @@ void setup()
     // Init serial
     Serial.begin(DEFAULT_BAUD);
 
+    // Load the stored board configuration over the board and sketch defaults.
+    BoardConfig_t DefaultsL;
+    BoardConfigClass::fillDefaults(&DefaultsL);
+#if defined(ENABLE_PID)
+    DefaultsL.Kp = CONST_P;
+    DefaultsL.Ki = CONST_I;
+    DefaultsL.Kd = CONST_D;
+#endif // ENABLE_PID
+#if defined(ENABLE_MOTORS)
+    DefaultsL.PwmMax = PWM_MAX;
+#endif // ENABLE_MOTORS
+    BoardConfig.begin(&DefaultsL);
+    const BoardConfig_t &ConfigL = BoardConfig.get();
+
 #if defined(ENABLE_MOTORS)
     // Attach the Interrupts to their ISR's
-    pinMode(PIN_LEFT_ENCODER, INPUT_PULLUP);
-    pinMode(PIN_RIGHT_ENCODER, INPUT_PULLUP);
+    pinMode(ConfigL.PinLeftEncoder, INPUT_PULLUP);
+    pinMode(ConfigL.PinRightEncoder, INPUT_PULLUP);
 
     // Increase counter 1 when speed sensor pin goes High.
-    attachInterrupt(digitalPinToInterrupt(PIN_LEFT_ENCODER), ISR_Left_Encoder, RISING);
+    attachInterrupt(digitalPinToInterrupt(ConfigL.PinLeftEncoder), ISR_Left_Encoder, RISING);
     // Increase counter 2 when speed sensor pin goes High.
-    attachInterrupt(digitalPinToInterrupt(PIN_RIGHT_ENCODER), ISR_Right_Encoder, RISING);
+    attachInterrupt(digitalPinToInterrupt(ConfigL.PinRightEncoder), ISR_Right_Encoder, RISING);
 
     // Setup the motor driver.
-    MotorModel_t MotorModelL = {
-        PIN_L_F,
-        PIN_L_B,
-        PIN_L_PWM,
-        PIN_R_F,
-        PIN_R_B,
-        PIN_R_PWM,
-        WHEEL_DIAMETER,
-        DISTANCE_BETWEEN_WHEELS,
-        ENCODER_TRACKS};
+    MotorModel_t MotorModelL;
+    BoardConfig.getMotorModel(&MotorModelL);
 
     // Initialize the motor controller.
     MotorController.init(&MotorModelL);
@@ -465,16 +411,19 @@ void setup()
 
 #if defined(ENABLE_SONAR_SERVO)
     // Attaches servo to the servo object.
-    UsServo_g.attach(PIN_US_SERVO);
+    UsServo_g.attach(ConfigL.PinUsServo);
 #endif // ENABLE_SONAR_SERVO
 
 #if defined(ENABLE_SONAR)
     // Initialize the ultrasonic.
-    HCSR04_g.init(PIN_US_TRIG, PIN_US_ECHO);
+    HCSR04_g.init(ConfigL.PinUsTrig, ConfigL.PinUsEcho);
+
+    // Timestamp both echo edges.
+    attachInterrupt(digitalPinToInterrupt(ConfigL.PinUsEcho), ISR_Echo, CHANGE);
 #endif // ENABLE_SONAR
 
 #if defined(ENABLE_STATUS_LED)
-    pinMode(PIN_USER_LED, OUTPUT);
+    pinMode(ConfigL.PinUserLed, OUTPUT);
 #endif // ENABLE_STATUS_LED
 
 #if defined(ENABLE_BT)
@@ -486,17 +435,47 @@ void setup()
 #endif // BT_PIN
 #endif // ENABLE_BT
 
+#if defined(ENABLE_BT)
+    // Register the car command handlers.
+    CarCommands.begin(Commands_g, &Telemetry_g, &Latency_g);
+
+    // Both transports share the handlers.
+    Commands_g.addTransport(SerialBT_g);
+    Commands_g.addTransport(Serial);
+
+    // Register the telemetry channels, the slow ones decimated.
+#if defined(ENABLE_PID)
+    // The wheel speed feedback exists only with the PID.
+    Telemetry_g.addChannel(TM_RPM_LEFT, &FBLeft_g, 10.0, 2);
+    Telemetry_g.addChannel(TM_RPM_RIGHT, &FBRight_g, 10.0, 2);
+#endif // ENABLE_PID
+    Telemetry_g.addChannel(TM_ENCODER_LEFT, get_left_encoder, 1.0, 4);
+    Telemetry_g.addChannel(TM_ENCODER_RIGHT, get_right_encoder, 1.0, 4);
+    Telemetry_g.addChannel(TM_PWM_LEFT, &PWMLeft_g, 1.0, 2);
+    Telemetry_g.addChannel(TM_PWM_RIGHT, &PWMRight_g, 1.0, 2);
+    Telemetry_g.addChannel(TM_SERVO_J, &CarCommands.get().ServoJ, 2, 5);
+    Telemetry_g.addChannel(TM_DISTANCE, &Distance_g, 10.0, 2, 2);
+    Telemetry_g.addChannel(TM_TEMPERATURE, &Temp_g, 10.0, 2, 10);
+    Telemetry_g.addChannel(TM_RTT_P50, &LatencyReport_g.RttP50, 10.0, 2, 5);
+    Telemetry_g.addChannel(TM_RTT_P95, &LatencyReport_g.RttP95, 10.0, 2, 5);
+    Telemetry_g.addChannel(TM_AGE_P50, &LatencyReport_g.AgeP50, 10.0, 2, 5);
+    Telemetry_g.addChannel(TM_AGE_P95, &LatencyReport_g.AgeP95, 10.0, 2, 5);
+    Telemetry_g.addChannel(TM_ACTUATION_P50, &LatencyReport_g.ActuationP50, 10.0, 2, 5);
+    Telemetry_g.addChannel(TM_ACTUATION_P95, &LatencyReport_g.ActuationP95, 10.0, 2, 5);
+    Telemetry_g.setBudget(TELEMETRY_BUDGET_BPS);
+#endif // ENABLE_BT
+
 #if defined(ENABLE_PID)
     // Set the PID regulators.
-    PIDLeft_g = new PID(&FBLeft_g, &OutLeft_g, &PWMLeft_g, CONST_P, CONST_I, CONST_D, DIRECT);
+    PIDLeft_g = new PID(&FBLeft_g, &OutLeft_g, &PWMLeft_g, ConfigL.Kp, ConfigL.Ki, ConfigL.Kd, DIRECT);
     PIDLeft_g->SetMode(AUTOMATIC);
     PIDLeft_g->SetSampleTime(PID_UPDATE_INTERVAL_MS);
-    PIDLeft_g->SetOutputLimits(-PWM_MAX, PWM_MAX);
+    PIDLeft_g->SetOutputLimits(-ConfigL.PwmMax, ConfigL.PwmMax);
 
-    PIDRight_g = new PID(&FBRight_g, &OutRight_g, &PWMRight_g, CONST_P, CONST_I, CONST_D, DIRECT);
+    PIDRight_g = new PID(&FBRight_g, &OutRight_g, &PWMRight_g, ConfigL.Kp, ConfigL.Ki, ConfigL.Kd, DIRECT);
     PIDRight_g->SetMode(AUTOMATIC);
     PIDRight_g->SetSampleTime(PID_UPDATE_INTERVAL_MS);
-    PIDRight_g->SetOutputLimits(-PWM_MAX, PWM_MAX);
+    PIDRight_g->SetOutputLimits(-ConfigL.PwmMax, ConfigL.PwmMax);
 #endif // ENABLE_PID
 
     UpdateTimer_g = new FxTimer();
@@ -506,6 +485,12 @@ void setup()
     SendTimer_g = new FxTimer();
     SendTimer_g->setExpirationTime(DEBUG_UPDATE_INTERVAL_MS);
     SendTimer_g->updateLastTime();
+
+    // Supervise the update cycle.
+    LoopMonitor.init(UPDATE_INTERVAL_MS, LATENESS_BUDGET_MS);
+#if defined(ENABLE_MOTORS)
+    LoopMonitor.setCbSafeStop(safe_stop);
+#endif // ENABLE_MOTORS
 }
 
 void loop()
@@ -523,9 +508,17 @@ void loop()
         UpdateTimer_g->updateLastTime();
         UpdateTimer_g->clear();
 
+        // Account the cycle lateness.
+        LoopMonitor.tick();
+
 #if defined(ENABLE_SONAR)
-        long MicrosecL = HCSR04_g.timing();
-        Distance_g = HCSR04_g.convert(MicrosecL, HCSR04::CM);
+        // Collect the last echo and start the next measurement.
+        long MicrosecL;
+        if (HCSR04_g.poll(&MicrosecL))
+        {
+            Distance_g = HCSR04_g.convert(MicrosecL, HCSR04::CM);
+        }
+        HCSR04_g.trigger();
 #endif // ENABLE_SONAR
 
 #if defined(ENABLE_BT)
@@ -560,15 +553,20 @@ void loop()
 #endif // ENABLE_MOTORS
 #endif // ENABLE_PID
 
+#if defined(ENABLE_MOTORS) && defined(ENABLE_BT)
+        // The newest command is on the motors now.
+        Latency_g.actuated();
+#endif // defined(ENABLE_MOTORS) && defined(ENABLE_BT)
+
 #if defined(ENABLE_SONAR_SERVO)
         // Set servo J position.
-        UsServo_g.write(int(map(SonarServoPos_g, 0, 180, 180, 0)));
+        UsServo_g.write(int(map(CarCommands.get().ServoJ, 0, 180, 180, 0)));
 #endif // ENABLE_SONAR_SERVO
 
 #if defined(ENABLE_STATUS_LED)
         // set the LED with the StateStatusLED_g of the variable:
         StateStatusLED_g = !StateStatusLED_g;
-        digitalWrite(PIN_USER_LED, StateStatusLED_g);
+        digitalWrite(BoardConfig.get().PinUserLed, StateStatusLED_g);
 #endif // ENABLE_STATUS_LED
     }
 
@@ -578,6 +576,7 @@ void loop()
         SendTimer_g->updateLastTime();
         SendTimer_g->clear();
 
+#if defined(ENABLE_DEBUG_TEXT)
 #if defined(ENABLE_PID)
 #if defined(ENABLE_MOTORS)
         Serial.print("PWMLeft_g:");
@@ -608,6 +607,7 @@ void loop()
 #endif // ENABLE_MOTORS
 #endif // ENABLE_PID
         Serial.println();
+#endif // ENABLE_DEBUG_TEXT
     }
 }
 
@@ -620,88 +620,45 @@ void loop()
  */
 void send_sensors()
 {
-    SerialBT_g.print("D");
-    SerialBT_g.println(Distance_g);
-    SerialBT_g.print("T");
-    SerialBT_g.println(Temp_g);
+    if (!SerialBT_g.hasClient())
+    {
+        return;
+    }
+
+    // Measure the round trip and refresh the percentiles.
+    Latency_g.ping(SerialBT_g);
+    Latency_g.report(&LatencyReport_g);
+
+    // One frame per cycle, the budget drops the ones the link has no room for.
+    Telemetry_g.update(SerialBT_g);
 }
 
 /**
- * @brief Read bluetooth commands.
+ * @brief Read the bluetooth and serial commands.
  *
  */
 void read_bt_serial()
 {
-    if (Serial.available())
-    {
-        SerialBT_g.write(Serial.read());
-    }
+    // Parse in place, the handlers run as the frames complete.
+    Commands_g.update();
+}
 
-    while (SerialBT_g.available() > 0)
-    {
-        String LineL = SerialBT_g.readStringUntil('\n');
-        Serial.printf("code received: %s\n", LineL);
-        CmdNumPart_g = "";
-        for (int index = 0; index < LineL.length(); index++)
-        {
-            int CharacterL = LineL[index];
-            if (isDigit(CharacterL))
-            {
-                CmdNumPart_g += (char)CharacterL;
-            }
-            else if (CharacterL != '\n')
-            {
-                RecvCmd_g = CharacterL;
-            }
-            else
-            {
-                break;
-            }
-        }
-    }
+/**
+ * @brief Left encoder telemetry source.
+ *
+ */
+float get_left_encoder()
+{
+    return MotorController.GetLeftEncoder();
+}
 
-    switch (RecvCmd_g)
-    {
-    case CMD_FORWARD:
-        Direction_g = Directions_t::Forward;
-        break;
-    case CMD_LEFT_TURN:
-        Direction_g = Directions_t::LeftTurn;
-        break;
-    case CMD_BACKWARD:
-        Direction_g = Directions_t::Backward;
-        break;
-    case CMD_RIGHT_TURN:
-        Direction_g = Directions_t::RightTurn;
-        break;
-    case CMD_STOP:
-        Direction_g = Directions_t::Stop;
-        break;
-    case CMD_TOGGLE_M:
-        LED1_g = true;
-        break;
-    case CMD_TOGGLE_m:
-        LED1_g = false;
-        break;
-    case CMD_TOGGLE_N:
-        LED2_g = true;
-        break;
-    case CMD_TOGGLE_n:
-        LED2_g = false;
-        break;
-    case CMD_SERVO_J:
-        if (CmdNumPart_g != "")
-        {
-            SonarServoPos_g = CmdNumPart_g.toInt();
-        }
-        break;
-    case CMD_SERVO_K:
-        if (CmdNumPart_g != "")
-        {
-            ServoKPos_g = CmdNumPart_g.toInt();
-        }
-        break;
-    }
+/**
+ * @brief Right encoder telemetry source.
+ *
+ */
+float get_right_encoder()
+{
+    return MotorController.GetRightEncoder();
 }
 #endif // ENABLE_BT
 
@@ -712,36 +669,39 @@ void read_bt_serial()
  */
 void update_direction_control()
 {
-    if (Direction_g == Directions_t::Forward)
+    // Cached at boot, a field read.
+    const int16_t PwmMaxL = BoardConfig.get().PwmMax;
+
+    if (CarCommands.get().Direction == Directions_t::Forward)
     {
         PWMLeft_g += PWM_STEP;
         PWMRight_g += PWM_STEP;
     }
-    else if (Direction_g == Directions_t::Backward)
+    else if (CarCommands.get().Direction == Directions_t::Backward)
     {
         PWMLeft_g -= PWM_STEP;
         PWMRight_g -= PWM_STEP;
     }
-    else if (Direction_g == Directions_t::LeftTurn)
+    else if (CarCommands.get().Direction == Directions_t::LeftTurn)
     {
         PWMLeft_g -= PWM_STEP;
         PWMRight_g += PWM_STEP;
     }
-    else if (Direction_g == Directions_t::RightTurn)
+    else if (CarCommands.get().Direction == Directions_t::RightTurn)
     {
         PWMLeft_g += PWM_STEP;
         PWMRight_g -= PWM_STEP;
     }
-    else if (Direction_g == Directions_t::Stop)
+    else if (CarCommands.get().Direction == Directions_t::Stop)
     {
         PWMLeft_g = 0;
         PWMRight_g = 0;
     }
 
     // Limit Left PWM.
-    if (PWMLeft_g > PWM_MAX)
+    if (PWMLeft_g > PwmMaxL)
     {
-        PWMLeft_g = PWM_MAX;
+        PWMLeft_g = PwmMaxL;
     }
     // Limit Left PWM by absolute maximum.
     if (PWMLeft_g > PWM_ABSOLUTE_MAX)
@@ -749,9 +709,9 @@ void update_direction_control()
         PWMLeft_g = PWM_ABSOLUTE_MAX;
     }
     // Limit Left PWM.
-    if (PWMLeft_g < -PWM_MAX)
+    if (PWMLeft_g < -PwmMaxL)
     {
-        PWMLeft_g = -PWM_MAX;
+        PWMLeft_g = -PwmMaxL;
     }
     // Limit Left PWM by absolute maximum.
     if (PWMLeft_g < -PWM_ABSOLUTE_MAX)
@@ -760,9 +720,9 @@ void update_direction_control()
     }
 
     // Limit Right PWM.
-    if (PWMRight_g > PWM_MAX)
+    if (PWMRight_g > PwmMaxL)
     {
-        PWMRight_g = PWM_MAX;
+        PWMRight_g = PwmMaxL;
     }
     // Limit Right PWM by absolute maximum.
     if (PWMRight_g > PWM_ABSOLUTE_MAX)
@@ -770,9 +730,9 @@ void update_direction_control()
         PWMRight_g = PWM_ABSOLUTE_MAX;
     }
     // Limit Right PWM.
-    if (PWMRight_g < -PWM_MAX)
+    if (PWMRight_g < -PwmMaxL)
     {
-        PWMRight_g = -PWM_MAX;
+        PWMRight_g = -PwmMaxL;
     }
     // Limit Right PWM by absolute maximum.
     if (PWMRight_g < -PWM_ABSOLUTE_MAX)
@@ -781,6 +741,18 @@ void update_direction_control()
     }
 }
 
+/**
+ * @brief Stop the motors when the update cycle runs too late.
+ *
+ */
+void safe_stop()
+{
+    // Restart the ramp from zero.
+    PWMLeft_g = 0;
+    PWMRight_g = 0;
+    MotorController.SetPWM(0, 0);
+}
+
 /** @brief Interrupt Service Routine for handling left encoder.
  *  @return Void.
  */
@@ -798,4 +770,14 @@ void ISR_Right_Encoder()
 }
 #endif // ENABLE_MOTORS
 
+#if defined(ENABLE_SONAR)
+/** @brief Interrupt Service Routine for handling sonar echo.
+ *  @return Void.
+ */
+void ISR_Echo()
+{
+    HCSR04_g.echoISR();
+}
+#endif // ENABLE_SONAR
+
 #pragma endregion
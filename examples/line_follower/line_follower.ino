@@ -32,8 +32,58 @@ SOFTWARE.
 /** @brief Dead zone of the joystick. */
 #define DEAD_ZONE 10
 
-/** @brief Throttle input. */
+#if !defined(PIN_THROTTLE)
+/** @brief Throttle input, on the UNO map A3 is the fourth line sensor. */
 #define PIN_THROTTLE A3
+#endif // PIN_THROTTLE
+
+/** @brief Throttle knob fitted on PIN_THROTTLE, without it the lap profile alone caps the speed. */
+// #define USE_THROTTLE_KNOB
+
+/** @brief Throttle knob dead band around the centre, it stops the robot. */
+#define THROTTLE_DEAD_BAND 20
+
+/** @brief Loop cycle time that stops the motors. */
+#define LATENESS_BUDGET_MS 50
+
+/** @brief Line lost time that stops the robot. */
+#define LINE_LOST_TIMEOUT_MS 250
+
+/** @brief Wheel PWM limit. */
+#define SPEED_MAX 255
+
+/** @brief Steering projection ahead of the sensors in mm. */
+#define LOOKAHEAD_MM 40.0
+
+/** @brief Forward speed per PWM step in mm/s, measure it on the robot. */
+#define SPEED_MMS_PER_PWM 8.8
+
+/** @brief Lowest planned PWM, the motors stall below it. */
+#define MIN_SPEED_PWM 40
+
+/** @brief Lateral acceleration limit in mm/s^2, about what the tyres hold. */
+#define LATERAL_ACCEL 6000.0
+
+/** @brief Forward acceleration limit in mm/s^2. */
+#define FORWARD_ACCEL 4000.0
+
+/** @brief Braking limit of the lap profile in mm/s^2. */
+#define BRAKE_DECEL 6000.0
+
+/** @brief Lap profile read ahead of the robot in mm, it covers the motor lag. */
+#define PROFILE_LEAD_MM 100.0
+
+/** @brief Line error kept at full speed. */
+#define SAFE_LINE_ERROR 0.5
+
+/** @brief Speed ratio left when the line is at the edge of the sensors. */
+#define MIN_SPEED_RATIO 0.4
+
+/** @brief I/O capture channel of the user button. */
+#define CAPTURE_CH_BUTTON 0
+
+/** @brief I/O capture channel of the throttle. */
+#define CAPTURE_CH_THROTTLE 1
 
 #pragma endregion
 
@@ -90,12 +140,24 @@ int Throttle_g = 512;
 /* @brief Safety flag. */
 bool SafetyFlag_g = false;
 
-/* @brief XY data value. */
-XYData_t XYData_g;
-
 /* @brief LR data value. */
 LRData_t LRData_g;
 
+/* @brief Line following controller. */
+LineFollower LineFollower_g;
+
+/* @brief Curvature aware speed planner. */
+SpeedPlanner SpeedPlanner_g;
+
+/* @brief Track learning and lap speed profile. */
+TrackMapper TrackMapper_g;
+
+/* @brief Steering gains at standstill. */
+const LineFollowerGains_t GainsSlow_g = {60.0, 0.0, 2.0};
+
+/* @brief Steering gains at the speed limit. */
+const LineFollowerGains_t GainsFast_g = {220.0, 0.0, 12.0};
+
 #pragma endregion
 
 #pragma region Prototypes Functions
@@ -117,6 +179,17 @@ void ISR_Left_Encoder();
  */
 void ISR_Right_Encoder();
 
+/** @brief Stop the robot when the loop runs too late.
+ *  @return Void.
+ */
+void safe_stop();
+
+/** @brief Convert encoder steps to travelled distance.
+ *  @param steps long, Encoder steps.
+ *  @return float, Distance in mm.
+ */
+float steps_to_mm(long steps);
+
 #pragma endregion
 
 /**
@@ -152,6 +225,23 @@ void setup()
 	LineSensor.setCbReadSensor(readSensor);
 	LineSensor.setInvertedReadings(false);
 
+	// Steer the wheels from the line position.
+	LineFollower_g.init(LINE_SENSORS_COUNT, LineSensor.getResolution(), LINE_SENSORS_PITCH);
+	LineFollower_g.setGains(GainsSlow_g, GainsFast_g);
+	LineFollower_g.setMaxSpeed(SPEED_MAX);
+	LineFollower_g.setLookahead(LOOKAHEAD_MM);
+
+	// Plan the forward speed on the curvature.
+	SpeedPlanner_g.init(DISTANCE_BETWEEN_WHEELS);
+	SpeedPlanner_g.setLimits(SPEED_MAX * SPEED_MMS_PER_PWM, LATERAL_ACCEL, FORWARD_ACCEL);
+	SpeedPlanner_g.setMinSpeed(MIN_SPEED_PWM * SPEED_MMS_PER_PWM);
+	SpeedPlanner_g.setRisk(SAFE_LINE_ERROR, MIN_SPEED_RATIO);
+
+	// Learn the track on the first lap.
+	TrackMapper_g.init(DISTANCE_BETWEEN_WHEELS);
+	TrackMapper_g.setLimits(SPEED_MAX * SPEED_MMS_PER_PWM, LATERAL_ACCEL, FORWARD_ACCEL, BRAKE_DECEL);
+	TrackMapper_g.setLead(PROFILE_LEAD_MM);
+
 	// Initialize the ultrasonic servo.
 	// USServo_g.attach(PIN_US_SERVO);
 	// USServo_g.write(90);
@@ -162,6 +252,10 @@ void setup()
 	// Set user interaction.
 	pinMode(PIN_USER_LED, OUTPUT);
 	digitalWrite(PIN_USER_LED, LOW);
+
+	// Supervise the unpaced loop cycle time.
+	LoopMonitor.init(0, LATENESS_BUDGET_MS);
+	LoopMonitor.setCbSafeStop(safe_stop);
 }
 
 /**
@@ -171,6 +265,16 @@ void setup()
 void loop()
 {
 	static int CalibrationL = 0;
+	static unsigned long LineTimeL = 0;
+
+	LoopMonitor.tick();
+
+	// The user inputs go through the capture, a replay sees the same.
+	UserButtonState_g = CAPTURE_INPUT(CAPTURE_CH_BUTTON, UserButtonState_g);
+#if defined(USE_THROTTLE_KNOB)
+	Throttle_g = analogRead(PIN_THROTTLE);
+#endif // USE_THROTTLE_KNOB
+	Throttle_g = CAPTURE_INPUT(CAPTURE_CH_THROTTLE, Throttle_g);
 
 	LineSensor.update();
 
@@ -194,6 +298,9 @@ void loop()
 		else
 		{
 			CalibrationL = 0;
+
+			// Follow the ambient light drift from now on.
+			LineSensor.setTracking(true);
 			AppStateFlag_g = ApplicationState::WaitForStart;
 		}
 	}
@@ -201,6 +308,10 @@ void loop()
 	{
 		if (UserButtonState_g == LOW)
 		{
+			LineFollower_g.reset();
+			SpeedPlanner_g.reset();
+			TrackMapper_g.reset();
+			LineTimeL = CAPTURE_MILLIS();
 			AppStateFlag_g = ApplicationState::Run;
 		}
 	}
@@ -221,22 +332,37 @@ void loop()
 		// Get Road conditions.
 		LinePosition_g = LineSensor.getLinePosition();
 
-		if (LinePosition_g > 1000)
+		// Off the line the position holds the last side, steer back for a while.
+		if (LineSensor.getOnTheLine())
+		{
+			LineTimeL = CAPTURE_MILLIS();
+		}
+		else if (CAPTURE_MILLIS() - LineTimeL > LINE_LOST_TIMEOUT_MS)
 		{
 			AppStateFlag_g = ApplicationState::SafetyStop;
 			return;
 		}
 
-		// Throttle_g = analogRead(PIN_THROTTLE);
-		if (Throttle_g < 512 + 20 && Throttle_g > 512 - 20)
-		{
-			Throttle_g = 512;
-		}
-		XYData_g.X = map(LinePosition_g, 700, 0, 0, 1023);
-		XYData_g.Y = Throttle_g;
+		float LeftL = steps_to_mm(MotorController.GetLeftEncoder());
+		float RightL = steps_to_mm(MotorController.GetRightEncoder());
+
+		// Map the first lap, the next ones run its speed profile.
+		TrackMapper_g.update(LeftL, RightL, LineFollower_g.getError());
 
-		// Convert X and  data to Left and Right PWM data.
-		LRData_g = xy_to_lr(XYData_g);
+		// The throttle knob and the lap profile cap the planned speed.
+		float MaxSpeedL = SPEED_MAX * SPEED_MMS_PER_PWM;
+#if defined(USE_THROTTLE_KNOB)
+		// Forward is below the centre as in xy_to_lr(), the centre and the
+		// dead band stop, the cap grows to the planner limit at the end.
+		MaxSpeedL *= constrain((512 - THROTTLE_DEAD_BAND - Throttle_g) / (512.0f - THROTTLE_DEAD_BAND), 0.0f, 1.0f);
+#endif // USE_THROTTLE_KNOB
+		SpeedPlanner_g.setMaxSpeed(min(MaxSpeedL, TrackMapper_g.getSpeed()));
+
+		// Plan on the line angle and error of the previous frame.
+		float SpeedL = SpeedPlanner_g.update(LeftL, RightL, LineFollower_g.getAngle(), LineFollower_g.getError());
+
+		// Convert the line position to Left and Right PWM data.
+		LRData_g = LineFollower_g.update(LinePosition_g, SpeedL / SPEED_MMS_PER_PWM, (LeftL + RightL) / 2.0);
 
 		// Control the robot.
 		MotorController.SetPWM(LRData_g.L, LRData_g.R);
@@ -269,6 +395,28 @@ uint16_t readSensor(int index)
 	return analogRead(PinsLineSensor_g[index]);
 }
 
+/** @brief Stop the robot when the loop runs too late.
+ *  @return Void.
+ */
+void safe_stop()
+{
+	if (AppStateFlag_g == ApplicationState::Run)
+	{
+		AppStateFlag_g = ApplicationState::SafetyStop;
+		SafetyFlag_g = true;
+		MotorController.SetPWM(0, 0);
+	}
+}
+
+/** @brief Convert encoder steps to travelled distance.
+ *  @param steps long, Encoder steps.
+ *  @return float, Distance in mm.
+ */
+float steps_to_mm(long steps)
+{
+	return steps * (WHEEL_DIAMETER * PI / ENCODER_TRACKS);
+}
+
 /** @brief Interrupt Service Routine for handling left encoder.
  *  @return Void.
  */
@@ -212,6 +212,11 @@ void loop()
       LinePosPrev_g = LinePosCur_g;
     }
   }
+
+#ifdef DEBUG_TEXT
+  // Send the queued log records while the UART has room.
+  drain_debug_port();
+#endif
 }
 
 #pragma region Functions
@@ -36,6 +36,12 @@ SOFTWARE.
  */
 #define BLINK_INTERVAL_MS 2000
 
+/**
+ * @brief Time interval for servo sweep step.
+ *
+ */
+#define SWEEP_INTERVAL_MS 30
+
 #pragma endregion
 
 #pragma region Headers
@@ -54,6 +60,22 @@ SOFTWARE.
 
 #pragma endregion
 
+#pragma region Functions Prototypes
+
+/**
+ * @brief Blink the status LED.
+ *
+ */
+void blink_task();
+
+/**
+ * @brief Move the servo one step.
+ *
+ */
+void sweep_task();
+
+#pragma endregion
+
 #pragma region Variables
 
 /**
@@ -76,16 +98,6 @@ int ServoDirection_g = 0;
  */
 int StateStatusLED_g = LOW;
 
-/**
- * @brief Blink timer instance.
- */
-FxTimer *BlinkTimer_g;
-
-/**
- * @brief Send timer instance.
- */
-FxTimer *ServoSweepTimer;
-
 #pragma endregion
 
 void setup()
@@ -97,62 +109,64 @@ void setup()
 
   pinMode(PIN_USER_LED, OUTPUT);
 
-  BlinkTimer_g = new FxTimer();
-  BlinkTimer_g->setExpirationTime(BLINK_INTERVAL_MS);
-  BlinkTimer_g->updateLastTime();
-
-  ServoSweepTimer = new FxTimer();
-  ServoSweepTimer->setExpirationTime(30);
-  ServoSweepTimer->updateLastTime();
+  // The sweep runs before the blink when both are due.
+  CoopScheduler.addTask(blink_task, BLINK_INTERVAL_MS * 1000UL, 0, 0);
+  CoopScheduler.addTask(sweep_task, SWEEP_INTERVAL_MS * 1000UL, 0, 1);
 }
 
 void loop()
 {
-  BlinkTimer_g->update();
-  if (BlinkTimer_g->expired())
-  {
-    BlinkTimer_g->updateLastTime();
-    BlinkTimer_g->clear();
+  CoopScheduler.run();
+}
 
-    // set the LED with the StateStatusLED_g of the variable:
-    StateStatusLED_g = !StateStatusLED_g;
-    digitalWrite(PIN_USER_LED, StateStatusLED_g);
-  }
+#pragma region Functions
 
-  ServoSweepTimer->update();
-  if (ServoSweepTimer->expired())
+/**
+ * @brief Blink the status LED.
+ *
+ */
+void blink_task()
+{
+  // set the LED with the StateStatusLED_g of the variable:
+  StateStatusLED_g = !StateStatusLED_g;
+  digitalWrite(PIN_USER_LED, StateStatusLED_g);
+}
+
+/**
+ * @brief Move the servo one step.
+ *
+ */
+void sweep_task()
+{
+  if (ServoDirection_g == 0)
   {
-    ServoSweepTimer->updateLastTime();
-    ServoSweepTimer->clear();
+    // Increment position with one degree.
+    ServoPosition_g++;
 
-    if (ServoDirection_g == 0)
+    if (ServoPosition_g == 180)
     {
-      // Increment position with one degree.
-      ServoPosition_g++;
-
-      if (ServoPosition_g == 180)
-      {
-        // Turn the other direction.
-        ServoDirection_g = 1;
-      }
+      // Turn the other direction.
+      ServoDirection_g = 1;
     }
+  }
+
+  if (ServoDirection_g == 1)
+  {
+    // Increment position with one degree.
+    ServoPosition_g--;
 
-    if (ServoDirection_g == 1)
+    if (ServoPosition_g == 0)
     {
-      // Increment position with one degree.
-      ServoPosition_g--;
-
-      if (ServoPosition_g == 0)
-      {
-        // Turn the other direction.
-        ServoDirection_g = 0;
-      }
+      // Turn the other direction.
+      ServoDirection_g = 0;
     }
+  }
 
-    // tell servo to go to position in variable 'pos'
-    UsServo_g.write(ServoPosition_g);
+  // tell servo to go to position in variable 'pos'
+  UsServo_g.write(ServoPosition_g);
 
-    Serial.print("ServoPosition:");
-    Serial.println(ServoPosition_g);
-  }
+  Serial.print("ServoPosition:");
+  Serial.println(ServoPosition_g);
 }
+
+#pragma endregion
@@ -54,22 +54,28 @@ SOFTWARE.
 
 #pragma endregion
 
-#pragma region Variables
+#pragma region Functions Prototypes
 
-/**
- * @brief Create servo object to control a servo.
+/** @brief Servo write callback function.
+ *
+ *  @param angle int, Servo angle in degrees.
+ *  @return Void.
  */
-Servo UsServo_g;
+void write_servo(int angle);
 
-/**
- * @brief Variable to store the servo position.
+/** @brief Interrupt Service Routine for handling sonar echo.
+ *  @return Void.
  */
-int ServoPosition_g = 0;
+void ISR_Echo();
+
+#pragma endregion
+
+#pragma region Variables
 
 /**
- * @brief Variable to store the servo position.
+ * @brief Create servo object to control a servo.
  */
-int ServoDirection_g = 0;
+Servo UsServo_g;
 
 /**
  * @brief StateStatusLED_g used to set the LED.
@@ -81,21 +87,11 @@ int StateStatusLED_g = LOW;
  */
 FxTimer *BlinkTimer_g;
 
-/**
- * @brief Send timer instance.
- */
-FxTimer *ServoSweepTimer;
-
 /**
  * @brief Ultrasonic sensor.
  */
 HCSR04 HCSR04_g;
 
-/**
- * @brief Ultra sonic sensor distance value.
- */
-float USDistance_g = 200;
-
 #pragma endregion
 
 void setup()
@@ -109,14 +105,21 @@ void setup()
 
   // Initialize the ultrasonic.
   HCSR04_g.init(PIN_US_TRIG, PIN_US_ECHO);
+#if defined(__AVR_ATmega328P__)
+  // The echo pin D12 has no external interrupt on the UNO, use its pin change interrupt.
+  *digitalPinToPCMSK(PIN_US_ECHO) |= bit(digitalPinToPCMSKbit(PIN_US_ECHO));
+  PCIFR |= bit(digitalPinToPCICRbit(PIN_US_ECHO));
+  PCICR |= bit(digitalPinToPCICRbit(PIN_US_ECHO));
+#else
+  attachInterrupt(digitalPinToInterrupt(PIN_US_ECHO), ISR_Echo, CHANGE);
+#endif
+
+  // Sweep from 0 to 180 degrees with one degree step.
+  SonarScanner.init(&HCSR04_g, write_servo, 0, 180, 1);
 
   BlinkTimer_g = new FxTimer();
   BlinkTimer_g->setExpirationTime(BLINK_INTERVAL_MS);
   BlinkTimer_g->updateLastTime();
-
-  ServoSweepTimer = new FxTimer();
-  ServoSweepTimer->setExpirationTime(100);
-  ServoSweepTimer->updateLastTime();
 }
 
 void loop()
@@ -132,46 +135,46 @@ void loop()
     digitalWrite(PIN_USER_LED, StateStatusLED_g);
   }
 
-  ServoSweepTimer->update();
-  if (ServoSweepTimer->expired())
+  if (SonarScanner.update())
   {
-    ServoSweepTimer->updateLastTime();
-    ServoSweepTimer->clear();
-
-    if (ServoDirection_g == 0)
-    {
-      // Increment position with one degree.
-      ServoPosition_g++;
-
-      if (ServoPosition_g == 180)
-      {
-        // Turn the other direction.
-        ServoDirection_g = 1;
-      }
-    }
-
-    if (ServoDirection_g == 1)
-    {
-      // Increment position with one degree.
-      ServoPosition_g--;
-
-      if (ServoPosition_g == 0)
-      {
-        // Turn the other direction.
-        ServoDirection_g = 0;
-      }
-    }
-
-    // tell servo to go to position in variable 'pos'
-    UsServo_g.write(ServoPosition_g);
-
-    long microsec = HCSR04_g.timing();
-    USDistance_g = HCSR04_g.convert(microsec, HCSR04::CM);
+    uint8_t BinL = SonarScanner.getLastBin();
 
     Serial.print("Distance:");
-    Serial.print(USDistance_g);
+    Serial.print(SonarScanner.getRange(BinL) / 10.0);
     Serial.print(",");
     Serial.print("ServoPosition:");
-    Serial.println(ServoPosition_g);
+    Serial.println(SonarScanner.getAngle(BinL));
   }
 }
+
+#pragma region Functions
+
+/** @brief Servo write callback function.
+ *
+ *  @param angle int, Servo angle in degrees.
+ *  @return Void.
+ */
+void write_servo(int angle)
+{
+  UsServo_g.write(angle);
+}
+
+/** @brief Interrupt Service Routine for handling sonar echo.
+ *  @return Void.
+ */
+void ISR_Echo()
+{
+  HCSR04_g.echoISR();
+}
+
+#if defined(__AVR_ATmega328P__)
+/** @brief Pin change interrupt of D8 to D13, only the echo pin is enabled.
+ *  @return Void.
+ */
+ISR(PCINT0_vect)
+{
+  ISR_Echo();
+}
+#endif
+
+#pragma endregion
@@ -62,6 +62,18 @@ SOFTWARE.
  */
 #define ENABLE_WIFI
 
+/**
+ * @brief Enable the UDP control channel, the newest command wins.
+ *
+ */
+#define ENABLE_UDP_CONTROL
+
+/**
+ * @brief Enable the labeled text debug output on the serial port.
+ *
+ */
+// #define ENABLE_DEBUG_TEXT
+
 /**
  * @brief Time interval for update cycle.
  *
@@ -74,6 +86,12 @@ SOFTWARE.
  */
 #define DEBUG_UPDATE_INTERVAL_MS 100
 
+/**
+ * @brief Update cycle lateness that stops the motors.
+ *
+ */
+#define LATENESS_BUDGET_MS 200
+
 #if defined(ENABLE_PID)
 
 /**
@@ -111,70 +129,34 @@ SOFTWARE.
 #define SERVICE_PORT 50123
 
 /**
- * @brief Forward command.
+ * @brief UDP control port.
  *
  */
-#define CMD_FORWARD 'F'
+#define CONTROL_PORT 50124
 
 /**
- * @brief Left turn command.
+ * @brief Remote link transport index.
  *
  */
-#define CMD_LEFT_TURN 'L'
+#define TRANSPORT_LINK 0
 
 /**
- * @brief Backward command.
+ * @brief Serial port transport index.
  *
  */
-#define CMD_BACKWARD 'B'
+#define TRANSPORT_SERIAL 1
 
 /**
- * @brief Right turn command.
+ * @brief Telemetry link budget in bytes per second.
  *
  */
-#define CMD_RIGHT_TURN 'R'
+#define TELEMETRY_BUDGET_BPS 2000
 
 /**
- * @brief Stop command.
+ * @brief Telemetry channel id of the servo J position.
  *
  */
-#define CMD_STOP 'S'
-
-/**
- * @brief Toggle M command.
- *
- */
-#define CMD_TOGGLE_M 'M'
-
-/**
- * @brief Toggle m command.
- *
- */
-#define CMD_TOGGLE_m 'm'
-
-/**
- * @brief Toggle N command.
- *
- */
-#define CMD_TOGGLE_N 'N'
-
-/**
- * @brief Toggle n command.
- *
- */
-#define CMD_TOGGLE_n 'n'
-
-/**
- * @brief Servo J position command.
- *
- */
-#define CMD_SERVO_J 'J'
-
-/**
- * @brief Servo K position command.
- *
- */
-#define CMD_SERVO_K 'K'
+#define TM_SERVO_J TM_USER
 
 #endif // ENABLE_WIFI
 
@@ -186,7 +168,7 @@ SOFTWARE.
 #define PWM_ABSOLUTE_MAX 255
 
 /**
- * @brief Motors PWM software limitation.
+ * @brief Motors PWM software limitation, the board configuration default.
  *
  */
 #define PWM_MAX 200
@@ -198,14 +180,6 @@ SOFTWARE.
 #define PWM_STEP 10
 #endif // ENABLE_MOTORS
 
-#if defined(ENABLE_SONAR_SERVO) || defined(ENABLE_WIFI)
-/**
- * @brief Sonar default servo position.
- *
- */
-#define DEFAULT_SERVO_POS 90
-#endif // defined(ENABLE_SONAR_SERVO) || defined(ENABLE_WIFI)
-
 #pragma endregion
 
 #pragma region Headers
@@ -222,6 +196,8 @@ SOFTWARE.
 
 #if defined(ENABLE_WIFI)
 #include "WiFi.h"
+#include "WiFiLink.h"
+#include "UdpControl.h"
 #include "DefaultCredentials.h"
 #endif // ENABLE_WIFI
 
@@ -237,10 +213,42 @@ SOFTWARE.
 void send_sensors();
 
 /**
- * @brief Read bluetooth commands.
+ * @brief Read the link and serial commands.
  *
  */
 void read_wifi_client();
+
+/**
+ * @brief Report the link state changes.
+ *
+ */
+void on_link_state(LinkState state);
+
+#if defined(ENABLE_UDP_CONTROL)
+/**
+ * @brief Stop when the UDP control frames stop.
+ *
+ */
+void on_control_timeout();
+
+/**
+ * @brief Extra delay of a datagram command.
+ *
+ */
+uint32_t get_command_age();
+#endif // ENABLE_UDP_CONTROL
+
+/**
+ * @brief Left encoder telemetry source.
+ *
+ */
+float get_left_encoder();
+
+/**
+ * @brief Right encoder telemetry source.
+ *
+ */
+float get_right_encoder();
 #endif // ENABLE_WIFI
 
 #if defined(ENABLE_MOTORS)
@@ -250,6 +258,12 @@ void read_wifi_client();
  */
 void update_direction_control();
 
+/**
+ * @brief Stop the motors when the update cycle runs too late.
+ *
+ */
+void safe_stop();
+
 /** @brief Interrupt Service Routine for handling left encoder.
  *  @return Void.
  */
@@ -261,18 +275,12 @@ void ISR_Left_Encoder();
 void ISR_Right_Encoder();
 #endif // ENABLE_MOTORS
 
-#pragma endregion
-
-#pragma region Enums
-
-enum Directions_t : uint8_t
-{
-    Stop = 0,
-    Forward = 1,
-    Backward = 2,
-    LeftTurn = 4,
-    RightTurn = 8
-};
+#if defined(ENABLE_SONAR)
+/** @brief Interrupt Service Routine for handling sonar echo.
+ *  @return Void.
+ */
+void ISR_Echo();
+#endif // ENABLE_SONAR
 
 #pragma endregion
 
@@ -287,12 +295,6 @@ int StateStatusLED_g = LOW;
 
 #if defined(ENABLE_WIFI)
 
-/**
- * @brief Socket client.
- *
- */
-WiFiClient SocketClient_g;
-
 /**
  * @brief Smartphone IP.
  *
@@ -308,34 +310,28 @@ IPAddress IPAddress_g = IPAddress(192, 168, 88, 230);
 #endif // DEFAULT_PASS
 
 /**
- * @brief Received command.
- *
- */
-char RecvCmd_g;
-
-/**
- * @brief Message number parser.
+ * @brief Command router of the link and the serial port.
  *
  */
-String CmdNumPart_g = "";
+CommandRouter Commands_g;
 
 /**
- * @brief LED 1 flag.
+ * @brief Batched binary telemetry.
  *
  */
-bool LED1_g = false;
+Telemetry Telemetry_g;
 
 /**
- * @brief LED 2 flag.
+ * @brief Control link latency.
  *
  */
-bool LED2_g = false;
+LinkLatency Latency_g;
 
 /**
- * @brief Servo K position.
+ * @brief Latency percentiles sent with the telemetry.
  *
  */
-int ServoKPos_g = DEFAULT_SERVO_POS;
+LatencyReport_t LatencyReport_g;
 
 /**
  * @brief Measured temperature.
@@ -345,14 +341,6 @@ float Temp_g = 0.0;
 
 #endif // ENABLE_WIFI
 
-#if defined(ENABLE_MOTORS)
-/**
- * @brief Robot direction.
- *
- */
-Directions_t Direction_g;
-#endif // ENABLE_MOTORS
-
 #if defined(ENABLE_MOTORS) || defined(ENABLE_WIFI) || defined(ENABLE_PID)
 /**
  * @brief Left motor PWM.
@@ -386,14 +374,6 @@ double FBRight_g = 0;
 Servo UsServo_g;
 #endif // ENABLE_SONAR_SERVO
 
-#if defined(ENABLE_SONAR_SERVO) || defined(ENABLE_WIFI)
-/**
- * @brief Servo J position.
- *
- */
-int SonarServoPos_g = DEFAULT_SERVO_POS;
-#endif // defined(ENABLE_SONAR_SERVO) || defined(ENABLE_WIFI)
-
 #if defined(ENABLE_SONAR) || defined(ENABLE_WIFI)
 /**
  * @brief Distance from sonar.
@@ -449,27 +429,33 @@ void setup()
     // Init serial
     Serial.begin(DEFAULT_BAUD);
 
+    // Load the stored board configuration over the board and sketch defaults.
+    BoardConfig_t DefaultsL;
+    BoardConfigClass::fillDefaults(&DefaultsL);
+#if defined(ENABLE_PID)
+    DefaultsL.Kp = CONST_P;
+    DefaultsL.Ki = CONST_I;
+    DefaultsL.Kd = CONST_D;
+#endif // ENABLE_PID
+#if defined(ENABLE_MOTORS)
+    DefaultsL.PwmMax = PWM_MAX;
+#endif // ENABLE_MOTORS
+    BoardConfig.begin(&DefaultsL);
+    const BoardConfig_t &ConfigL = BoardConfig.get();
+
 #if defined(ENABLE_MOTORS)
     // Attach the Interrupts to their ISR's
-    pinMode(PIN_LEFT_ENCODER, INPUT_PULLUP);
-    pinMode(PIN_RIGHT_ENCODER, INPUT_PULLUP);
+    pinMode(ConfigL.PinLeftEncoder, INPUT_PULLUP);
+    pinMode(ConfigL.PinRightEncoder, INPUT_PULLUP);
 
     // Increase counter 1 when speed sensor pin goes High.
-    attachInterrupt(digitalPinToInterrupt(PIN_LEFT_ENCODER), ISR_Left_Encoder, RISING);
+    attachInterrupt(digitalPinToInterrupt(ConfigL.PinLeftEncoder), ISR_Left_Encoder, RISING);
     // Increase counter 2 when speed sensor pin goes High.
-    attachInterrupt(digitalPinToInterrupt(PIN_RIGHT_ENCODER), ISR_Right_Encoder, RISING);
+    attachInterrupt(digitalPinToInterrupt(ConfigL.PinRightEncoder), ISR_Right_Encoder, RISING);
 
     // Setup the motor driver.
-    MotorModel_t MotorModelL = {
-        PIN_L_F,
-        PIN_L_B,
-        PIN_L_PWM,
-        PIN_R_F,
-        PIN_R_B,
-        PIN_R_PWM,
-        WHEEL_DIAMETER,
-        DISTANCE_BETWEEN_WHEELS,
-        ENCODER_TRACKS};
+    MotorModel_t MotorModelL;
+    BoardConfig.getMotorModel(&MotorModelL);
 
     // Initialize the motor controller.
     MotorController.init(&MotorModelL);
@@ -477,45 +463,74 @@ void setup()
 
 #if defined(ENABLE_SONAR_SERVO)
     // Attaches servo to the servo object.
-    UsServo_g.attach(PIN_US_SERVO);
+    UsServo_g.attach(ConfigL.PinUsServo);
 #endif // ENABLE_SONAR_SERVO
 
 #if defined(ENABLE_SONAR)
     // Initialize the ultrasonic.
-    HCSR04_g.init(PIN_US_TRIG, PIN_US_ECHO);
+    HCSR04_g.init(ConfigL.PinUsTrig, ConfigL.PinUsEcho);
+
+    // Timestamp both echo edges.
+    attachInterrupt(digitalPinToInterrupt(ConfigL.PinUsEcho), ISR_Echo, CHANGE);
 #endif // ENABLE_SONAR
 
 #if defined(ENABLE_STATUS_LED)
-    pinMode(PIN_USER_LED, OUTPUT);
+    pinMode(ConfigL.PinUserLed, OUTPUT);
 #endif // ENABLE_STATUS_LED
 
 #if defined(ENABLE_WIFI)
-    // Init wifi
-    WiFi.mode(WIFI_STA);
-    WiFi.begin(DEFAULT_SSID, DEFAULT_PASS);
-    if (WiFi.waitForConnectResult() != WL_CONNECTED)
-    {
-        Serial.println("WiFi Failed");
-        while (1)
-        {
-            delay(500);
-        }
-    }
-    Serial.print("WiFi connected with IP:");
-    Serial.println(WiFi.localIP());
+    // Join and connect in the background, the robot runs meanwhile.
+    WiFiLink.setCbState(on_link_state);
+    WiFiLink.begin(DEFAULT_SSID, DEFAULT_PASS, IPAddress_g, SERVICE_PORT);
+
+#if defined(ENABLE_UDP_CONTROL)
+    // The same handlers, fed by the newest datagram.
+    UdpControl.setCbTimeout(on_control_timeout);
+    UdpControl.begin(CONTROL_PORT, Commands_g);
+#endif // ENABLE_UDP_CONTROL
+#endif // ENABLE_WIFI
+
+#if defined(ENABLE_WIFI)
+    // Register the car command handlers.
+    CarCommands.begin(Commands_g, &Telemetry_g, &Latency_g);
+#if defined(ENABLE_UDP_CONTROL)
+    CarCommands.setCbCommandAge(get_command_age);
+#endif // ENABLE_UDP_CONTROL
+
+    // Both transports share the handlers.
+    Commands_g.addTransport(WiFiLink.getClient());
+    Commands_g.addTransport(Serial);
+
+    // Register the telemetry channels, the slow ones decimated.
+    Telemetry_g.addChannel(TM_RPM_LEFT, &FBLeft_g, 10.0, 2);
+    Telemetry_g.addChannel(TM_RPM_RIGHT, &FBRight_g, 10.0, 2);
+    Telemetry_g.addChannel(TM_ENCODER_LEFT, get_left_encoder, 1.0, 4);
+    Telemetry_g.addChannel(TM_ENCODER_RIGHT, get_right_encoder, 1.0, 4);
+    Telemetry_g.addChannel(TM_PWM_LEFT, &PWMLeft_g, 1.0, 2);
+    Telemetry_g.addChannel(TM_PWM_RIGHT, &PWMRight_g, 1.0, 2);
+    Telemetry_g.addChannel(TM_SERVO_J, &CarCommands.get().ServoJ, 2, 5);
+    Telemetry_g.addChannel(TM_DISTANCE, &Distance_g, 10.0, 2, 2);
+    Telemetry_g.addChannel(TM_TEMPERATURE, &Temp_g, 10.0, 2, 10);
+    Telemetry_g.addChannel(TM_RTT_P50, &LatencyReport_g.RttP50, 10.0, 2, 5);
+    Telemetry_g.addChannel(TM_RTT_P95, &LatencyReport_g.RttP95, 10.0, 2, 5);
+    Telemetry_g.addChannel(TM_AGE_P50, &LatencyReport_g.AgeP50, 10.0, 2, 5);
+    Telemetry_g.addChannel(TM_AGE_P95, &LatencyReport_g.AgeP95, 10.0, 2, 5);
+    Telemetry_g.addChannel(TM_ACTUATION_P50, &LatencyReport_g.ActuationP50, 10.0, 2, 5);
+    Telemetry_g.addChannel(TM_ACTUATION_P95, &LatencyReport_g.ActuationP95, 10.0, 2, 5);
+    Telemetry_g.setBudget(TELEMETRY_BUDGET_BPS);
 #endif // ENABLE_WIFI
 
 #if defined(ENABLE_PID)
     // Set the PID regulators.
-    PIDLeft_g = new PID(&LeftMap_g, &OutLeft_g, &PWMLeft_g, CONST_P, CONST_I, CONST_D, DIRECT);
+    PIDLeft_g = new PID(&LeftMap_g, &OutLeft_g, &PWMLeft_g, ConfigL.Kp, ConfigL.Ki, ConfigL.Kd, DIRECT);
     PIDLeft_g->SetMode(AUTOMATIC);
     PIDLeft_g->SetSampleTime(PID_UPDATE_INTERVAL_MS);
-    PIDLeft_g->SetOutputLimits(-PWM_MAX, PWM_MAX);
+    PIDLeft_g->SetOutputLimits(-ConfigL.PwmMax, ConfigL.PwmMax);
 
-    PIDRight_g = new PID(&RightMap_g, &OutRight_g, &PWMRight_g, CONST_P, CONST_I, CONST_D, DIRECT);
+    PIDRight_g = new PID(&RightMap_g, &OutRight_g, &PWMRight_g, ConfigL.Kp, ConfigL.Ki, ConfigL.Kd, DIRECT);
     PIDRight_g->SetMode(AUTOMATIC);
     PIDRight_g->SetSampleTime(PID_UPDATE_INTERVAL_MS);
-    PIDRight_g->SetOutputLimits(-PWM_MAX, PWM_MAX);
+    PIDRight_g->SetOutputLimits(-ConfigL.PwmMax, ConfigL.PwmMax);
 #endif // ENABLE_PID
 
     UpdateTimer_g = new FxTimer();
@@ -526,13 +541,25 @@ void setup()
     SendTimer_g->setExpirationTime(DEBUG_UPDATE_INTERVAL_MS);
     SendTimer_g->updateLastTime();
 
-    connect();
+    // Supervise the update cycle.
+    LoopMonitor.init(UPDATE_INTERVAL_MS, LATENESS_BUDGET_MS);
+#if defined(ENABLE_MOTORS)
+    LoopMonitor.setCbSafeStop(safe_stop);
+#endif // ENABLE_MOTORS
 }
 
 void loop()
 {
 
 #if defined(ENABLE_WIFI)
+    // One step of the link, it never waits.
+    WiFiLink.update();
+
+#if defined(ENABLE_UDP_CONTROL)
+    // Apply the newest control datagram.
+    UdpControl.update();
+#endif // ENABLE_UDP_CONTROL
+
     // Read serial.
     read_wifi_client();
 #endif // ENABLE_WIFI
@@ -544,9 +571,17 @@ void loop()
         UpdateTimer_g->updateLastTime();
         UpdateTimer_g->clear();
 
+        // Account the cycle lateness.
+        LoopMonitor.tick();
+
 #if defined(ENABLE_SONAR)
-        long MicrosecL = HCSR04_g.timing();
-        Distance_g = HCSR04_g.convert(MicrosecL, HCSR04::CM);
+        // Collect the last echo and start the next measurement.
+        long MicrosecL;
+        if (HCSR04_g.poll(&MicrosecL))
+        {
+            Distance_g = HCSR04_g.convert(MicrosecL, HCSR04::CM);
+        }
+        HCSR04_g.trigger();
 #endif // ENABLE_SONAR
 
 #if defined(ENABLE_WIFI)
@@ -584,15 +619,20 @@ void loop()
 #endif // ENABLE_MOTORS
 #endif // ENABLE_PID
 
+#if defined(ENABLE_MOTORS) && defined(ENABLE_WIFI)
+        // The newest command is on the motors now.
+        Latency_g.actuated();
+#endif // defined(ENABLE_MOTORS) && defined(ENABLE_WIFI)
+
 #if defined(ENABLE_SONAR_SERVO)
         // Set servo J position.
-        UsServo_g.write(int(map(SonarServoPos_g, 0, 180, 180, 0)));
+        UsServo_g.write(int(map(CarCommands.get().ServoJ, 0, 180, 180, 0)));
 #endif // ENABLE_SONAR_SERVO
 
 #if defined(ENABLE_STATUS_LED)
         // set the LED with the StateStatusLED_g of the variable:
         StateStatusLED_g = !StateStatusLED_g;
-        digitalWrite(PIN_USER_LED, StateStatusLED_g);
+        digitalWrite(BoardConfig.get().PinUserLed, StateStatusLED_g);
 #endif // ENABLE_STATUS_LED
     }
 
@@ -601,6 +641,8 @@ void loop()
     {
         SendTimer_g->updateLastTime();
         SendTimer_g->clear();
+
+#if defined(ENABLE_DEBUG_TEXT)
 #if defined(ENABLE_PID)
 #if defined(ENABLE_MOTORS)
         Serial.print("PWMLeft_g:");
@@ -645,118 +687,121 @@ void loop()
 #if defined(ENABLE_PID) || defined(ENABLE_MOTORS)
         Serial.println();
 #endif // defined(ENABLE_PID) || defined(ENABLE_MOTORS)
+#endif // ENABLE_DEBUG_TEXT
     }
 }
 
 #pragma region Functions
 
 #if defined(ENABLE_WIFI)
-void connect()
+/**
+ * @brief Report the link state changes.
+ *
+ */
+void on_link_state(LinkState state)
 {
-    if (!SocketClient_g.connect(IPAddress_g, SERVICE_PORT))
+    if (state == LinkConnected)
+    {
+        Serial.print("Connected, WiFi IP:");
+        Serial.println(WiFi.localIP());
+
+        // Drop what was left of the old socket.
+        Commands_g.setTransport(TRANSPORT_LINK, WiFiLink.getClient());
+
+        // Tell the host what the telemetry frames contain.
+        Telemetry_g.describe(WiFiLink.getClient());
+    }
+    else if (state == LinkBackoff)
     {
         Serial.println("Connection to host failed");
-        return;
+
+#if defined(ENABLE_MOTORS)
+        // Nobody drives, stop.
+        CarCommands.stop();
+#endif // ENABLE_MOTORS
     }
-    Serial.printf("Connected to: %s\n", SocketClient_g.remoteIP().toString());
 }
 
+#if defined(ENABLE_UDP_CONTROL)
+/**
+ * @brief Stop when the UDP control frames stop.
+ *
+ */
+void on_control_timeout()
+{
+    Serial.println("Control timeout");
+
+#if defined(ENABLE_MOTORS)
+    CarCommands.stop();
+    safe_stop();
+#endif // ENABLE_MOTORS
+}
+
+/**
+ * @brief Extra delay of a datagram command.
+ *
+ */
+uint32_t get_command_age()
+{
+    // The age is in ms, the latency meter takes us.
+    return UdpControl.getAge() * 1000UL;
+}
+#endif // ENABLE_UDP_CONTROL
+
 /**
  * @brief Read sensors.
  *
  */
 void send_sensors()
 {
-    SocketClient_g.print("D");
-    SocketClient_g.println(Distance_g);
-    SocketClient_g.print("T");
-    SocketClient_g.println(Temp_g);
+    if (!WiFiLink.isConnected())
+    {
+        return;
+    }
+
+    // Measure the round trip and refresh the percentiles.
+    Latency_g.ping(WiFiLink.getClient());
+    Latency_g.report(&LatencyReport_g);
+
+    // One frame per cycle, the budget drops the ones the link has no room for.
+    Telemetry_g.update(WiFiLink.getClient());
 }
 
 /**
- * @brief Read bluetooth commands.
+ * @brief Read the link and serial commands.
  *
  */
 void read_wifi_client()
 {
-    if (!SocketClient_g.connected())
-    { // Reconnect if not connected
-        connect();
-        return;
-    }
+    // The serial port takes commands too.
+    Commands_g.update(TRANSPORT_SERIAL);
 
-    if (Serial.available())
+    // The link reconnects by itself.
+    if (!WiFiLink.isConnected())
     {
-        SocketClient_g.write(Serial.read());
+        return;
     }
 
-    while (SocketClient_g.available() > 0)
-    {
-        String LineL = SocketClient_g.readStringUntil('\n');
-        Serial.printf("code received: %s\n", LineL);
-        CmdNumPart_g = "";
-        for (int index = 0; index < LineL.length(); index++)
-        {
-            int CharacterL = LineL[index];
-            if (isDigit(CharacterL))
-            {
-                CmdNumPart_g += (char)CharacterL;
-            }
-            else if (CharacterL != '\n')
-            {
-                RecvCmd_g = CharacterL;
-            }
-            else
-            {
-                break;
-            }
-        }
-    }
+    // Parse in place, the handlers run as the frames complete.
+    Commands_g.update(TRANSPORT_LINK);
+}
 
-    // SocketClient_g.printf("D%d cm\n", Distance_g);
+/**
+ * @brief Left encoder telemetry source.
+ *
+ */
+float get_left_encoder()
+{
+    return MotorController.GetLeftEncoder();
+}
 
-    switch (RecvCmd_g)
-    {
-    case CMD_FORWARD:
-        Direction_g = Directions_t::Forward;
-        break;
-    case CMD_LEFT_TURN:
-        Direction_g = Directions_t::LeftTurn;
-        break;
-    case CMD_BACKWARD:
-        Direction_g = Directions_t::Backward;
-        break;
-    case CMD_RIGHT_TURN:
-        Direction_g = Directions_t::RightTurn;
-        break;
-    case CMD_STOP:
-        Direction_g = Directions_t::Stop;
-        break;
-    case CMD_TOGGLE_M:
-        LED1_g = true;
-        break;
-    case CMD_TOGGLE_m:
-        LED1_g = false;
-        break;
-    case CMD_TOGGLE_N:
-        LED2_g = true;
-        break;
-    case CMD_TOGGLE_n:
-        LED2_g = false;
-        break;
-    case CMD_SERVO_J:
-        if (CmdNumPart_g != "")
-        {
-            SonarServoPos_g = CmdNumPart_g.toInt();
-        }
-        break;
-    case CMD_SERVO_K:
-        if (CmdNumPart_g != "")
-        {
-            ServoKPos_g = CmdNumPart_g.toInt();
-        }
-        break;
-    }
+/**
+ * @brief Right encoder telemetry source.
+ *
+ */
+float get_right_encoder()
+{
+    return MotorController.GetRightEncoder();
 }
 #endif // ENABLE_WIFI
 
@@ -767,36 +812,39 @@ void read_wifi_client()
  */
 void update_direction_control()
 {
-    if (Direction_g == Directions_t::Forward)
+    // Cached at boot, a field read.
+    const int16_t PwmMaxL = BoardConfig.get().PwmMax;
+
+    if (CarCommands.get().Direction == Directions_t::Forward)
     {
         PWMLeft_g += PWM_STEP;
         PWMRight_g += PWM_STEP;
     }
-    else if (Direction_g == Directions_t::Backward)
+    else if (CarCommands.get().Direction == Directions_t::Backward)
     {
         PWMLeft_g -= PWM_STEP;
         PWMRight_g -= PWM_STEP;
     }
-    else if (Direction_g == Directions_t::LeftTurn)
+    else if (CarCommands.get().Direction == Directions_t::LeftTurn)
     {
         PWMLeft_g -= PWM_STEP;
         PWMRight_g += PWM_STEP;
     }
-    else if (Direction_g == Directions_t::RightTurn)
+    else if (CarCommands.get().Direction == Directions_t::RightTurn)
     {
         PWMLeft_g += PWM_STEP;
         PWMRight_g -= PWM_STEP;
     }
-    else if (Direction_g == Directions_t::Stop)
+    else if (CarCommands.get().Direction == Directions_t::Stop)
     {
         PWMLeft_g = 0;
         PWMRight_g = 0;
     }
 
     // Limit Left PWM.
-    if (PWMLeft_g > PWM_MAX)
+    if (PWMLeft_g > PwmMaxL)
     {
-        PWMLeft_g = PWM_MAX;
+        PWMLeft_g = PwmMaxL;
     }
     // Limit Left PWM by absolute maximum.
     if (PWMLeft_g > PWM_ABSOLUTE_MAX)
@@ -804,9 +852,9 @@ void update_direction_control()
         PWMLeft_g = PWM_ABSOLUTE_MAX;
     }
     // Limit Left PWM.
-    if (PWMLeft_g < -PWM_MAX)
+    if (PWMLeft_g < -PwmMaxL)
     {
-        PWMLeft_g = -PWM_MAX;
+        PWMLeft_g = -PwmMaxL;
     }
     // Limit Left PWM by absolute maximum.
     if (PWMLeft_g < -PWM_ABSOLUTE_MAX)
@@ -815,9 +863,9 @@ void update_direction_control()
     }
 
     // Limit Right PWM.
-    if (PWMRight_g > PWM_MAX)
+    if (PWMRight_g > PwmMaxL)
     {
-        PWMRight_g = PWM_MAX;
+        PWMRight_g = PwmMaxL;
     }
     // Limit Right PWM by absolute maximum.
     if (PWMRight_g > PWM_ABSOLUTE_MAX)
@@ -825,9 +873,9 @@ void update_direction_control()
         PWMRight_g = PWM_ABSOLUTE_MAX;
     }
     // Limit Right PWM.
-    if (PWMRight_g < -PWM_MAX)
+    if (PWMRight_g < -PwmMaxL)
     {
-        PWMRight_g = -PWM_MAX;
+        PWMRight_g = -PwmMaxL;
     }
     // Limit Right PWM by absolute maximum.
     if (PWMRight_g < -PWM_ABSOLUTE_MAX)
@@ -836,6 +884,18 @@ void update_direction_control()
     }
 }
 
+/**
+ * @brief Stop the motors when the update cycle runs too late.
+ *
+ */
+void safe_stop()
+{
+    // Restart the ramp from zero.
+    PWMLeft_g = 0;
+    PWMRight_g = 0;
+    MotorController.SetPWM(0, 0);
+}
+
 /** @brief Interrupt Service Routine for handling left encoder.
  *  @return Void.
  */
@@ -853,4 +913,14 @@ void ISR_Right_Encoder()
 }
 #endif // ENABLE_MOTORS
 
+#if defined(ENABLE_SONAR)
+/** @brief Interrupt Service Routine for handling sonar echo.
+ *  @return Void.
+ */
+void ISR_Echo()
+{
+    HCSR04_g.echoISR();
+}
+#endif // ENABLE_SONAR
+
 #pragma endregion
\ No newline at end of file
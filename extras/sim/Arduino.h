@@ -0,0 +1,215 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// Arduino.h
+// Host simulation shim of the Arduino core API.
+
+#ifndef _SIM_ARDUINO_h
+#define _SIM_ARDUINO_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <math.h>
+#include <algorithm>
+
+#pragma region Definitions
+
+#define F_CPU 16000000UL
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+#define PI 3.1415926535897932384626433832795
+
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+#define A6 20
+#define A7 21
+
+#define SERIAL_8N1 0x06
+
+#define F(string_literal) (string_literal)
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define digitalPinToInterrupt(p) (p)
+
+/** @brief Simulated pins count. */
+#define SIM_PINS_COUNT 64
+
+using std::max;
+using std::min;
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#pragma endregion
+
+#pragma region Functions
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void analogWrite(uint8_t pin, int val);
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+unsigned long pulseIn(uint8_t pin, uint8_t state, unsigned long timeout = 1000000L);
+
+void attachInterrupt(uint8_t interruptNum, void (*userFunc)(void), int mode);
+void detachInterrupt(uint8_t interruptNum);
+void interrupts();
+void noInterrupts();
+
+long map(long x, long in_min, long in_max, long out_min, long out_max);
+long random(long howsmall, long howbig);
+
+#pragma endregion
+
+#pragma region Print
+
+/** @brief Minimal Print, formats through snprintf. */
+class Print
+{
+public:
+	virtual size_t write(uint8_t c) = 0;
+
+	virtual size_t write(const uint8_t *buffer, size_t size)
+	{
+		size_t n = 0;
+		while (size--)
+		{
+			n += write(*buffer++);
+		}
+		return n;
+	}
+
+	size_t write(const char *str)
+	{
+		return write((const uint8_t *)str, strlen(str));
+	}
+
+	virtual int availableForWrite()
+	{
+		return 0;
+	}
+
+	size_t printf(const char *format, ...)
+	{
+		char buffer[256];
+		va_list args;
+		va_start(args, format);
+		int len = vsnprintf(buffer, sizeof(buffer), format, args);
+		va_end(args);
+		return write((const uint8_t *)buffer, min((size_t)max(len, 0), sizeof(buffer) - 1));
+	}
+
+	size_t print(const char *str) { return write(str); }
+	size_t print(char c) { return write((uint8_t)c); }
+	size_t print(int n, int base = 10) { return print((long)n, base); }
+	size_t print(unsigned int n, int base = 10) { return print((unsigned long)n, base); }
+	size_t print(long n, int base = 10) { return base == 16 ? printf("%lX", n) : printf("%ld", n); }
+	size_t print(unsigned long n, int base = 10) { return base == 16 ? printf("%lX", n) : printf("%lu", n); }
+	size_t print(double n, int digits = 2) { return printf("%.*f", digits, n); }
+
+	size_t println() { return write("\r\n"); }
+	template <typename T>
+	size_t println(T value) { return print(value) + println(); }
+	template <typename T>
+	size_t println(T value, int format) { return print(value, format) + println(); }
+};
+
+/** @brief Minimal Stream. */
+class Stream : public Print
+{
+public:
+	virtual int available() = 0;
+	virtual int read() = 0;
+	virtual int peek() = 0;
+	virtual void flush() {}
+
+	size_t readBytes(char *buffer, size_t length)
+	{
+		size_t count = 0;
+		while (count < length)
+		{
+			int c = read();
+			if (c < 0)
+			{
+				break;
+			}
+			buffer[count++] = (char)c;
+		}
+		return count;
+	}
+};
+
+/** @brief Serial port printing to stdout when enabled. */
+class HardwareSerial : public Stream
+{
+public:
+	bool Echo = false;
+
+	void begin(unsigned long baud, uint8_t config = SERIAL_8N1) { (void)baud; (void)config; }
+	size_t write(uint8_t c) override
+	{
+		if (Echo)
+		{
+			putchar(c);
+		}
+		return 1;
+	}
+	using Print::write;
+	int availableForWrite() override { return 64; }
+	int available() override { return 0; }
+	int read() override { return -1; }
+	int peek() override { return -1; }
+	operator bool() { return true; }
+};
+
+extern HardwareSerial Serial;
+
+#pragma endregion
+
+#endif
@@ -0,0 +1,57 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// FxTimer.h
+// Host simulation stand-in for the FxTimer library.
+
+#ifndef _SIM_FXTIMER_h
+#define _SIM_FXTIMER_h
+
+#include "Arduino.h"
+
+class FxTimer
+{
+protected:
+	unsigned long m_expirationTime = 0;
+	unsigned long m_lastTime = 0;
+	bool m_expired = false;
+
+public:
+	void setExpirationTime(unsigned long value) { m_expirationTime = value; }
+	unsigned long getExpirationTime() { return m_expirationTime; }
+	void updateLastTime() { m_lastTime = millis(); }
+	void update()
+	{
+		if (millis() - m_lastTime >= m_expirationTime)
+		{
+			m_expired = true;
+		}
+	}
+	bool expired() { return m_expired; }
+	void clear() { m_expired = false; }
+};
+
+#endif
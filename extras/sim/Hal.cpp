@@ -0,0 +1,146 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// Hal.cpp
+// Arduino core API on top of the simulation world.
+
+#include "Arduino.h"
+#include "Sim.h"
+
+#include "OpenMOBot.h"
+
+#pragma region Functions
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+	if (mode == INPUT_PULLUP)
+	{
+		Sim.setPin(pin, HIGH);
+	}
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+	Sim.setPin(pin, val);
+}
+
+int digitalRead(uint8_t pin)
+{
+	return Sim.getPin(pin);
+}
+
+int analogRead(uint8_t pin)
+{
+	// The conversion takes time, the loop timing follows.
+	Sim.advance(SIM_ADC_US);
+
+	if (pin >= PIN_LS_1 && pin < PIN_LS_1 + LINE_SENSORS_COUNT)
+	{
+		return Sim.readLineSensor(pin - PIN_LS_1);
+	}
+
+	return Sim.getAnalog(pin);
+}
+
+void analogWrite(uint8_t pin, int val)
+{
+	Sim.setPWM(pin, val);
+}
+
+unsigned long millis()
+{
+	return (unsigned long)(Sim.now() / 1000);
+}
+
+unsigned long micros()
+{
+	return (unsigned long)Sim.now();
+}
+
+void delay(unsigned long ms)
+{
+	Sim.advance(ms * 1000UL);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+	Sim.advance(us);
+}
+
+unsigned long pulseIn(uint8_t pin, uint8_t state, unsigned long timeout)
+{
+	(void)pin;
+	(void)state;
+
+	// No echo in the virtual world.
+	Sim.advance(timeout);
+	return 0;
+}
+
+void attachInterrupt(uint8_t interruptNum, void (*userFunc)(void), int mode)
+{
+	(void)mode;
+	Sim.attachISR(interruptNum, userFunc);
+}
+
+void detachInterrupt(uint8_t interruptNum)
+{
+	Sim.attachISR(interruptNum, NULL);
+}
+
+void interrupts()
+{
+	Sim.setInterrupts(true);
+}
+
+void noInterrupts()
+{
+	Sim.setInterrupts(false);
+}
+
+long map(long x, long in_min, long in_max, long out_min, long out_max)
+{
+	if (in_max == in_min)
+	{
+		return out_min;
+	}
+
+	return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+long random(long howsmall, long howbig)
+{
+	if (howsmall >= howbig)
+	{
+		return howsmall;
+	}
+
+	return howsmall + rand() % (howbig - howsmall);
+}
+
+#pragma endregion
+
+HardwareSerial Serial;
@@ -0,0 +1,391 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// Sim.cpp
+
+#include "Sim.h"
+
+#include "OpenMOBot.h"
+
+#pragma region Methods
+
+void SimClass::init(uint32_t seed)
+{
+	m_now = 0;
+	m_physicsTime = 0;
+	m_seed = seed ? seed : 1;
+	m_interrupts = true;
+
+	memset(m_pins, 0, sizeof(m_pins));
+	memset(m_pwm, 0, sizeof(m_pwm));
+	memset(m_analog, 0, sizeof(m_analog));
+	memset(m_isr, 0, sizeof(m_isr));
+
+	m_left = {PIN_L_F, PIN_L_B, PIN_L_PWM, PIN_LEFT_ENCODER, 0, 0, 0};
+	m_right = {PIN_R_F, PIN_R_B, PIN_R_PWM, PIN_RIGHT_ENCODER, 0, 0, 0};
+
+	buildTrack();
+	place(0);
+}
+
+void SimClass::setDrift(double drift)
+{
+	m_drift = drift;
+}
+
+void SimClass::place(double lateral)
+{
+	// The start is the beginning of the bottom straight, heading +X.
+	m_pose.X = m_trackX[0];
+	m_pose.Y = m_trackY[0] + lateral;
+	m_pose.Theta = 0;
+
+	m_nearest = 0;
+	m_progress = 0;
+	m_lastS = 0;
+	m_laps = 0;
+	m_lapStart = m_now;
+	m_lastLapTime = 0;
+	m_bestLapTime = 0;
+	m_offTrack = false;
+}
+
+void SimClass::advance(uint32_t us)
+{
+	m_now += us;
+
+	while (m_now - m_physicsTime >= SIM_STEP_US)
+	{
+		m_physicsTime += SIM_STEP_US;
+		step(SIM_STEP_US / 1000000.0);
+	}
+}
+
+uint64_t SimClass::now()
+{
+	return m_now;
+}
+
+uint16_t SimClass::readLineSensor(uint8_t index)
+{
+	double CosL = cos(m_pose.Theta);
+	double SinL = sin(m_pose.Theta);
+
+	// Index zero is the rightmost sensor.
+	double LateralL = (index - (LINE_SENSORS_COUNT - 1) / 2.0) * SIM_SENSOR_SPACING_MM;
+	double XL = m_pose.X + SIM_SENSOR_OFFSET_MM * CosL - LateralL * SinL;
+	double YL = m_pose.Y + SIM_SENSOR_OFFSET_MM * SinL + LateralL * CosL;
+
+	int SegmentL = m_nearest;
+	double DistanceL = distanceToTrack(XL, YL, &SegmentL, NULL);
+
+	// Linear fall off over one sensor spacing outside the line edge.
+	double CoverL = 1.0 - (DistanceL - SIM_LINE_WIDTH_MM / 2.0) / SIM_SENSOR_SPACING_MM;
+	CoverL = constrain(CoverL, 0.0, 1.0);
+
+	// Ambient light from the left side lifts the background, the line stays saturated.
+	double BackgroundL = SIM_ADC_BACKGROUND + m_drift * (m_now / 1e6) * (index + 1) / LINE_SENSORS_COUNT;
+	BackgroundL = min(BackgroundL, (double)SIM_ADC_LINE);
+
+	int ValueL = (int)(BackgroundL + (SIM_ADC_LINE - BackgroundL) * CoverL);
+	ValueL += (int)(noise() % (2 * SIM_ADC_NOISE + 1)) - SIM_ADC_NOISE;
+
+	return (uint16_t)constrain(ValueL, 0, 1023);
+}
+
+void SimClass::setPin(uint8_t pin, uint8_t value)
+{
+	if (pin < SIM_PINS_COUNT)
+	{
+		m_pins[pin] = value;
+	}
+}
+
+uint8_t SimClass::getPin(uint8_t pin)
+{
+	return pin < SIM_PINS_COUNT ? m_pins[pin] : LOW;
+}
+
+void SimClass::setAnalog(uint8_t pin, int value)
+{
+	if (pin < SIM_PINS_COUNT)
+	{
+		m_analog[pin] = value;
+	}
+}
+
+int SimClass::getAnalog(uint8_t pin)
+{
+	return pin < SIM_PINS_COUNT ? m_analog[pin] : 0;
+}
+
+void SimClass::setPWM(uint8_t pin, int value)
+{
+	if (pin < SIM_PINS_COUNT)
+	{
+		m_pwm[pin] = value;
+	}
+}
+
+void SimClass::attachISR(uint8_t pin, void (*isr)(void))
+{
+	if (pin < SIM_PINS_COUNT)
+	{
+		m_isr[pin] = isr;
+	}
+}
+
+void SimClass::setInterrupts(bool enabled)
+{
+	m_interrupts = enabled;
+}
+
+SimPose_t SimClass::getPose()
+{
+	return m_pose;
+}
+
+double SimClass::getTrackLength()
+{
+	return m_trackS[SIM_TRACK_SEGMENTS];
+}
+
+double SimClass::getProgress()
+{
+	return m_progress;
+}
+
+uint32_t SimClass::getLaps()
+{
+	return m_laps;
+}
+
+uint64_t SimClass::getLastLapTime()
+{
+	return m_lastLapTime;
+}
+
+uint64_t SimClass::getBestLapTime()
+{
+	return m_bestLapTime;
+}
+
+bool SimClass::isOffTrack()
+{
+	return m_offTrack;
+}
+
+#pragma endregion
+
+#pragma region Private Methods
+
+void SimClass::buildTrack()
+{
+	const double L = SIM_TRACK_STRAIGHT_MM;
+	const double R = SIM_TRACK_RADIUS_MM;
+	const double LengthL = 2 * L + 2 * PI * R;
+
+	// Counter clockwise oval, evenly spaced by arc length.
+	for (int index = 0; index < SIM_TRACK_SEGMENTS; index++)
+	{
+		double SL = LengthL * index / SIM_TRACK_SEGMENTS;
+
+		if (SL < L)
+		{
+			m_trackX[index] = -L / 2 + SL;
+			m_trackY[index] = -R;
+		}
+		else if (SL < L + PI * R)
+		{
+			double AngleL = -PI / 2 + (SL - L) / R;
+			m_trackX[index] = L / 2 + R * cos(AngleL);
+			m_trackY[index] = R * sin(AngleL);
+		}
+		else if (SL < 2 * L + PI * R)
+		{
+			m_trackX[index] = L / 2 - (SL - L - PI * R);
+			m_trackY[index] = R;
+		}
+		else
+		{
+			double AngleL = PI / 2 + (SL - 2 * L - PI * R) / R;
+			m_trackX[index] = -L / 2 + R * cos(AngleL);
+			m_trackY[index] = R * sin(AngleL);
+		}
+	}
+
+	// Arc length at the polyline vertices.
+	m_trackS[0] = 0;
+	for (int index = 0; index < SIM_TRACK_SEGMENTS; index++)
+	{
+		int NextL = (index + 1) % SIM_TRACK_SEGMENTS;
+		m_trackS[index + 1] = m_trackS[index] + hypot(m_trackX[NextL] - m_trackX[index], m_trackY[NextL] - m_trackY[index]);
+	}
+}
+
+double SimClass::distanceToTrack(double x, double y, int *segment, double *s)
+{
+	// Search a window around the hint, the whole track when lost.
+	const int WindowL = 24;
+	int FirstL = *segment - WindowL;
+	int CountL = 2 * WindowL + 1;
+	double BestL = 1e18;
+
+	for (int pass = 0; pass < 2; pass++)
+	{
+		for (int offset = 0; offset < CountL; offset++)
+		{
+			int IndexL = ((FirstL + offset) % SIM_TRACK_SEGMENTS + SIM_TRACK_SEGMENTS) % SIM_TRACK_SEGMENTS;
+			int NextL = (IndexL + 1) % SIM_TRACK_SEGMENTS;
+
+			double DxL = m_trackX[NextL] - m_trackX[IndexL];
+			double DyL = m_trackY[NextL] - m_trackY[IndexL];
+			double LenSqL = DxL * DxL + DyL * DyL;
+			double TL = ((x - m_trackX[IndexL]) * DxL + (y - m_trackY[IndexL]) * DyL) / LenSqL;
+			TL = constrain(TL, 0.0, 1.0);
+
+			double PxL = m_trackX[IndexL] + TL * DxL - x;
+			double PyL = m_trackY[IndexL] + TL * DyL - y;
+			double DistSqL = PxL * PxL + PyL * PyL;
+
+			if (DistSqL < BestL)
+			{
+				BestL = DistSqL;
+				*segment = IndexL;
+				if (s != NULL)
+				{
+					*s = m_trackS[IndexL] + TL * (m_trackS[IndexL + 1] - m_trackS[IndexL]);
+				}
+			}
+		}
+
+		if (BestL < SIM_OFF_TRACK_MM * SIM_OFF_TRACK_MM)
+		{
+			break;
+		}
+
+		FirstL = 0;
+		CountL = SIM_TRACK_SEGMENTS;
+	}
+
+	return sqrt(BestL);
+}
+
+void SimClass::stepWheel(SimWheel_t *wheel, double dt)
+{
+	int DirectionL = 0;
+	if (m_pins[wheel->PinForward] == HIGH && m_pins[wheel->PinBackward] == LOW)
+	{
+		DirectionL = 1;
+	}
+	else if (m_pins[wheel->PinBackward] == HIGH && m_pins[wheel->PinForward] == LOW)
+	{
+		DirectionL = -1;
+	}
+
+	// First order motor with a static friction dead band.
+	int PWML = m_pwm[wheel->PinPWM];
+	double TargetL = 0;
+	if (PWML > SIM_PWM_DEADBAND)
+	{
+		TargetL = DirectionL * SIM_RPM_PER_PWM * PWML / 60.0;
+	}
+
+	wheel->Speed += (TargetL - wheel->Speed) * dt / SIM_MOTOR_TAU;
+	wheel->Angle += fabs(wheel->Speed) * dt;
+
+	// The slotted disk does not know the direction, each slot is a rising edge.
+	long SlotsL = (long)(wheel->Angle * ENCODER_TRACKS);
+	while (wheel->Slots < SlotsL)
+	{
+		wheel->Slots++;
+		if (m_interrupts && m_isr[wheel->PinEncoder] != NULL)
+		{
+			m_isr[wheel->PinEncoder]();
+		}
+	}
+}
+
+void SimClass::step(double dt)
+{
+	stepWheel(&m_left, dt);
+	stepWheel(&m_right, dt);
+
+	// Differential drive kinematics.
+	double VLeftL = m_left.Speed * PI * WHEEL_DIAMETER;
+	double VRightL = m_right.Speed * PI * WHEEL_DIAMETER;
+	double VL = (VLeftL + VRightL) / 2.0;
+	double WL = (VRightL - VLeftL) / DISTANCE_BETWEEN_WHEELS;
+
+	m_pose.X += VL * cos(m_pose.Theta + WL * dt / 2.0) * dt;
+	m_pose.Y += VL * sin(m_pose.Theta + WL * dt / 2.0) * dt;
+	m_pose.Theta = remainder(m_pose.Theta + WL * dt, 2 * PI);
+
+	// Progress along the track, laps count on every wrap forward.
+	double SL = 0;
+	double DistanceL = distanceToTrack(m_pose.X, m_pose.Y, &m_nearest, &SL);
+	double DeltaL = SL - m_lastS;
+	double LengthL = getTrackLength();
+	if (DeltaL < -LengthL / 2)
+	{
+		DeltaL += LengthL;
+	}
+	else if (DeltaL > LengthL / 2)
+	{
+		DeltaL -= LengthL;
+	}
+	m_lastS = SL;
+	m_progress += DeltaL;
+
+	if (m_progress >= (m_laps + 1) * LengthL)
+	{
+		m_laps++;
+		m_lastLapTime = m_physicsTime - m_lapStart;
+		m_lapStart = m_physicsTime;
+		if (m_bestLapTime == 0 || m_lastLapTime < m_bestLapTime)
+		{
+			m_bestLapTime = m_lastLapTime;
+		}
+	}
+
+	if (DistanceL > SIM_OFF_TRACK_MM)
+	{
+		m_offTrack = true;
+	}
+}
+
+uint32_t SimClass::noise()
+{
+	// xorshift32, the same seed gives the same run.
+	m_seed ^= m_seed << 13;
+	m_seed ^= m_seed >> 17;
+	m_seed ^= m_seed << 5;
+	return m_seed;
+}
+
+#pragma endregion
+
+SimClass Sim;
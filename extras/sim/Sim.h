@@ -0,0 +1,263 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// Sim.h
+// Differential drive robot on a virtual line track.
+
+#ifndef _SIM_h
+#define _SIM_h
+
+#include "Arduino.h"
+
+#pragma region Definitions
+
+/** @brief Physics integration step. */
+#define SIM_STEP_US 250
+
+/** @brief Time one analogRead() takes, ATmega328P at the default prescaler. */
+#define SIM_ADC_US 112
+
+/** @brief Wheel RPM per PWM unit above the dead band. */
+#define SIM_RPM_PER_PWM 2.55
+
+/** @brief PWM below which the motor does not turn. */
+#define SIM_PWM_DEADBAND 30
+
+/** @brief Motor time constant in seconds. */
+#define SIM_MOTOR_TAU 0.08
+
+/** @brief Line sensors spacing. */
+#define SIM_SENSOR_SPACING_MM 12.0
+
+/** @brief Line sensors distance ahead of the wheel axle. */
+#define SIM_SENSOR_OFFSET_MM 70.0
+
+/** @brief Line width. */
+#define SIM_LINE_WIDTH_MM 19.0
+
+/** @brief ADC value over the line. */
+#define SIM_ADC_LINE 900
+
+/** @brief ADC value over the background. */
+#define SIM_ADC_BACKGROUND 120
+
+/** @brief ADC noise amplitude. */
+#define SIM_ADC_NOISE 8
+
+/** @brief Track straight length. */
+#define SIM_TRACK_STRAIGHT_MM 1000.0
+
+/** @brief Track turn radius. */
+#define SIM_TRACK_RADIUS_MM 300.0
+
+/** @brief Track polyline segments. */
+#define SIM_TRACK_SEGMENTS 512
+
+/** @brief Robot center distance from the line that counts as lost. */
+#define SIM_OFF_TRACK_MM 150.0
+
+#pragma endregion
+
+/** @brief Robot pose in track coordinates. */
+typedef struct
+{
+	double X;	  ///< X position in mm.
+	double Y;	  ///< Y position in mm.
+	double Theta; ///< Heading in rad.
+} SimPose_t;
+
+/** @brief Simulated wheel with motor and encoder. */
+typedef struct
+{
+	uint8_t PinForward;	 ///< H-bridge forward pin.
+	uint8_t PinBackward; ///< H-bridge backward pin.
+	uint8_t PinPWM;		 ///< H-bridge PWM pin.
+	uint8_t PinEncoder;	 ///< Encoder pin.
+	double Speed;		 ///< Speed in rev/s, signed.
+	double Angle;		 ///< Travelled absolute angle in rev.
+	long Slots;			 ///< Encoder slots passed.
+} SimWheel_t;
+
+/** @brief Host simulation world. */
+class SimClass
+{
+protected:
+#pragma region Variables
+
+	uint64_t m_now = 0;
+	uint64_t m_physicsTime = 0;
+	uint32_t m_seed = 1;
+	double m_drift = 0;
+
+	uint8_t m_pins[SIM_PINS_COUNT];
+	int m_pwm[SIM_PINS_COUNT];
+	int m_analog[SIM_PINS_COUNT];
+	void (*m_isr[SIM_PINS_COUNT])(void);
+	bool m_interrupts = true;
+
+	SimWheel_t m_left;
+	SimWheel_t m_right;
+	SimPose_t m_pose;
+
+	double m_trackX[SIM_TRACK_SEGMENTS];
+	double m_trackY[SIM_TRACK_SEGMENTS];
+	double m_trackS[SIM_TRACK_SEGMENTS + 1];
+	int m_nearest = 0;
+
+	double m_progress = 0;
+	double m_lastS = 0;
+	uint32_t m_laps = 0;
+	uint64_t m_lapStart = 0;
+	uint64_t m_lastLapTime = 0;
+	uint64_t m_bestLapTime = 0;
+	bool m_offTrack = false;
+
+#pragma endregion
+
+#pragma region Methods
+
+	void buildTrack();
+	double distanceToTrack(double x, double y, int *segment, double *s);
+	void stepWheel(SimWheel_t *wheel, double dt);
+	void step(double dt);
+	uint32_t noise();
+
+#pragma endregion
+
+public:
+#pragma region Methods
+
+	/** @brief Reset the world, the robot is placed on the line.
+	 *  @param seed uint32_t, ADC noise seed.
+	 *  @return Void.
+	 */
+	void init(uint32_t seed);
+
+	/** @brief Set the ambient light drift, it lifts the background from the leftmost sensor down.
+	 *  @param drift double, Leftmost sensor background rise in ADC counts per second.
+	 *  @return Void.
+	 */
+	void setDrift(double drift);
+
+	/** @brief Advance the virtual time, runs physics and encoder ISRs.
+	 *  @param us uint32_t, Time in us.
+	 *  @return Void.
+	 */
+	void advance(uint32_t us);
+
+	/** @brief Virtual time in us. */
+	uint64_t now();
+
+	/** @brief Place the robot relative to the track start.
+	 *  @param lateral double, Offset to the left of the line in mm.
+	 *  @return Void.
+	 */
+	void place(double lateral);
+
+	/** @brief Read a line sensor.
+	 *  @param index uint8_t, Sensor index, zero is the rightmost.
+	 *  @return uint16_t, ADC value.
+	 */
+	uint16_t readLineSensor(uint8_t index);
+
+	void setPin(uint8_t pin, uint8_t value);
+	uint8_t getPin(uint8_t pin);
+	void setPWM(uint8_t pin, int value);
+
+	/** @brief Set the ADC value of an analog input, a knob.
+	 *  @param pin uint8_t, Pin.
+	 *  @param value int, ADC value.
+	 *  @return Void.
+	 */
+	void setAnalog(uint8_t pin, int value);
+	int getAnalog(uint8_t pin);
+	void attachISR(uint8_t pin, void (*isr)(void));
+	void setInterrupts(bool enabled);
+
+	SimPose_t getPose();
+	double getTrackLength();
+	double getProgress();
+	uint32_t getLaps();
+	uint64_t getLastLapTime();
+	uint64_t getBestLapTime();
+	bool isOffTrack();
+
+#pragma endregion
+};
+
+/** @brief Print to a host file. */
+class SimFile : public Print
+{
+protected:
+	FILE *m_file = NULL;
+	size_t m_size = 0;
+
+public:
+	bool open(const char *path, const char *mode)
+	{
+		m_file = fopen(path, mode);
+		m_size = 0;
+		return m_file != NULL;
+	}
+
+	void close()
+	{
+		if (m_file != NULL)
+		{
+			fclose(m_file);
+			m_file = NULL;
+		}
+	}
+
+	size_t size()
+	{
+		return m_size;
+	}
+
+	size_t write(uint8_t c) override
+	{
+		return write(&c, 1);
+	}
+
+	size_t write(const uint8_t *buffer, size_t size) override
+	{
+		size_t CountL = m_file != NULL ? fwrite(buffer, 1, size, m_file) : 0;
+		m_size += CountL;
+		return CountL;
+	}
+
+	using Print::write;
+
+	operator bool()
+	{
+		return m_file != NULL;
+	}
+};
+
+/** @brief Simulation instance. */
+extern SimClass Sim;
+
+#endif
@@ -0,0 +1,297 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// command_router_test.cpp
+// Runs the car command handlers over a loopback link and checks what the
+// router dispatches and replies for whole, split and corrupted frames.
+
+#include <stdio.h>
+
+#include "Arduino.h"
+#include "BoardConfig.h"
+#include "CarCommands.h"
+#include "CommandRouter.h"
+#include "LinkLatency.h"
+#include "LoopbackStream.h"
+#include "Telemetry.h"
+
+#pragma region Variables
+
+/** @brief Car end of the link. */
+static LoopbackStream Car_g;
+
+/** @brief Host end of the link. */
+static LoopbackStream Host_g;
+
+/** @brief Car router, as the sketches set it up. */
+static CommandRouter Commands_g;
+
+/** @brief Host router, decodes the replies. */
+static CommandRouter Replies_g;
+
+/** @brief Car telemetry, the describe source. */
+static Telemetry Telemetry_g;
+
+/** @brief Car link latency. */
+static LinkLatency Latency_g;
+
+/** @brief A telemetry channel value. */
+static int Value_g = 0;
+
+/** @brief Last reply id, zero for none. */
+static uint8_t ReplyId_g = 0;
+
+/** @brief Last reply arguments. */
+static uint8_t ReplyArgs_g[COMMAND_MAX_PAYLOAD];
+
+/** @brief Last reply arguments size. */
+static uint8_t ReplySize_g = 0;
+
+/** @brief Telemetry descriptors received. */
+static uint8_t Descriptors_g = 0;
+
+/** @brief Failed checks. */
+static unsigned Failed_g = 0;
+
+/** @brief Passed checks. */
+static unsigned Passed_g = 0;
+
+#pragma endregion
+
+#pragma region Functions
+
+/** @brief Host side reply handler.
+ *  @return Void.
+ */
+static void on_reply(uint8_t id, const uint8_t *args, uint8_t size)
+{
+	if (id == TELEMETRY_DESCRIPTOR_ID)
+	{
+		Descriptors_g++;
+		return;
+	}
+
+	ReplyId_g = id;
+	ReplySize_g = size;
+	memcpy(ReplyArgs_g, args, size);
+}
+
+/** @brief Count a check.
+ *  @param name const char*, Check name.
+ *  @param ok bool, Result.
+ *  @return Void.
+ */
+static void check(const char *name, bool ok)
+{
+	printf("%s  %s\n", ok ? "pass" : "FAIL", name);
+
+	if (ok)
+	{
+		Passed_g++;
+	}
+	else
+	{
+		Failed_g++;
+	}
+}
+
+/** @brief Send raw bytes from the host.
+ *  @param data const uint8_t*, Bytes.
+ *  @param size uint16_t, Bytes count.
+ *  @return Void.
+ */
+static void send_raw(const uint8_t *data, uint16_t size)
+{
+	Host_g.write(data, size);
+}
+
+/** @brief Encode a command frame.
+ *  @param buffer uint8_t*, Frame, COMMAND_MAX_PAYLOAD + 4 bytes.
+ *  @param id uint8_t, Command id.
+ *  @param args const uint8_t*, Arguments.
+ *  @param size uint8_t, Arguments size.
+ *  @return uint16_t, Frame size.
+ */
+static uint16_t make_frame(uint8_t *buffer, uint8_t id, const uint8_t *args = nullptr, uint8_t size = 0)
+{
+	return CommandCodec::frame(buffer, id, args, size);
+}
+
+/** @brief Let the car parse what arrived and the host read the replies.
+ *  @return uint8_t, Frames the car dispatched.
+ */
+static uint8_t pump()
+{
+	ReplyId_g = 0;
+	ReplySize_g = 0;
+
+	uint8_t FramesL = Commands_g.update();
+	Replies_g.update();
+
+	return FramesL;
+}
+
+#pragma endregion
+
+int main()
+{
+	uint8_t FrameL[2 * (COMMAND_MAX_PAYLOAD + 4)];
+	uint16_t SizeL;
+
+	Car_g.connect(Host_g);
+	BoardConfig.begin();
+
+	Telemetry_g.addChannel(TM_USER, &Value_g, 2, 1);
+	Telemetry_g.addChannel(TM_USER + 1, &CarCommands.get().ServoJ, 2, 1);
+
+	// The car side as the sketches register it.
+	CarCommands.begin(Commands_g, &Telemetry_g, &Latency_g);
+	Commands_g.addTransport(Car_g);
+
+	Replies_g.addHandler(LINK_ECHO_ID, on_reply);
+	Replies_g.addHandler(CMD_CONFIG_GET, on_reply);
+	Replies_g.addHandler(CMD_CONFIG_SET, on_reply);
+	Replies_g.addHandler(TELEMETRY_DESCRIPTOR_ID, on_reply);
+	Replies_g.addTransport(Host_g);
+
+	// Whole frames.
+	SizeL = make_frame(FrameL, CMD_FORWARD);
+	send_raw(FrameL, SizeL);
+	check("whole frame dispatched", pump() == 1 && CarCommands.get().Direction == Forward);
+
+	int16_t AngleL = 45;
+	SizeL = make_frame(FrameL, CMD_SERVO_J, (const uint8_t *)&AngleL, 2);
+	send_raw(FrameL, SizeL);
+	SizeL = make_frame(FrameL, CMD_TOGGLE_M);
+	send_raw(FrameL, SizeL);
+	check("two frames in one read", pump() == 2 && CarCommands.get().ServoJ == 45 && CarCommands.get().Led1);
+
+	// A frame split over many reads, dispatched only once complete.
+	SizeL = make_frame(FrameL, CMD_BACKWARD);
+	bool EarlyL = false;
+	for (uint16_t index = 0; index < SizeL - 1; index++)
+	{
+		send_raw(FrameL + index, 1);
+		EarlyL |= pump() != 0;
+	}
+	check("split frame waits", !EarlyL && CarCommands.get().Direction == Forward);
+	send_raw(FrameL + SizeL - 1, 1);
+	check("split frame completes", pump() == 1 && CarCommands.get().Direction == Backward);
+
+	// The tail of a read is kept for the next one.
+	uint16_t FirstL = make_frame(FrameL, CMD_TOGGLE_m);
+	SizeL = FirstL + make_frame(FrameL + FirstL, CMD_LEFT_TURN);
+	send_raw(FrameL, FirstL + 3);
+	check("tail kept, head dispatched", pump() == 1 && !CarCommands.get().Led1);
+	send_raw(FrameL + FirstL + 3, SizeL - FirstL - 3);
+	check("tail completed", pump() == 1 && CarCommands.get().Direction == LeftTurn);
+
+	// Noise before a frame is skipped silently.
+	uint32_t ErrorsL = Commands_g.getErrors();
+	const uint8_t NoiseL[] = {0x00, 0x13, 0x37, 0xFF};
+	send_raw(NoiseL, sizeof(NoiseL));
+	SizeL = make_frame(FrameL, CMD_RIGHT_TURN);
+	send_raw(FrameL, SizeL);
+	check("noise skipped", pump() == 1 && CarCommands.get().Direction == RightTurn && Commands_g.getErrors() == ErrorsL);
+
+	// A bad length resyncs on the next sync.
+	const uint8_t BadLengthL[] = {COMMAND_SYNC, COMMAND_MAX_PAYLOAD + 1, CMD_STOP};
+	send_raw(BadLengthL, sizeof(BadLengthL));
+	SizeL = make_frame(FrameL, CMD_FORWARD);
+	send_raw(FrameL, SizeL);
+	check("bad length resync", pump() == 1 && CarCommands.get().Direction == Forward && Commands_g.getErrors() == ErrorsL + 1);
+
+	// A bad CRC drops the frame, the next one still runs.
+	SizeL = make_frame(FrameL, CMD_BACKWARD);
+	FrameL[SizeL - 1] ^= 0x01;
+	SizeL += make_frame(FrameL + SizeL, CMD_STOP);
+	send_raw(FrameL, SizeL);
+	check("bad CRC dropped", pump() == 1 && CarCommands.get().Direction == Stop && Commands_g.getErrors() == ErrorsL + 2);
+
+	// A false sync resyncs inside its claimed length.
+	const uint8_t FalseSyncL[] = {COMMAND_SYNC, 8, CMD_BACKWARD};
+	send_raw(FalseSyncL, sizeof(FalseSyncL));
+	SizeL = make_frame(FrameL, CMD_FORWARD);
+	AngleL = 90;
+	SizeL += make_frame(FrameL + SizeL, CMD_SERVO_J, (const uint8_t *)&AngleL, 2);
+	send_raw(FrameL, SizeL);
+	check("false sync resync", pump() == 2 && CarCommands.get().Direction == Forward && CarCommands.get().ServoJ == 90 && Commands_g.getErrors() == ErrorsL + 3);
+
+	// A frame cut short by the link fails its CRC over the next frame,
+	// the rescan still finds that frame inside the dropped window.
+	AngleL = 120;
+	SizeL = make_frame(FrameL, CMD_SERVO_J, (const uint8_t *)&AngleL, 2) - 2;
+	SizeL += make_frame(FrameL + SizeL, CMD_BACKWARD);
+	SizeL += make_frame(FrameL + SizeL, CMD_LEFT_TURN);
+	send_raw(FrameL, SizeL);
+	check("cut frame resync", pump() == 2 && CarCommands.get().Direction == LeftTurn && CarCommands.get().ServoJ == 90 && Commands_g.getErrors() == ErrorsL + 4);
+
+	// A frame without a handler is counted, not replied.
+	uint32_t UnknownL = Commands_g.getUnknown();
+	SizeL = make_frame(FrameL, 'Z');
+	send_raw(FrameL, SizeL);
+	check("unknown id counted", pump() == 1 && Commands_g.getUnknown() == UnknownL + 1 && ReplyId_g == 0);
+
+	// Ping is echoed back on the same transport.
+	const uint8_t StampL[] = {1, 2, 3, 4};
+	SizeL = make_frame(FrameL, LINK_PING_ID, StampL, sizeof(StampL));
+	send_raw(FrameL, SizeL);
+	check("ping echoed", pump() == 1 && ReplyId_g == LINK_ECHO_ID && ReplySize_g == sizeof(StampL) && memcmp(ReplyArgs_g, StampL, sizeof(StampL)) == 0);
+
+	// Configuration get, set and read back.
+	uint8_t KeyL[3] = {CfgPwmMax, 0, 0};
+	SizeL = make_frame(FrameL, CMD_CONFIG_GET, KeyL, 1);
+	send_raw(FrameL, SizeL);
+	int16_t PwmL = 0;
+	pump();
+	memcpy(&PwmL, ReplyArgs_g + 1, 2);
+	check("config get", ReplyId_g == CMD_CONFIG_GET && ReplySize_g == 3 && ReplyArgs_g[0] == CfgPwmMax && PwmL == BoardConfig.get().PwmMax);
+
+	PwmL = 200;
+	memcpy(KeyL + 1, &PwmL, 2);
+	SizeL = make_frame(FrameL, CMD_CONFIG_SET, KeyL, 3);
+	send_raw(FrameL, SizeL);
+	pump();
+	check("config set", ReplyId_g == CMD_CONFIG_SET && ReplySize_g == 2 && ReplyArgs_g[1] == 1 && BoardConfig.get().PwmMax == 200);
+
+	SizeL = make_frame(FrameL, CMD_CONFIG_SET, KeyL, 2);
+	send_raw(FrameL, SizeL);
+	pump();
+	check("config set bad size", ReplyId_g == CMD_CONFIG_SET && ReplySize_g == 2 && ReplyArgs_g[1] == 0 && BoardConfig.get().PwmMax == 200);
+
+	// Describe answers on the transport that asked.
+	SizeL = make_frame(FrameL, CMD_DESCRIBE);
+	send_raw(FrameL, SizeL);
+	pump();
+	check("describe replied", Descriptors_g == 2);
+
+	check("no bytes dropped", Car_g.getDropped() == 0 && Host_g.getDropped() == 0 && Replies_g.getErrors() == 0);
+
+	printf("router:     %lu frames, %lu errors, %lu unknown\n", (unsigned long)Commands_g.getFrames(), (unsigned long)Commands_g.getErrors(), (unsigned long)Commands_g.getUnknown());
+	printf("checks:     %u passed, %u failed\n", Passed_g, Failed_g);
+
+	return Failed_g == 0 ? 0 : 2;
+}
@@ -0,0 +1,117 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// line_follower_replay.cpp
+// Feeds an I/O capture back into the line_follower sketch.
+
+#include <time.h>
+
+#include "Sim.h"
+
+// The sketch, as it is, with the throttle knob on the Nano A6.
+#define USE_THROTTLE_KNOB
+#define PIN_THROTTLE A6
+#include "../../examples/line_follower/line_follower.ino"
+
+#pragma region Functions
+
+/** @brief Deliver a replayed encoder edge to the sketch ISR.
+ *  @param channel uint8_t, 0 left, 1 right.
+ *  @return Void.
+ */
+static void replay_encoder(uint8_t channel)
+{
+	if (channel == 0)
+	{
+		ISR_Left_Encoder();
+	}
+	else
+	{
+		ISR_Right_Encoder();
+	}
+}
+
+#pragma endregion
+
+int main(int argc, char *argv[])
+{
+	if (argc != 2)
+	{
+		printf("Usage: %s capture\n", argv[0]);
+		return 1;
+	}
+
+	FILE *FileL = fopen(argv[1], "rb");
+	if (FileL == NULL)
+	{
+		printf("Can not open %s\n", argv[1]);
+		return 1;
+	}
+
+	fseek(FileL, 0, SEEK_END);
+	size_t SizeL = ftell(FileL);
+	fseek(FileL, 0, SEEK_SET);
+	uint8_t *DataL = new uint8_t[SizeL];
+	size_t ReadL = fread(DataL, 1, SizeL, FileL);
+	fclose(FileL);
+
+	if (ReadL != SizeL || !IOCapture.beginReplay(DataL, SizeL))
+	{
+		printf("%s is not a capture\n", argv[1]);
+		return 1;
+	}
+
+	clock_t WallStartL = clock();
+
+	// The world only answers the live reads, the capture overrides them.
+	Sim.init(1);
+	IOCapture.setCbEncoder(replay_encoder);
+
+	setup();
+
+	uint32_t LoopsL = 0;
+	while (!IOCapture.isReplayDone() && !IOCapture.isDiverged())
+	{
+		loop();
+		LoopsL++;
+	}
+
+	double WallL = (double)(clock() - WallStartL) / CLOCKS_PER_SEC;
+	bool ExactL = !IOCapture.isDiverged() && IOCapture.getMismatches() == 0;
+
+	printf("result:     %s\n", ExactL ? "identical" : "different");
+	printf("events:     %lu replayed%s\n", (unsigned long)IOCapture.getEvents(), IOCapture.isLossy() ? ", capture lost events" : "");
+	printf("outputs:    %lu equal, %lu different\n", (unsigned long)IOCapture.getMatches(), (unsigned long)IOCapture.getMismatches());
+	if (IOCapture.isDiverged())
+	{
+		printf("diverged:   at %.6f s of the capture\n", IOCapture.getReplayTime() / 1e6);
+	}
+	printf("time:       %u loops, %.1f s captured, %.2f s wall\n", LoopsL, IOCapture.getReplayTime() / 1e6, WallL);
+
+	delete[] DataL;
+
+	return ExactL ? 0 : 2;
+}
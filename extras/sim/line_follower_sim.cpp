@@ -0,0 +1,272 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// line_follower_sim.cpp
+// Runs the line_follower sketch unchanged on the virtual track.
+
+#include <time.h>
+
+#include "Sim.h"
+
+// The sketch, as it is, with the throttle knob on the Nano A6.
+#define USE_THROTTLE_KNOB
+#define PIN_THROTTLE A6
+#include "../../examples/line_follower/line_follower.ino"
+
+#pragma region Definitions
+
+/** @brief Harness overhead added to every loop() call. */
+#define SIM_LOOP_US 20
+
+/** @brief Lateral sweep amplitude during the calibration. */
+#define SIM_CALIBRATION_SWEEP_MM 40.0
+
+/** @brief Button release level. */
+#define SIM_BUTTON_RELEASED HIGH
+
+/** @brief Button press level. */
+#define SIM_BUTTON_PRESSED LOW
+
+/** @brief Capture buffer, drained after every loop(). */
+#define SIM_CAPTURE_BUFFER_SIZE 4096
+
+#pragma endregion
+
+#pragma region Variables
+
+/** @brief Laps to run. */
+static uint32_t LapsCount_g = 10;
+
+/** @brief Virtual time limit in seconds, zero gives a minute per lap. */
+static double TimeLimit_g = 0;
+
+/** @brief Throttle knob on PIN_THROTTLE, below the centre is forward. */
+static int ThrottleKnob_g = 384;
+
+/** @brief ADC noise seed. */
+static uint32_t Seed_g = 1;
+
+/** @brief Ambient light drift in ADC counts per second. */
+static double Drift_g = 0;
+
+/** @brief Print every lap. */
+static bool Verbose_g = false;
+
+/** @brief I/O capture output. */
+static SimFile CaptureFile_g;
+
+#pragma endregion
+
+#pragma region Functions
+
+/** @brief Run one loop() and pay for it in virtual time.
+ *  @return Void.
+ */
+static void sim_loop()
+{
+	loop();
+	Sim.advance(SIM_LOOP_US);
+
+	if (CaptureFile_g)
+	{
+		IOCapture.drain(CaptureFile_g);
+	}
+}
+
+/** @brief Press and release the user button, one loop() each.
+ *  @return Void.
+ */
+static void press_button()
+{
+	UserButtonState_g = SIM_BUTTON_PRESSED;
+	sim_loop();
+	UserButtonState_g = SIM_BUTTON_RELEASED;
+}
+
+/** @brief Print the usage.
+ *  @param name const char*, Program name.
+ *  @return Void.
+ */
+static void usage(const char *name)
+{
+	printf("Usage: %s [-l laps] [-t seconds] [-y throttle] [-s seed] [-d drift] [-r capture] [-v] [-e]\n", name);
+	printf("  -l  laps to run (%u)\n", LapsCount_g);
+	printf("  -t  virtual time limit (60 s per lap)\n");
+	printf("  -y  throttle knob 0..1023 (%d)\n", ThrottleKnob_g);
+	printf("  -s  sensor noise seed (%u)\n", Seed_g);
+	printf("  -d  ambient light drift, ADC counts per second (%.0f)\n", Drift_g);
+	printf("  -r  record the I/O capture to a file\n");
+	printf("  -v  print every lap\n");
+	printf("  -e  echo the sketch Serial output\n");
+}
+
+#pragma endregion
+
+int main(int argc, char *argv[])
+{
+	for (int index = 1; index < argc; index++)
+	{
+		const char *ArgL = argv[index];
+		const char *ValueL = index + 1 < argc ? argv[index + 1] : NULL;
+
+		if (strcmp(ArgL, "-l") == 0 && ValueL != NULL)
+		{
+			LapsCount_g = strtoul(ValueL, NULL, 10);
+			index++;
+		}
+		else if (strcmp(ArgL, "-t") == 0 && ValueL != NULL)
+		{
+			TimeLimit_g = atof(ValueL);
+			index++;
+		}
+		else if (strcmp(ArgL, "-y") == 0 && ValueL != NULL)
+		{
+			ThrottleKnob_g = atoi(ValueL);
+			index++;
+		}
+		else if (strcmp(ArgL, "-s") == 0 && ValueL != NULL)
+		{
+			Seed_g = strtoul(ValueL, NULL, 10);
+			index++;
+		}
+		else if (strcmp(ArgL, "-d") == 0 && ValueL != NULL)
+		{
+			Drift_g = atof(ValueL);
+			index++;
+		}
+		else if (strcmp(ArgL, "-r") == 0 && ValueL != NULL)
+		{
+			if (!CaptureFile_g.open(ValueL, "wb"))
+			{
+				printf("Can not create %s\n", ValueL);
+				return 1;
+			}
+			index++;
+		}
+		else if (strcmp(ArgL, "-v") == 0)
+		{
+			Verbose_g = true;
+		}
+		else if (strcmp(ArgL, "-e") == 0)
+		{
+			Serial.Echo = true;
+		}
+		else
+		{
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	clock_t WallStartL = clock();
+
+	Sim.init(Seed_g);
+	Sim.setDrift(Drift_g);
+	if (CaptureFile_g)
+	{
+		IOCapture.beginRecord(SIM_CAPTURE_BUFFER_SIZE);
+	}
+	UserButtonState_g = SIM_BUTTON_RELEASED;
+	setup();
+
+	// Calibrate while sweeping the sensors across the line.
+	press_button();
+	for (int index = 0; AppStateFlag_g == ApplicationState::CalibrateSensors; index++)
+	{
+		double PhaseL = 2.0 * PI * index / LINE_SENSORS_CALIBRATION_SIZE;
+		Sim.place(SIM_CALIBRATION_SWEEP_MM * sin(PhaseL));
+		sim_loop();
+	}
+
+	// Start on the line.
+	Sim.place(0);
+	press_button();
+
+	if (TimeLimit_g <= 0)
+	{
+		TimeLimit_g = 60.0 * LapsCount_g;
+	}
+	uint64_t LimitL = Sim.now() + (uint64_t)(TimeLimit_g * 1000000.0);
+	uint32_t LapsL = 0;
+	const char *ResultL = "time limit";
+
+	while (true)
+	{
+		Sim.setAnalog(PIN_THROTTLE, ThrottleKnob_g);
+		sim_loop();
+
+		if (Sim.getLaps() != LapsL)
+		{
+			LapsL = Sim.getLaps();
+			if (Verbose_g)
+			{
+				printf("lap %u: %.3f s\n", LapsL, Sim.getLastLapTime() / 1e6);
+			}
+		}
+
+		if (LapsL >= LapsCount_g)
+		{
+			ResultL = "done";
+			break;
+		}
+		if (Sim.isOffTrack())
+		{
+			ResultL = "off track";
+			break;
+		}
+		if (AppStateFlag_g == ApplicationState::SafetyStop)
+		{
+			ResultL = "safety stop";
+			break;
+		}
+		if (Sim.now() >= LimitL)
+		{
+			break;
+		}
+	}
+
+	if (CaptureFile_g)
+	{
+		IOCapture.end();
+		IOCapture.drain(CaptureFile_g);
+		printf("capture:    %lu events, %lu bytes, %lu lost\n", (unsigned long)IOCapture.getEvents(), (unsigned long)CaptureFile_g.size(), (unsigned long)IOCapture.getLost());
+		CaptureFile_g.close();
+	}
+
+	double WallL = (double)(clock() - WallStartL) / CLOCKS_PER_SEC;
+	double VirtualL = Sim.now() / 1e6;
+	SimPose_t PoseL = Sim.getPose();
+
+	printf("result:     %s\n", ResultL);
+	printf("laps:       %u / %u\n", LapsL, LapsCount_g);
+	printf("distance:   %.0f mm of %.0f mm per lap\n", Sim.getProgress(), Sim.getTrackLength());
+	printf("best lap:   %.3f s\n", Sim.getBestLapTime() / 1e6);
+	printf("pose:       %.0f mm, %.0f mm, %.1f deg\n", PoseL.X, PoseL.Y, PoseL.Theta * 180.0 / PI);
+	printf("loop:       %lu cycles, %lu us max lateness\n", (unsigned long)LoopMonitor.getCycles(), (unsigned long)LoopMonitor.getMaxLateness());
+	printf("time:       %.1f s virtual, %.2f s wall, %.0fx real time\n", VirtualL, WallL, WallL > 0 ? VirtualL / WallL : 0.0);
+
+	return ResultL[0] == 'd' ? 0 : 2;
+}
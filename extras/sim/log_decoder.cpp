@@ -0,0 +1,289 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// log_decoder.cpp
+// Prints the binary records of the Log drain.
+
+#include <stdio.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "Arduino.h"
+#include "CommandCodec.h"
+#include "Log.h"
+
+#pragma region Variables
+
+/** @brief Format strings by id. */
+static std::vector<std::string> Formats_g(256);
+
+/** @brief Level letters. */
+static const char Levels_g[] = "-EWID";
+
+#pragma endregion
+
+#pragma region Functions
+
+/** @brief Take a little endian 32 bit value.
+ *  @param args const uint8_t*&, Arguments, moved past the value.
+ *  @param end const uint8_t*, Arguments end.
+ *  @param value uint32_t&, Value.
+ *  @return bool, False when the record is short.
+ */
+static bool take32(const uint8_t *&args, const uint8_t *end, uint32_t &value)
+{
+	if (end - args < 4)
+	{
+		return false;
+	}
+
+	value = (uint32_t)args[0] | ((uint32_t)args[1] << 8) | ((uint32_t)args[2] << 16) | ((uint32_t)args[3] << 24);
+	args += 4;
+	return true;
+}
+
+/** @brief Format one record.
+ *  @param format const std::string&, Format string.
+ *  @param args const uint8_t*, Raw arguments.
+ *  @param end const uint8_t*, Arguments end.
+ *  @return std::string, Text.
+ */
+static std::string render(const std::string &format, const uint8_t *args, const uint8_t *end)
+{
+	std::string TextL;
+	char BufferL[64];
+
+	for (size_t index = 0; index < format.size(); index++)
+	{
+		if (format[index] != '%')
+		{
+			TextL += format[index];
+			continue;
+		}
+
+		// Flags, width, precision and length, then the conversion.
+		size_t StartL = index++;
+		while (index < format.size() && strchr("-+ #0123456789.hlz", format[index]) != NULL)
+		{
+			index++;
+		}
+		if (index >= format.size())
+		{
+			break;
+		}
+
+		char ConversionL = format[index];
+		std::string SpecL = format.substr(StartL, index - StartL);
+		// The robot sends 32 bits, drop the length modifiers.
+		SpecL.erase(std::remove_if(SpecL.begin(), SpecL.end(), [](char c)
+								   { return c == 'h' || c == 'l' || c == 'z'; }),
+					SpecL.end());
+		uint32_t ValueL;
+
+		switch (ConversionL)
+		{
+		case '%':
+			TextL += '%';
+			continue;
+
+		case 'd':
+		case 'i':
+			if (!take32(args, end, ValueL))
+			{
+				TextL += '?';
+				continue;
+			}
+			snprintf(BufferL, sizeof(BufferL), (SpecL + "d").c_str(), (int32_t)ValueL);
+			break;
+
+		case 'u':
+		case 'x':
+		case 'X':
+		case 'o':
+		case 'c':
+			if (!take32(args, end, ValueL))
+			{
+				TextL += '?';
+				continue;
+			}
+			snprintf(BufferL, sizeof(BufferL), (SpecL + ConversionL).c_str(), (unsigned)ValueL);
+			break;
+
+		case 'f':
+		case 'e':
+		case 'g':
+		{
+			float FloatL;
+			if (!take32(args, end, ValueL))
+			{
+				TextL += '?';
+				continue;
+			}
+			memcpy(&FloatL, &ValueL, 4);
+			snprintf(BufferL, sizeof(BufferL), (SpecL + ConversionL).c_str(), (double)FloatL);
+			break;
+		}
+
+		case 's':
+		{
+			if (end - args < 1 || end - args < 1 + args[0])
+			{
+				TextL += '?';
+				continue;
+			}
+			TextL.append((const char *)args + 1, args[0]);
+			args += 1 + args[0];
+			continue;
+		}
+
+		case 'v':
+		{
+			if (end - args < 1)
+			{
+				TextL += '?';
+				continue;
+			}
+			uint8_t CountL = *args & ~LOG_ARRAY_CUT;
+			bool CutL = (*args++ & LOG_ARRAY_CUT) != 0;
+			for (uint8_t item = 0; item < CountL && end - args >= 2; item++)
+			{
+				snprintf(BufferL, sizeof(BufferL), item == 0 ? "%u" : ", %u", args[0] | (args[1] << 8));
+				TextL += BufferL;
+				args += 2;
+			}
+			if (CutL)
+			{
+				// The record had no room for the rest.
+				TextL += CountL == 0 ? "..." : ", ...";
+			}
+			continue;
+		}
+
+		default:
+			TextL += SpecL + ConversionL;
+			continue;
+		}
+
+		TextL += BufferL;
+	}
+
+	return TextL;
+}
+
+/** @brief Handle one frame payload.
+ *  @param payload const uint8_t*, Frame id and arguments.
+ *  @param size uint8_t, Payload size.
+ *  @return Void.
+ */
+static void handle(const uint8_t *payload, uint8_t size)
+{
+	if (payload[0] == LOG_DEFINE_ID && size >= 2)
+	{
+		Formats_g[payload[1]].assign((const char *)payload + 2, size - 2);
+		return;
+	}
+
+	if (payload[0] != LOG_RECORD_ID || size < 7)
+	{
+		return;
+	}
+
+	uint8_t LevelL = payload[1];
+	uint8_t IdL = payload[2];
+	uint32_t TimeL = payload[3] | (payload[4] << 8) | (payload[5] << 16) | ((uint32_t)payload[6] << 24);
+
+	std::string TextL = Formats_g[IdL].empty() ? "<format " + std::to_string(IdL) + " not defined yet>"
+											   : render(Formats_g[IdL], payload + 7, payload + size);
+
+	printf("[%10.6f] %c %s\n", TimeL / 1e6, Levels_g[LevelL < 5 ? LevelL : 0], TextL.c_str());
+}
+
+#pragma endregion
+
+int main(int argc, char *argv[])
+{
+	if (argc > 2)
+	{
+		printf("Usage: %s [log, default stdin]\n", argv[0]);
+		return 1;
+	}
+
+	FILE *FileL = argc == 2 ? fopen(argv[1], "rb") : stdin;
+	if (FileL == NULL)
+	{
+		printf("Can not open %s\n", argv[1]);
+		return 1;
+	}
+
+	std::vector<uint8_t> BufferL;
+	uint8_t ChunkL[256];
+	size_t ReadL;
+	uint32_t ErrorsL = 0;
+
+	// Line buffered, a serial port stream shows up as it comes.
+	while ((ReadL = fread(ChunkL, 1, sizeof(ChunkL), FileL)) > 0)
+	{
+		BufferL.insert(BufferL.end(), ChunkL, ChunkL + ReadL);
+
+		size_t IndexL = 0;
+		while (IndexL + 2 <= BufferL.size())
+		{
+			if (BufferL[IndexL] != COMMAND_SYNC || BufferL[IndexL + 1] == 0)
+			{
+				IndexL++;
+				continue;
+			}
+
+			size_t FrameL = BufferL[IndexL + 1] + 4;
+			if (IndexL + FrameL > BufferL.size())
+			{
+				break;
+			}
+
+			uint8_t SizeL = CommandCodec::unframe(&BufferL[IndexL], FrameL);
+			if (SizeL == 0)
+			{
+				ErrorsL++;
+				IndexL++;
+				continue;
+			}
+
+			handle(&BufferL[IndexL + 2], SizeL);
+			IndexL += FrameL;
+		}
+
+		BufferL.erase(BufferL.begin(), BufferL.begin() + IndexL);
+		fflush(stdout);
+	}
+
+	if (ErrorsL > 0)
+	{
+		fprintf(stderr, "%u bad frames\n", ErrorsL);
+	}
+
+	return 0;
+}
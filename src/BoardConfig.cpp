@@ -0,0 +1,468 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// BoardConfig.cpp
+
+#include "BoardConfig.h"
+
+#include <stddef.h>
+
+#include "CommandCodec.h"
+#include "OpenMOBot.h"
+
+#if defined(ESP32)
+#include <Preferences.h>
+#elif defined(__AVR__)
+#include <EEPROM.h>
+#endif
+
+#pragma region Definitions
+
+/**
+ * @brief NVS namespace and key.
+ */
+#define BOARD_CONFIG_NAMESPACE "openmobot"
+#define BOARD_CONFIG_KEY "board"
+
+/**
+ * @brief Blob header size, magic, version and records size.
+ */
+#define BOARD_CONFIG_HEADER 5
+
+/**
+ * @brief Key bits of a record header.
+ */
+#define BOARD_CONFIG_KEY_MASK 0x3F
+
+#pragma endregion
+
+#pragma region Variables
+
+/** @brief Field of the configuration. */
+typedef struct
+{
+	uint8_t Key;	///< ConfigKey.
+	uint8_t Type;	///< ConfigType.
+	uint8_t Offset; ///< Offset in BoardConfig_t.
+} BoardConfigField_t;
+
+#define BOARD_CONFIG_FIELD(key, type, field) {key, type, offsetof(BoardConfig_t, field)}
+#define BOARD_CONFIG_SENSOR(index) BOARD_CONFIG_FIELD(CfgPinLineSensor1 + index, ConfigU8, PinLineSensors[index])
+
+/** @brief Fields, in stored order. */
+static const BoardConfigField_t Fields_g[] = {
+	BOARD_CONFIG_FIELD(CfgPinLeftForward, ConfigU8, PinLeftForward),
+	BOARD_CONFIG_FIELD(CfgPinLeftBackward, ConfigU8, PinLeftBackward),
+	BOARD_CONFIG_FIELD(CfgPinLeftPWM, ConfigU8, PinLeftPWM),
+	BOARD_CONFIG_FIELD(CfgPinRightForward, ConfigU8, PinRightForward),
+	BOARD_CONFIG_FIELD(CfgPinRightBackward, ConfigU8, PinRightBackward),
+	BOARD_CONFIG_FIELD(CfgPinRightPWM, ConfigU8, PinRightPWM),
+	BOARD_CONFIG_FIELD(CfgPinLeftEncoder, ConfigU8, PinLeftEncoder),
+	BOARD_CONFIG_FIELD(CfgPinRightEncoder, ConfigU8, PinRightEncoder),
+	BOARD_CONFIG_FIELD(CfgPinUsServo, ConfigU8, PinUsServo),
+	BOARD_CONFIG_FIELD(CfgPinUsTrig, ConfigU8, PinUsTrig),
+	BOARD_CONFIG_FIELD(CfgPinUsEcho, ConfigU8, PinUsEcho),
+	BOARD_CONFIG_FIELD(CfgPinUserLed, ConfigU8, PinUserLed),
+	BOARD_CONFIG_FIELD(CfgLineSensorsCount, ConfigU8, LineSensorsCount),
+	BOARD_CONFIG_SENSOR(0),
+	BOARD_CONFIG_SENSOR(1),
+	BOARD_CONFIG_SENSOR(2),
+	BOARD_CONFIG_SENSOR(3),
+	BOARD_CONFIG_SENSOR(4),
+	BOARD_CONFIG_SENSOR(5),
+	BOARD_CONFIG_SENSOR(6),
+	BOARD_CONFIG_SENSOR(7),
+	BOARD_CONFIG_FIELD(CfgWheelDiameter, ConfigFloat, WheelDiameter),
+	BOARD_CONFIG_FIELD(CfgWheelsDistance, ConfigFloat, WheelsDistance),
+	BOARD_CONFIG_FIELD(CfgEncoderTracks, ConfigU32, EncoderTracks),
+	BOARD_CONFIG_FIELD(CfgKp, ConfigFloat, Kp),
+	BOARD_CONFIG_FIELD(CfgKi, ConfigFloat, Ki),
+	BOARD_CONFIG_FIELD(CfgKd, ConfigFloat, Kd),
+	BOARD_CONFIG_FIELD(CfgPwmMax, ConfigI16, PwmMax),
+};
+
+#define BOARD_CONFIG_FIELDS (sizeof(Fields_g) / sizeof(Fields_g[0]))
+
+#if defined(OPENMOBOT_SIM)
+/** @brief Simulated storage. */
+static uint8_t SimStorage_g[BOARD_CONFIG_MAX_BLOB];
+static uint16_t SimStorageSize_g = 0;
+#endif
+
+#pragma endregion
+
+#pragma region Private Methods
+
+/** @brief Size of a type.
+ *  @param type uint8_t, ConfigType.
+ *  @return uint8_t, Size in bytes.
+ */
+static uint8_t type_size(uint8_t type)
+{
+	static const uint8_t SizesL[] = {1, 2, 4, 4};
+	return SizesL[type & 0x03];
+}
+
+/** @brief Find a field.
+ *  @param key uint8_t, ConfigKey.
+ *  @return const BoardConfigField_t*, Field, nullptr when unknown.
+ */
+static const BoardConfigField_t *find_field(uint8_t key)
+{
+	for (uint8_t index = 0; index < BOARD_CONFIG_FIELDS; index++)
+	{
+		if (Fields_g[index].Key == key)
+		{
+			return &Fields_g[index];
+		}
+	}
+
+	return nullptr;
+}
+
+/** @brief Blob checksum.
+ *  @param blob const uint8_t*, Blob.
+ *  @param size uint16_t, Size without the checksum.
+ *  @return uint16_t, CRC-16/CCITT.
+ */
+static uint16_t blob_crc(const uint8_t *blob, uint16_t size)
+{
+	uint16_t CrcL = 0xFFFF;
+	for (uint16_t index = 0; index < size; index++)
+	{
+		CrcL = CommandCodec::crc16(CrcL, blob[index]);
+	}
+
+	return CrcL;
+}
+
+uint16_t BoardConfigClass::serialize(uint8_t *blob)
+{
+	uint16_t SizeL = BOARD_CONFIG_HEADER;
+	const uint8_t *ConfigL = (const uint8_t *)&m_config;
+
+	for (uint8_t index = 0; index < BOARD_CONFIG_FIELDS; index++)
+	{
+		const BoardConfigField_t &FieldL = Fields_g[index];
+		uint8_t ValueSizeL = type_size(FieldL.Type);
+
+		blob[SizeL++] = (FieldL.Type << 6) | FieldL.Key;
+		// The targets are little endian, the raw field is the stored value.
+		memcpy(blob + SizeL, ConfigL + FieldL.Offset, ValueSizeL);
+		SizeL += ValueSizeL;
+	}
+
+	uint16_t RecordsL = SizeL - BOARD_CONFIG_HEADER;
+	blob[0] = BOARD_CONFIG_MAGIC & 0xFF;
+	blob[1] = BOARD_CONFIG_MAGIC >> 8;
+	blob[2] = BOARD_CONFIG_VERSION;
+	blob[3] = RecordsL & 0xFF;
+	blob[4] = RecordsL >> 8;
+
+	uint16_t CrcL = blob_crc(blob, SizeL);
+	blob[SizeL++] = CrcL >> 8;
+	blob[SizeL++] = CrcL & 0xFF;
+
+	return SizeL;
+}
+
+bool BoardConfigClass::deserialize(const uint8_t *blob, uint16_t size)
+{
+	if (size < BOARD_CONFIG_HEADER + 2)
+	{
+		return false;
+	}
+
+	if ((blob[0] | (blob[1] << 8)) != BOARD_CONFIG_MAGIC || blob[2] != BOARD_CONFIG_VERSION)
+	{
+		return false;
+	}
+
+	uint16_t RecordsL = blob[3] | (blob[4] << 8);
+	uint16_t EndL = BOARD_CONFIG_HEADER + RecordsL;
+	if (EndL + 2 > size)
+	{
+		return false;
+	}
+
+	uint16_t CrcL = ((uint16_t)blob[EndL] << 8) | blob[EndL + 1];
+	if (blob_crc(blob, EndL) != CrcL)
+	{
+		return false;
+	}
+
+	uint16_t IndexL = BOARD_CONFIG_HEADER;
+	while (IndexL < EndL)
+	{
+		uint8_t HeaderL = blob[IndexL++];
+		uint8_t TypeL = HeaderL >> 6;
+		uint8_t ValueSizeL = type_size(TypeL);
+		if (IndexL + ValueSizeL > EndL)
+		{
+			break;
+		}
+
+		// Unknown keys and retyped keys keep the default.
+		const BoardConfigField_t *FieldL = find_field(HeaderL & BOARD_CONFIG_KEY_MASK);
+		if (FieldL != nullptr && FieldL->Type == TypeL)
+		{
+			memcpy((uint8_t *)&m_config + FieldL->Offset, blob + IndexL, ValueSizeL);
+		}
+
+		IndexL += ValueSizeL;
+	}
+
+	if (m_config.LineSensorsCount > BOARD_CONFIG_MAX_LINE_SENSORS)
+	{
+		m_config.LineSensorsCount = BOARD_CONFIG_MAX_LINE_SENSORS;
+	}
+
+	return true;
+}
+
+uint16_t BoardConfigClass::readBlob(uint8_t *blob)
+{
+#if defined(OPENMOBOT_SIM)
+	memcpy(blob, SimStorage_g, SimStorageSize_g);
+	return SimStorageSize_g;
+#elif defined(ESP32)
+	Preferences PreferencesL;
+	if (!PreferencesL.begin(BOARD_CONFIG_NAMESPACE, true))
+	{
+		return 0;
+	}
+	uint16_t SizeL = 0;
+	if (PreferencesL.getBytesLength(BOARD_CONFIG_KEY) <= BOARD_CONFIG_MAX_BLOB)
+	{
+		SizeL = PreferencesL.getBytes(BOARD_CONFIG_KEY, blob, BOARD_CONFIG_MAX_BLOB);
+	}
+	PreferencesL.end();
+	return SizeL;
+#elif defined(__AVR__)
+	// The records size tells the stored length.
+	for (uint16_t index = 0; index < BOARD_CONFIG_HEADER; index++)
+	{
+		blob[index] = EEPROM.read(BOARD_CONFIG_ADDRESS + index);
+	}
+	uint16_t SizeL = BOARD_CONFIG_HEADER + (blob[3] | (blob[4] << 8)) + 2;
+	if (SizeL > BOARD_CONFIG_MAX_BLOB || BOARD_CONFIG_ADDRESS + SizeL > EEPROM.length())
+	{
+		return 0;
+	}
+	for (uint16_t index = BOARD_CONFIG_HEADER; index < SizeL; index++)
+	{
+		blob[index] = EEPROM.read(BOARD_CONFIG_ADDRESS + index);
+	}
+	return SizeL;
+#else
+	(void)blob;
+	return 0;
+#endif
+}
+
+bool BoardConfigClass::writeBlob(const uint8_t *blob, uint16_t size)
+{
+#if defined(OPENMOBOT_SIM)
+	if (size > 0)
+	{
+		memcpy(SimStorage_g, blob, size);
+	}
+	SimStorageSize_g = size;
+	return true;
+#elif defined(ESP32)
+	Preferences PreferencesL;
+	if (!PreferencesL.begin(BOARD_CONFIG_NAMESPACE, false))
+	{
+		return false;
+	}
+	bool StoredL;
+	if (size == 0)
+	{
+		StoredL = PreferencesL.remove(BOARD_CONFIG_KEY);
+	}
+	else
+	{
+		StoredL = PreferencesL.putBytes(BOARD_CONFIG_KEY, blob, size) == size;
+	}
+	PreferencesL.end();
+	return StoredL;
+#elif defined(__AVR__)
+	if (size == 0)
+	{
+		// A broken magic is enough to forget the blob.
+		EEPROM.update(BOARD_CONFIG_ADDRESS, 0xFF);
+		return true;
+	}
+	if (BOARD_CONFIG_ADDRESS + size > EEPROM.length())
+	{
+		return false;
+	}
+	// Update writes only the changed cells, it spares the EEPROM wear.
+	for (uint16_t index = 0; index < size; index++)
+	{
+		EEPROM.update(BOARD_CONFIG_ADDRESS + index, blob[index]);
+	}
+	return true;
+#else
+	(void)blob;
+	(void)size;
+	return false;
+#endif
+}
+
+#pragma endregion
+
+#pragma region Methods
+
+void BoardConfigClass::fillDefaults(BoardConfig_t *config)
+{
+	memset(config, BOARD_CONFIG_NO_PIN, sizeof(BoardConfig_t));
+
+	config->PinLeftForward = PIN_L_F;
+	config->PinLeftBackward = PIN_L_B;
+	config->PinLeftPWM = PIN_L_PWM;
+	config->PinRightForward = PIN_R_F;
+	config->PinRightBackward = PIN_R_B;
+	config->PinRightPWM = PIN_R_PWM;
+	config->PinLeftEncoder = PIN_LEFT_ENCODER;
+	config->PinRightEncoder = PIN_RIGHT_ENCODER;
+	config->PinUsServo = PIN_US_SERVO;
+#if defined(PIN_US_TRIG)
+	config->PinUsTrig = PIN_US_TRIG;
+	config->PinUsEcho = PIN_US_ECHO;
+#endif
+	config->PinUserLed = PIN_USER_LED;
+
+	config->LineSensorsCount = LINE_SENSORS_COUNT;
+	config->PinLineSensors[0] = PIN_LS_1;
+	config->PinLineSensors[1] = PIN_LS_2;
+	config->PinLineSensors[2] = PIN_LS_3;
+	config->PinLineSensors[3] = PIN_LS_4;
+	config->PinLineSensors[4] = PIN_LS_5;
+	config->PinLineSensors[5] = PIN_LS_6;
+#if defined(PIN_LS_8)
+	config->PinLineSensors[6] = PIN_LS_7;
+	config->PinLineSensors[7] = PIN_LS_8;
+#endif
+
+	config->WheelDiameter = WHEEL_DIAMETER;
+	config->WheelsDistance = DISTANCE_BETWEEN_WHEELS;
+	config->EncoderTracks = ENCODER_TRACKS;
+
+	config->Kp = 0.0;
+	config->Ki = 0.0;
+	config->Kd = 0.0;
+	config->PwmMax = 255;
+}
+
+bool BoardConfigClass::begin(const BoardConfig_t *defaults)
+{
+	if (defaults != nullptr)
+	{
+		m_config = *defaults;
+	}
+	else
+	{
+		fillDefaults(&m_config);
+	}
+
+	uint8_t BlobL[BOARD_CONFIG_MAX_BLOB];
+	uint16_t SizeL = readBlob(BlobL);
+
+	// A broken blob is rejected before any field changes.
+	m_loaded = deserialize(BlobL, SizeL);
+
+	return m_loaded;
+}
+
+void BoardConfigClass::getMotorModel(MotorModel_t *model)
+{
+	model->PinLeftForward = m_config.PinLeftForward;
+	model->PinLeftBackward = m_config.PinLeftBackward;
+	model->PinLeftPWM = m_config.PinLeftPWM;
+	model->PinRightForward = m_config.PinRightForward;
+	model->PinRightBackward = m_config.PinRightBackward;
+	model->PinRightPWM = m_config.PinRightPWM;
+	model->WheelDiameter = m_config.WheelDiameter;
+	model->DistanceBetweenWheels = m_config.WheelsDistance;
+	model->EncoderTracks = m_config.EncoderTracks;
+}
+
+bool BoardConfigClass::setField(uint8_t key, const uint8_t *value, uint8_t size)
+{
+	const BoardConfigField_t *FieldL = find_field(key);
+	if (FieldL == nullptr || size != type_size(FieldL->Type))
+	{
+		return false;
+	}
+
+	memcpy((uint8_t *)&m_config + FieldL->Offset, value, size);
+
+	if (m_config.LineSensorsCount > BOARD_CONFIG_MAX_LINE_SENSORS)
+	{
+		m_config.LineSensorsCount = BOARD_CONFIG_MAX_LINE_SENSORS;
+	}
+
+	return true;
+}
+
+uint8_t BoardConfigClass::getField(uint8_t key, uint8_t *value)
+{
+	const BoardConfigField_t *FieldL = find_field(key);
+	if (FieldL == nullptr)
+	{
+		return 0;
+	}
+
+	uint8_t SizeL = type_size(FieldL->Type);
+	memcpy(value, (const uint8_t *)&m_config + FieldL->Offset, SizeL);
+
+	return SizeL;
+}
+
+bool BoardConfigClass::save()
+{
+	uint8_t BlobL[BOARD_CONFIG_MAX_BLOB];
+	uint16_t SizeL = serialize(BlobL);
+
+	return writeBlob(BlobL, SizeL);
+}
+
+bool BoardConfigClass::erase()
+{
+	m_loaded = false;
+
+	return writeBlob(nullptr, 0);
+}
+
+bool BoardConfigClass::isLoaded()
+{
+	return m_loaded;
+}
+
+#pragma endregion
+
+BoardConfigClass BoardConfig;
@@ -0,0 +1,237 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// BoardConfig.h
+
+#ifndef _BOARDCONFIG_h
+#define _BOARDCONFIG_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include "MotorController.h"
+
+#pragma region Definitions
+
+/**
+ * @brief Stored blob magic, "OC".
+ */
+#define BOARD_CONFIG_MAGIC 0x434F
+
+/**
+ * @brief Stored blob format version, bump on an incompatible change.
+ */
+#define BOARD_CONFIG_VERSION 1
+
+/**
+ * @brief EEPROM address of the blob.
+ */
+#define BOARD_CONFIG_ADDRESS 0
+
+/**
+ * @brief Largest blob.
+ */
+#define BOARD_CONFIG_MAX_BLOB 192
+
+/**
+ * @brief Line sensor pins slots.
+ */
+#define BOARD_CONFIG_MAX_LINE_SENSORS 8
+
+/**
+ * @brief Pin value of an absent part.
+ */
+#define BOARD_CONFIG_NO_PIN 0xFF
+
+#pragma endregion
+
+#pragma region Enums
+
+/** @brief Field value type, the upper two bits of a stored key. */
+enum ConfigType : uint8_t
+{
+	ConfigU8 = 0U, ///< 1 byte.
+	ConfigI16,	   ///< 2 bytes.
+	ConfigU32,	   ///< 4 bytes.
+	ConfigFloat,   ///< 4 bytes.
+};
+
+/** @brief Field keys, never renumber, retire a key instead. */
+enum ConfigKey : uint8_t
+{
+	CfgPinLeftForward = 1U,
+	CfgPinLeftBackward,
+	CfgPinLeftPWM,
+	CfgPinRightForward,
+	CfgPinRightBackward,
+	CfgPinRightPWM,
+	CfgPinLeftEncoder,
+	CfgPinRightEncoder,
+	CfgPinUsServo,
+	CfgPinUsTrig,
+	CfgPinUsEcho,
+	CfgPinUserLed,
+	CfgLineSensorsCount,
+	CfgPinLineSensor1,
+	CfgPinLineSensor8 = CfgPinLineSensor1 + BOARD_CONFIG_MAX_LINE_SENSORS - 1,
+	CfgWheelDiameter,
+	CfgWheelsDistance,
+	CfgEncoderTracks,
+	CfgKp,
+	CfgKi,
+	CfgKd,
+	CfgPwmMax,
+};
+
+#pragma endregion
+
+/** @brief Board configuration, read the fields directly. */
+typedef struct
+{
+	uint8_t PinLeftForward;									 ///< Left forward pin.
+	uint8_t PinLeftBackward;								 ///< Left backward pin.
+	uint8_t PinLeftPWM;										 ///< Left PWM pin.
+	uint8_t PinRightForward;								 ///< Right forward pin.
+	uint8_t PinRightBackward;								 ///< Right backward pin.
+	uint8_t PinRightPWM;									 ///< Right PWM pin.
+	uint8_t PinLeftEncoder;									 ///< Left encoder pin.
+	uint8_t PinRightEncoder;								 ///< Right encoder pin.
+	uint8_t PinUsServo;										 ///< Ultrasonic servo pin.
+	uint8_t PinUsTrig;										 ///< Ultrasonic trigger pin.
+	uint8_t PinUsEcho;										 ///< Ultrasonic echo pin.
+	uint8_t PinUserLed;										 ///< User LED pin.
+	uint8_t LineSensorsCount;								 ///< Line sensors count.
+	uint8_t PinLineSensors[BOARD_CONFIG_MAX_LINE_SENSORS]; ///< Line sensor pins.
+	float WheelDiameter;									 ///< Wheels diameter, mm.
+	float WheelsDistance;									 ///< Distance between wheels, mm.
+	uint32_t EncoderTracks;									 ///< Encoder disk slots.
+	float Kp;												 ///< Speed regulator P.
+	float Ki;												 ///< Speed regulator I.
+	float Kd;												 ///< Speed regulator D.
+	int16_t PwmMax;											 ///< PWM limit.
+} BoardConfig_t;
+
+/** @brief Runtime board configuration store.
+ *
+ *  The fields start from the defaults, the board defines of OpenMOBot.h,
+ *  and begin() overlays the stored blob once at boot. Hot paths read the
+ *  flat BoardConfig_t, a field access with no lookup. setField() and
+ *  save() change it at runtime, pins and geometry apply at the next boot.
+ *
+ *  Blob: magic, version, records size, records, CRC-16/CCITT. A record is
+ *  the key with its ConfigType in the upper two bits and the little endian
+ *  value, so an older or newer firmware skips the keys it does not know
+ *  and keeps its defaults for the missing ones. It lives in NVS on ESP32
+ *  and in EEPROM at BOARD_CONFIG_ADDRESS on AVR.
+ */
+class BoardConfigClass
+{
+protected:
+#pragma region Variables
+
+	BoardConfig_t m_config;
+	bool m_loaded = false;
+
+#pragma endregion
+
+#pragma region Methods
+
+	uint16_t serialize(uint8_t *blob);
+	bool deserialize(const uint8_t *blob, uint16_t size);
+	uint16_t readBlob(uint8_t *blob);
+	bool writeBlob(const uint8_t *blob, uint16_t size);
+
+#pragma endregion
+
+public:
+#pragma region Methods
+
+	/** @brief Fill a configuration with the board defines.
+	 *  @param config BoardConfig_t*, Output.
+	 *  @return Void.
+	 */
+	static void fillDefaults(BoardConfig_t *config);
+
+	/** @brief Load the stored configuration over the defaults, once at boot.
+	 *  @param defaults const BoardConfig_t*, Defaults, nullptr for the board defines.
+	 *  @return bool, True when a stored blob was loaded.
+	 */
+	bool begin(const BoardConfig_t *defaults = nullptr);
+
+	/** @brief Get the configuration.
+	 *  @return const BoardConfig_t&, Configuration.
+	 */
+	inline const BoardConfig_t &get()
+	{
+		return m_config;
+	}
+
+	/** @brief Fill a motor model from the configuration.
+	 *  @param model MotorModel_t*, Output.
+	 *  @return Void.
+	 */
+	void getMotorModel(MotorModel_t *model);
+
+	/** @brief Set one field.
+	 *  @param key uint8_t, ConfigKey.
+	 *  @param value const uint8_t*, Little endian value.
+	 *  @param size uint8_t, Value size, must match the field type.
+	 *  @return bool, False for an unknown key or a wrong size.
+	 */
+	bool setField(uint8_t key, const uint8_t *value, uint8_t size);
+
+	/** @brief Get one field.
+	 *  @param key uint8_t, ConfigKey.
+	 *  @param value uint8_t*, Little endian value, 4 bytes room.
+	 *  @return uint8_t, Value size, zero for an unknown key.
+	 */
+	uint8_t getField(uint8_t key, uint8_t *value);
+
+	/** @brief Store the configuration, unchanged bytes are not written.
+	 *  @return bool, True when stored.
+	 */
+	bool save();
+
+	/** @brief Forget the stored configuration, the defaults apply at the next boot.
+	 *  @return bool, True when erased.
+	 */
+	bool erase();
+
+	/** @brief A stored blob was loaded.
+	 *  @return bool, True when loaded.
+	 */
+	bool isLoaded();
+
+#pragma endregion
+};
+
+/** @brief Board configuration instance. */
+extern BoardConfigClass BoardConfig;
+
+#endif
@@ -0,0 +1,206 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// CarCommands.cpp
+
+#include "CarCommands.h"
+#include "BoardConfig.h"
+
+#pragma region Methods
+
+bool CarCommandsClass::begin(CommandRouter &router, Telemetry *telemetry, LinkLatency *latency)
+{
+	m_router = &router;
+	m_telemetry = telemetry;
+	m_latency = latency;
+
+	bool DoneL = true;
+	DoneL &= router.addHandler(CMD_FORWARD, onDirection);
+	DoneL &= router.addHandler(CMD_LEFT_TURN, onDirection);
+	DoneL &= router.addHandler(CMD_BACKWARD, onDirection);
+	DoneL &= router.addHandler(CMD_RIGHT_TURN, onDirection);
+	DoneL &= router.addHandler(CMD_STOP, onDirection);
+	DoneL &= router.addHandler(CMD_TOGGLE_M, onLed);
+	DoneL &= router.addHandler(CMD_TOGGLE_m, onLed);
+	DoneL &= router.addHandler(CMD_TOGGLE_N, onLed);
+	DoneL &= router.addHandler(CMD_TOGGLE_n, onLed);
+	DoneL &= router.addHandler(CMD_SERVO_J, onServo);
+	DoneL &= router.addHandler(CMD_SERVO_K, onServo);
+	DoneL &= router.addHandler(CMD_DESCRIBE, onDescribe);
+	DoneL &= router.addHandler(LINK_PING_ID, onPing);
+	DoneL &= router.addHandler(LINK_ECHO_ID, onEcho);
+	DoneL &= router.addHandler(CMD_CONFIG_GET, onConfig);
+	DoneL &= router.addHandler(CMD_CONFIG_SET, onConfig);
+	DoneL &= router.addHandler(CMD_CONFIG_SAVE, onConfig);
+
+	return DoneL;
+}
+
+void CarCommandsClass::setCbCommandAge(uint32_t (*callback)())
+{
+	callbackCommandAge = callback;
+}
+
+void CarCommandsClass::stop()
+{
+	m_state.Direction = Stop;
+}
+
+#pragma endregion
+
+#pragma region Private Methods
+
+void CarCommandsClass::onDirection(uint8_t id, const uint8_t *args, uint8_t size)
+{
+	(void)args;
+	(void)size;
+
+	CarCommandsClass &SelfL = CarCommands;
+
+	// A datagram carries its extra delay, a stream only the link one.
+	if (SelfL.m_latency != nullptr)
+	{
+		bool DatagramL = SelfL.m_router->getSource() == nullptr;
+		SelfL.m_latency->command(DatagramL && SelfL.callbackCommandAge != nullptr ? SelfL.callbackCommandAge() : 0);
+	}
+
+	switch (id)
+	{
+	case CMD_FORWARD:
+		SelfL.m_state.Direction = Forward;
+		break;
+	case CMD_LEFT_TURN:
+		SelfL.m_state.Direction = LeftTurn;
+		break;
+	case CMD_BACKWARD:
+		SelfL.m_state.Direction = Backward;
+		break;
+	case CMD_RIGHT_TURN:
+		SelfL.m_state.Direction = RightTurn;
+		break;
+	default:
+		SelfL.m_state.Direction = Stop;
+		break;
+	}
+}
+
+void CarCommandsClass::onLed(uint8_t id, const uint8_t *args, uint8_t size)
+{
+	(void)args;
+	(void)size;
+
+	if (id == CMD_TOGGLE_M || id == CMD_TOGGLE_m)
+	{
+		CarCommands.m_state.Led1 = (id == CMD_TOGGLE_M);
+	}
+	else
+	{
+		CarCommands.m_state.Led2 = (id == CMD_TOGGLE_N);
+	}
+}
+
+void CarCommandsClass::onServo(uint8_t id, const uint8_t *args, uint8_t size)
+{
+	if (size < 2)
+	{
+		return;
+	}
+
+	if (id == CMD_SERVO_J)
+	{
+		CarCommands.m_state.ServoJ = CommandCodec::getInt16(args);
+	}
+	else
+	{
+		CarCommands.m_state.ServoK = CommandCodec::getInt16(args);
+	}
+}
+
+void CarCommandsClass::onDescribe(uint8_t id, const uint8_t *args, uint8_t size)
+{
+	(void)id;
+	(void)args;
+	(void)size;
+
+	CarCommandsClass &SelfL = CarCommands;
+
+	// Answer on the transport that asked, a datagram has none.
+	Stream *SourceL = SelfL.m_router->getSource();
+	if (SourceL != nullptr && SelfL.m_telemetry != nullptr)
+	{
+		SelfL.m_telemetry->describe(*SourceL);
+	}
+}
+
+void CarCommandsClass::onPing(uint8_t id, const uint8_t *args, uint8_t size)
+{
+	(void)id;
+
+	CarCommands.m_router->reply(LINK_ECHO_ID, args, size);
+}
+
+void CarCommandsClass::onEcho(uint8_t id, const uint8_t *args, uint8_t size)
+{
+	(void)id;
+
+	if (CarCommands.m_latency != nullptr)
+	{
+		CarCommands.m_latency->echo(args, size);
+	}
+}
+
+void CarCommandsClass::onConfig(uint8_t id, const uint8_t *args, uint8_t size)
+{
+	// Key and little endian value, the reply carries the status.
+	uint8_t ReplyL[5] = {0, 0, 0, 0, 0};
+	uint8_t ReplySizeL = 1;
+
+	if (id == CMD_CONFIG_GET && size == 1)
+	{
+		ReplyL[0] = args[0];
+		ReplySizeL += BoardConfig.getField(args[0], ReplyL + 1);
+	}
+	else if (id == CMD_CONFIG_SET && size > 1)
+	{
+		ReplyL[0] = args[0];
+		ReplyL[1] = BoardConfig.setField(args[0], args + 1, size - 1);
+		ReplySizeL = 2;
+	}
+	else if (id == CMD_CONFIG_SAVE)
+	{
+		ReplyL[0] = BoardConfig.save();
+	}
+
+	CarCommands.m_router->reply(id, ReplyL, ReplySizeL);
+}
+
+#pragma endregion
+
+/**
+ * @brief Car commands instance.
+ *
+ */
+CarCommandsClass CarCommands;
@@ -0,0 +1,227 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// CarCommands.h
+
+#ifndef _CARCOMMANDS_h
+#define _CARCOMMANDS_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include "CommandRouter.h"
+#include "LinkLatency.h"
+#include "Telemetry.h"
+
+#pragma region Definitions
+
+/**
+ * @brief Forward command.
+ */
+#define CMD_FORWARD 'F'
+
+/**
+ * @brief Left turn command.
+ */
+#define CMD_LEFT_TURN 'L'
+
+/**
+ * @brief Backward command.
+ */
+#define CMD_BACKWARD 'B'
+
+/**
+ * @brief Right turn command.
+ */
+#define CMD_RIGHT_TURN 'R'
+
+/**
+ * @brief Stop command.
+ */
+#define CMD_STOP 'S'
+
+/**
+ * @brief Toggle M command, LED 1 on.
+ */
+#define CMD_TOGGLE_M 'M'
+
+/**
+ * @brief Toggle m command, LED 1 off.
+ */
+#define CMD_TOGGLE_m 'm'
+
+/**
+ * @brief Toggle N command, LED 2 on.
+ */
+#define CMD_TOGGLE_N 'N'
+
+/**
+ * @brief Toggle n command, LED 2 off.
+ */
+#define CMD_TOGGLE_n 'n'
+
+/**
+ * @brief Servo J position command, the argument is a 16 bit angle.
+ */
+#define CMD_SERVO_J 'J'
+
+/**
+ * @brief Servo K position command, the argument is a 16 bit angle.
+ */
+#define CMD_SERVO_K 'K'
+
+/**
+ * @brief Telemetry channel descriptors request command.
+ */
+#define CMD_DESCRIBE '?'
+
+/**
+ * @brief Board configuration field get command.
+ */
+#define CMD_CONFIG_GET 'g'
+
+/**
+ * @brief Board configuration field set command.
+ */
+#define CMD_CONFIG_SET 's'
+
+/**
+ * @brief Board configuration save command.
+ */
+#define CMD_CONFIG_SAVE 'w'
+
+/**
+ * @brief Servos position at boot.
+ */
+#define CAR_COMMANDS_SERVO_POS 90
+
+#pragma endregion
+
+#pragma region Enums
+
+/** @brief Drive direction. */
+enum Directions_t : uint8_t
+{
+	Stop = 0,
+	Forward = 1,
+	Backward = 2,
+	LeftTurn = 4,
+	RightTurn = 8
+};
+
+#pragma endregion
+
+/** @brief Remote car state set by the commands. */
+typedef struct
+{
+	Directions_t Direction; ///< Drive direction.
+	bool Led1;				///< LED 1 flag.
+	bool Led2;				///< LED 2 flag.
+	int ServoJ;				///< Servo J position, degrees.
+	int ServoK;				///< Servo K position, degrees.
+} CarState_t;
+
+/** @brief Remote car command handlers.
+ *
+ *  The drive, LED, servo, describe, ping and echo and board configuration
+ *  handlers of the remote controlled cars. They do not know the transport,
+ *  begin() registers them on a router and the sketch only adds its
+ *  transports and reads the state.
+ */
+class CarCommandsClass
+{
+protected:
+#pragma region Variables
+
+	/** @brief Router the handlers answer through. */
+	CommandRouter *m_router = nullptr;
+
+	/** @brief Telemetry the descriptors come from. */
+	Telemetry *m_telemetry = nullptr;
+
+	/** @brief Link latency the commands are stamped into. */
+	LinkLatency *m_latency = nullptr;
+
+	/** @brief Extra delay callback of a command without a transport. */
+	uint32_t (*callbackCommandAge)() = nullptr;
+
+	/** @brief Car state. */
+	CarState_t m_state = {Stop, false, false, CAR_COMMANDS_SERVO_POS, CAR_COMMANDS_SERVO_POS};
+
+#pragma endregion
+
+#pragma region Methods
+
+	static void onDirection(uint8_t id, const uint8_t *args, uint8_t size);
+	static void onLed(uint8_t id, const uint8_t *args, uint8_t size);
+	static void onServo(uint8_t id, const uint8_t *args, uint8_t size);
+	static void onDescribe(uint8_t id, const uint8_t *args, uint8_t size);
+	static void onPing(uint8_t id, const uint8_t *args, uint8_t size);
+	static void onEcho(uint8_t id, const uint8_t *args, uint8_t size);
+	static void onConfig(uint8_t id, const uint8_t *args, uint8_t size);
+
+#pragma endregion
+
+public:
+#pragma region Methods
+
+	/** @brief Register the handlers.
+	 *  @param router CommandRouter&, Router of the sketch transports.
+	 *  @param telemetry Telemetry*, Descriptors source, nullptr without telemetry.
+	 *  @param latency LinkLatency*, Latency meter, nullptr without it.
+	 *  @return bool, False when the handlers table is full.
+	 */
+	bool begin(CommandRouter &router, Telemetry *telemetry, LinkLatency *latency);
+
+	/** @brief Set the extra delay callback of a command without a transport.
+	 *  @param callback, Returns the datagram age in us.
+	 *  @return Void.
+	 */
+	void setCbCommandAge(uint32_t (*callback)());
+
+	/** @brief Get the state.
+	 *  @return const CarState_t&, State.
+	 */
+	inline const CarState_t &get()
+	{
+		return m_state;
+	}
+
+	/** @brief Stop the drive, a lost link or a safe stop.
+	 *  @return Void.
+	 */
+	void stop();
+
+#pragma endregion
+};
+
+/** @brief Instance of the car commands. */
+extern CarCommandsClass CarCommands;
+
+#endif
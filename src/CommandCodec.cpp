@@ -0,0 +1,152 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// CommandCodec.cpp
+
+#include "CommandCodec.h"
+#include "IOCapture.h"
+
+#pragma region Methods
+
+bool CommandCodec::addHandler(uint8_t id, void (*handler)(uint8_t id, const uint8_t *args, uint8_t size))
+{
+	if (m_handlersCount >= COMMAND_MAX_HANDLERS)
+	{
+		return false;
+	}
+
+	m_handlers[m_handlersCount].Id = id;
+	m_handlers[m_handlersCount].Handler = handler;
+	m_handlersCount++;
+
+	return true;
+}
+
+bool CommandCodec::dispatch(const uint8_t *payload, uint8_t size)
+{
+	if (size == 0)
+	{
+		return false;
+	}
+
+	CAPTURE_COMMAND(payload, size);
+
+	for (uint8_t index = 0; index < m_handlersCount; index++)
+	{
+		if (m_handlers[index].Id == payload[0])
+		{
+			m_handlers[index].Handler(payload[0], payload + 1, size - 1);
+			return true;
+		}
+	}
+
+	m_unknown++;
+
+	return false;
+}
+
+uint16_t CommandCodec::frame(uint8_t *buffer, uint8_t id, const uint8_t *args, uint8_t size)
+{
+	uint16_t LengthL = 3 + size;
+
+	// Arguments first, they may already sit in place.
+	memmove(buffer + 3, args, size);
+	buffer[0] = COMMAND_SYNC;
+	buffer[1] = size + 1;
+	buffer[2] = id;
+
+	uint16_t CrcL = 0xFFFF;
+	for (uint16_t index = 1; index < LengthL; index++)
+	{
+		CrcL = crc16(CrcL, buffer[index]);
+	}
+	buffer[LengthL++] = CrcL >> 8;
+	buffer[LengthL++] = CrcL & 0xFF;
+
+	return LengthL;
+}
+
+uint8_t CommandCodec::unframe(const uint8_t *buffer, uint16_t size)
+{
+	if (size < 5 || buffer[0] != COMMAND_SYNC || buffer[1] == 0 || size != buffer[1] + 4U)
+	{
+		return 0;
+	}
+
+	uint16_t CrcL = 0xFFFF;
+	for (uint16_t index = 1; index < size - 2; index++)
+	{
+		CrcL = crc16(CrcL, buffer[index]);
+	}
+
+	if (buffer[size - 2] != (CrcL >> 8) || buffer[size - 1] != (CrcL & 0xFF))
+	{
+		return 0;
+	}
+
+	return buffer[1];
+}
+
+size_t CommandCodec::write(Print &out, uint8_t id, const uint8_t *args, uint8_t size)
+{
+	uint8_t FrameL[COMMAND_MAX_PAYLOAD + 4];
+
+	if (size >= COMMAND_MAX_PAYLOAD)
+	{
+		return 0;
+	}
+
+	// One write, so a socket sends one segment.
+	return out.write(FrameL, frame(FrameL, id, args, size));
+}
+
+uint16_t CommandCodec::crc16(uint16_t crc, uint8_t value)
+{
+	crc ^= (uint16_t)value << 8;
+	for (uint8_t bit = 0; bit < 8; bit++)
+	{
+		crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+	}
+
+	return crc;
+}
+
+uint32_t CommandCodec::getFrames()
+{
+	return m_frames;
+}
+
+uint32_t CommandCodec::getErrors()
+{
+	return m_errors;
+}
+
+uint32_t CommandCodec::getUnknown()
+{
+	return m_unknown;
+}
+
+#pragma endregion
@@ -0,0 +1,163 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// CommandCodec.h
+
+#ifndef _COMMANDCODEC_h
+#define _COMMANDCODEC_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#pragma region Definitions
+
+/**
+ * @brief Frame start byte.
+ */
+#define COMMAND_SYNC 0xA5
+
+/**
+ * @brief Longest payload, command id and arguments.
+ */
+#define COMMAND_MAX_PAYLOAD 16
+
+/**
+ * @brief Dispatch table size.
+ */
+#define COMMAND_MAX_HANDLERS 16
+
+#pragma endregion
+
+/** @brief Dispatch table entry. */
+typedef struct
+{
+	uint8_t Id;														  ///< Command id.
+	void (*Handler)(uint8_t id, const uint8_t *args, uint8_t size); ///< Command handler.
+} CommandHandler_t;
+
+/** @brief Length prefixed binary command frames.
+ *
+ *  Frame: COMMAND_SYNC, length, command id, arguments, CRC-16/CCITT high and low.
+ *  The length counts the id and the arguments, the CRC covers the length,
+ *  the id and the arguments. Arguments are little endian.
+ *
+ *  The codec only frames, checks and dispatches. CommandRouter parses the
+ *  streams in place and UdpControl checks whole datagrams with unframe().
+ */
+class CommandCodec
+{
+protected:
+#pragma region Variables
+
+	CommandHandler_t m_handlers[COMMAND_MAX_HANDLERS];
+	uint8_t m_handlersCount = 0;
+
+	uint32_t m_frames = 0;
+	uint32_t m_errors = 0;
+	uint32_t m_unknown = 0;
+
+#pragma endregion
+
+public:
+#pragma region Methods
+
+	/** @brief Register a command handler.
+	 *  @param id uint8_t, Command id.
+	 *  @param handler void (*)(uint8_t, const uint8_t*, uint8_t), Handler, gets the id and the arguments.
+	 *  @return bool, False when the table is full.
+	 */
+	bool addHandler(uint8_t id, void (*handler)(uint8_t id, const uint8_t *args, uint8_t size));
+
+	/** @brief Call the handler of a payload.
+	 *  @param payload const uint8_t*, Command id and arguments.
+	 *  @param size uint8_t, Payload size.
+	 *  @return bool, False when no handler takes the id.
+	 */
+	bool dispatch(const uint8_t *payload, uint8_t size);
+
+	/** @brief Encode a frame into a buffer.
+	 *  @param buffer uint8_t*, Output, size + 5 bytes.
+	 *  @param id uint8_t, Command id.
+	 *  @param args const uint8_t*, Arguments, may be the buffer + 3.
+	 *  @param size uint8_t, Arguments size, up to 254.
+	 *  @return uint16_t, Frame size.
+	 */
+	static uint16_t frame(uint8_t *buffer, uint8_t id, const uint8_t *args, uint8_t size);
+
+	/** @brief Check a whole frame held in a buffer, a datagram.
+	 *  @param buffer const uint8_t*, Frame, the payload starts at buffer + 2.
+	 *  @param size uint16_t, Buffer size.
+	 *  @return uint8_t, Payload size, zero when not exactly one valid frame.
+	 */
+	static uint8_t unframe(const uint8_t *buffer, uint16_t size);
+
+	/** @brief Encode and send a frame.
+	 *  @param out Print&, Output.
+	 *  @param id uint8_t, Command id.
+	 *  @param args const uint8_t*, Arguments.
+	 *  @param size uint8_t, Arguments size.
+	 *  @return size_t, Written bytes count, zero when the arguments do not fit.
+	 */
+	static size_t write(Print &out, uint8_t id, const uint8_t *args, uint8_t size);
+
+	/** @brief Update a CRC-16/CCITT with one byte.
+	 *  @param crc uint16_t, CRC so far, 0xFFFF to start.
+	 *  @param value uint8_t, Byte.
+	 *  @return uint16_t, CRC.
+	 */
+	static uint16_t crc16(uint16_t crc, uint8_t value);
+
+	/** @brief Read a little endian 16 bit argument.
+	 *  @param args const uint8_t*, Arguments.
+	 *  @return int16_t, Value.
+	 */
+	static inline int16_t getInt16(const uint8_t *args)
+	{
+		return (int16_t)(args[0] | (args[1] << 8));
+	}
+
+	/** @brief Get valid frames count.
+	 *  @return uint32_t, Count.
+	 */
+	uint32_t getFrames();
+
+	/** @brief Get dropped frames count, bad length or CRC.
+	 *  @return uint32_t, Count.
+	 */
+	uint32_t getErrors();
+
+	/** @brief Get valid frames without a handler.
+	 *  @return uint32_t, Count.
+	 */
+	uint32_t getUnknown();
+
+#pragma endregion
+};
+
+#endif
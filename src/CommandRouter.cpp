@@ -0,0 +1,172 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// CommandRouter.cpp
+
+#include "CommandRouter.h"
+
+#pragma region Methods
+
+bool CommandRouter::addTransport(Stream &port)
+{
+	if (m_transportsCount >= COMMAND_ROUTER_MAX_TRANSPORTS)
+	{
+		return false;
+	}
+
+	m_transports[m_transportsCount].Port = &port;
+	m_transports[m_transportsCount].Size = 0;
+	m_transportsCount++;
+
+	return true;
+}
+
+void CommandRouter::setTransport(uint8_t index, Stream &port)
+{
+	if (index >= m_transportsCount)
+	{
+		return;
+	}
+
+	// A partial frame of the old stream means nothing on the new one.
+	m_transports[index].Port = &port;
+	m_transports[index].Size = 0;
+}
+
+uint8_t CommandRouter::update()
+{
+	uint8_t FramesL = 0;
+
+	for (uint8_t index = 0; index < m_transportsCount; index++)
+	{
+		FramesL += update(index);
+	}
+
+	return FramesL;
+}
+
+uint8_t CommandRouter::update(uint8_t index)
+{
+	if (index >= m_transportsCount)
+	{
+		return 0;
+	}
+
+	CommandTransport_t *TransportL = &m_transports[index];
+
+	// Only the bytes already received, the stream timeout never applies.
+	int AvailableL = TransportL->Port->available();
+	if (AvailableL <= 0)
+	{
+		return 0;
+	}
+
+	uint8_t FreeL = COMMAND_ROUTER_BUFFER - TransportL->Size;
+	size_t CountL = TransportL->Port->readBytes((char *)TransportL->Buffer + TransportL->Size, min((int)FreeL, AvailableL));
+	TransportL->Size += CountL;
+
+	return scan(TransportL);
+}
+
+Stream *CommandRouter::getSource()
+{
+	return m_source;
+}
+
+size_t CommandRouter::reply(uint8_t id, const uint8_t *args, uint8_t size)
+{
+	if (m_source == nullptr)
+	{
+		return 0;
+	}
+
+	return write(*m_source, id, args, size);
+}
+
+#pragma endregion
+
+#pragma region Private Methods
+
+uint8_t CommandRouter::scan(CommandTransport_t *transport)
+{
+	uint8_t *BufferL = transport->Buffer;
+	uint8_t IndexL = 0;
+	uint8_t FramesL = 0;
+
+	while (IndexL < transport->Size)
+	{
+		if (BufferL[IndexL] != COMMAND_SYNC)
+		{
+			IndexL++;
+			continue;
+		}
+
+		uint8_t LeftL = transport->Size - IndexL;
+		if (LeftL < 2)
+		{
+			break;
+		}
+
+		uint8_t LengthL = BufferL[IndexL + 1];
+		if (LengthL == 0 || LengthL > COMMAND_MAX_PAYLOAD)
+		{
+			// Not a frame, look for the next sync.
+			m_errors++;
+			IndexL++;
+			continue;
+		}
+
+		if (LeftL < LengthL + 4)
+		{
+			// Wait for the rest.
+			break;
+		}
+
+		if (unframe(BufferL + IndexL, LengthL + 4) == 0)
+		{
+			m_errors++;
+			IndexL++;
+			continue;
+		}
+
+		m_frames++;
+		FramesL++;
+
+		m_source = transport->Port;
+		dispatch(BufferL + IndexL + 2, LengthL);
+		m_source = nullptr;
+
+		IndexL += LengthL + 4;
+	}
+
+	// Keep the partial frame, at most one frame long.
+	transport->Size -= IndexL;
+	memmove(BufferL, BufferL + IndexL, transport->Size);
+
+	return FramesL;
+}
+
+#pragma endregion
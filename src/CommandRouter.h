@@ -0,0 +1,131 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// CommandRouter.h
+
+#ifndef _COMMANDROUTER_h
+#define _COMMANDROUTER_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include "CommandCodec.h"
+
+#pragma region Definitions
+
+/**
+ * @brief Most transports on one router.
+ */
+#define COMMAND_ROUTER_MAX_TRANSPORTS 4
+
+/**
+ * @brief Receive buffer of a transport, two full frames.
+ */
+#define COMMAND_ROUTER_BUFFER (2 * (COMMAND_MAX_PAYLOAD + 4))
+
+#pragma endregion
+
+/** @brief Transport of a router. */
+typedef struct
+{
+	Stream *Port;						  ///< Byte stream.
+	uint8_t Buffer[COMMAND_ROUTER_BUFFER]; ///< Received bytes not parsed yet.
+	uint8_t Size;						  ///< Bytes in the buffer.
+} CommandTransport_t;
+
+/** @brief Command frames router over byte stream transports.
+ *
+ *  Any Stream is a transport: WiFiClient, BluetoothSerial, Serial or a
+ *  LoopbackStream on the host. update() reads what each transport holds
+ *  into its buffer and parses the frames in place, the handlers get the
+ *  arguments straight from the buffer. All transports share the handlers
+ *  registered with addHandler(), a handler answers with reply().
+ */
+class CommandRouter : public CommandCodec
+{
+protected:
+#pragma region Variables
+
+	CommandTransport_t m_transports[COMMAND_ROUTER_MAX_TRANSPORTS];
+	uint8_t m_transportsCount = 0;
+
+	Stream *m_source = nullptr;
+
+#pragma endregion
+
+#pragma region Methods
+
+	uint8_t scan(CommandTransport_t *transport);
+
+#pragma endregion
+
+public:
+#pragma region Methods
+
+	/** @brief Add a transport.
+	 *  @param port Stream&, Byte stream.
+	 *  @return bool, False when the table is full.
+	 */
+	bool addTransport(Stream &port);
+
+	/** @brief Replace the stream of a transport, a new socket.
+	 *  @param index uint8_t, Transport index, in addTransport() order.
+	 *  @param port Stream&, Byte stream.
+	 *  @return Void.
+	 */
+	void setTransport(uint8_t index, Stream &port);
+
+	/** @brief Read and dispatch the frames of every transport, never waits.
+	 *  @return uint8_t, Dispatched frames count.
+	 */
+	uint8_t update();
+
+	/** @brief Read and dispatch the frames of one transport.
+	 *  @param index uint8_t, Transport index.
+	 *  @return uint8_t, Dispatched frames count.
+	 */
+	uint8_t update(uint8_t index);
+
+	/** @brief Get the transport of the command being handled.
+	 *  @return Stream*, Transport, nullptr outside a handler or for a direct dispatch().
+	 */
+	Stream *getSource();
+
+	/** @brief Answer the command being handled on its transport.
+	 *  @param id uint8_t, Command id.
+	 *  @param args const uint8_t*, Arguments.
+	 *  @param size uint8_t, Arguments size.
+	 *  @return size_t, Written bytes count, zero without a transport.
+	 */
+	size_t reply(uint8_t id, const uint8_t *args, uint8_t size);
+
+#pragma endregion
+};
+
+#endif
@@ -0,0 +1,236 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "CoopScheduler.h"
+
+/** @brief Deadline order of two tasks, wrap safe.
+ *  @return bool, True when task a is due before task b.
+ */
+bool CoopSchedulerClass::before(uint8_t a, uint8_t b)
+{
+	int32_t DiffL = (int32_t)(m_tasks[a].Deadline - m_tasks[b].Deadline);
+
+	if (DiffL == 0)
+	{
+		return m_tasks[a].Priority > m_tasks[b].Priority;
+	}
+
+	return DiffL < 0;
+}
+
+/** @brief Push a task to the heap.
+ *  @param index uint8_t, Task index.
+ *  @return Void.
+ */
+void CoopSchedulerClass::push(uint8_t index)
+{
+	uint8_t PosL = m_heapCount++;
+
+	// Sift up.
+	while (PosL > 0)
+	{
+		uint8_t ParentL = (PosL - 1) / 2;
+		if (!before(index, m_heap[ParentL]))
+		{
+			break;
+		}
+		m_heap[PosL] = m_heap[ParentL];
+		PosL = ParentL;
+	}
+
+	m_heap[PosL] = index;
+}
+
+/** @brief Pop the earliest task from the heap.
+ *  @return uint8_t, Task index.
+ */
+uint8_t CoopSchedulerClass::pop()
+{
+	uint8_t TopL = m_heap[0];
+	uint8_t LastL = m_heap[--m_heapCount];
+	uint8_t PosL = 0;
+
+	// Sift down.
+	while (true)
+	{
+		uint8_t ChildL = 2 * PosL + 1;
+		if (ChildL >= m_heapCount)
+		{
+			break;
+		}
+		if (ChildL + 1 < m_heapCount && before(m_heap[ChildL + 1], m_heap[ChildL]))
+		{
+			ChildL++;
+		}
+		if (!before(m_heap[ChildL], LastL))
+		{
+			break;
+		}
+		m_heap[PosL] = m_heap[ChildL];
+		PosL = ChildL;
+	}
+
+	m_heap[PosL] = LastL;
+	return TopL;
+}
+
+/** @brief Register a periodic task.
+ *  @param callback, Task function.
+ *  @param period uint32_t, Period in us.
+ *  @param phase uint32_t, Offset of the first release in us.
+ *  @param priority uint8_t, Higher runs first when several tasks are due.
+ *  @return int, Task id or -1 when full.
+ */
+int CoopSchedulerClass::addTask(void (*callback)(), uint32_t period, uint32_t phase, uint8_t priority)
+{
+	if (m_tasksCount >= SCHEDULER_MAX_TASKS || callback == nullptr || period == 0)
+	{
+		return -1;
+	}
+
+	SchedulerTask_t *TaskL = &m_tasks[m_tasksCount];
+	TaskL->Callback = callback;
+	TaskL->Period = period;
+	TaskL->Deadline = micros() + phase;
+	TaskL->Priority = priority;
+
+	push(m_tasksCount);
+	resetStats(m_tasksCount);
+
+	return m_tasksCount++;
+}
+
+/** @brief Set the idle callback, it gets the time to the next release.
+ *  @param callback, Idle callback.
+ *  @return Void.
+ */
+void CoopSchedulerClass::setCbIdle(void (*callback)(uint32_t))
+{
+	callbackIdle = callback;
+}
+
+/** @brief Run all due tasks, call it from loop().
+ *  @return uint32_t, Time to the next release in us.
+ */
+uint32_t CoopSchedulerClass::run()
+{
+	uint8_t DueL[SCHEDULER_MAX_TASKS];
+	uint8_t DueCountL = 0;
+	uint32_t NowL = micros();
+
+	if (m_heapCount == 0)
+	{
+		return 0;
+	}
+
+	// Collect the due tasks, ordered by priority.
+	while (m_heapCount > 0 && (int32_t)(NowL - m_tasks[m_heap[0]].Deadline) >= 0)
+	{
+		uint8_t IndexL = pop();
+		uint8_t PosL = DueCountL++;
+		while (PosL > 0 && m_tasks[DueL[PosL - 1]].Priority < m_tasks[IndexL].Priority)
+		{
+			DueL[PosL] = DueL[PosL - 1];
+			PosL--;
+		}
+		DueL[PosL] = IndexL;
+	}
+
+	for (uint8_t index = 0; index < DueCountL; index++)
+	{
+		SchedulerTask_t *TaskL = &m_tasks[DueL[index]];
+
+		TaskL->LastJitter = micros() - TaskL->Deadline;
+		if (TaskL->LastJitter > TaskL->MaxJitter)
+		{
+			TaskL->MaxJitter = TaskL->LastJitter;
+		}
+
+		TaskL->Callback();
+		TaskL->Runs++;
+
+		// Anchor to the previous release, skip the ones already missed.
+		TaskL->Deadline += TaskL->Period;
+		NowL = micros();
+		while ((int32_t)(NowL - TaskL->Deadline) >= 0)
+		{
+			TaskL->Deadline += TaskL->Period;
+			TaskL->Overruns++;
+		}
+
+		push(DueL[index]);
+	}
+
+	int32_t WaitL = (int32_t)(m_tasks[m_heap[0]].Deadline - micros());
+	if (WaitL <= 0)
+	{
+		return 0;
+	}
+
+	if (callbackIdle != nullptr)
+	{
+		callbackIdle(WaitL);
+	}
+
+	return WaitL;
+}
+
+/** @brief Get the task description and statistics.
+ *  @param id int, Task id.
+ *  @return const SchedulerTask_t*, Task or nullptr.
+ */
+const SchedulerTask_t *CoopSchedulerClass::getTask(int id)
+{
+	if (id < 0 || id >= m_tasksCount)
+	{
+		return nullptr;
+	}
+
+	return &m_tasks[id];
+}
+
+/** @brief Clear the task statistics.
+ *  @param id int, Task id.
+ *  @return Void.
+ */
+void CoopSchedulerClass::resetStats(int id)
+{
+	if (id < 0 || id >= SCHEDULER_MAX_TASKS)
+	{
+		return;
+	}
+
+	m_tasks[id].Runs = 0;
+	m_tasks[id].Overruns = 0;
+	m_tasks[id].MaxJitter = 0;
+	m_tasks[id].LastJitter = 0;
+}
+
+/**
+ * @brief Scheduler instance.
+ *
+ */
+CoopSchedulerClass CoopScheduler;
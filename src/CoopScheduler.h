@@ -0,0 +1,144 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// CoopScheduler.h
+
+#ifndef _COOPSCHEDULER_h
+#define _COOPSCHEDULER_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+/**
+ * @brief Maximum scheduled tasks.
+ */
+#define SCHEDULER_MAX_TASKS 8
+
+/** @brief Scheduled task description and timing statistics. */
+typedef struct
+{
+	void (*Callback)();	 ///< Task function.
+	uint32_t Period;	 ///< Period in us.
+	uint32_t Deadline;	 ///< Next release time in us.
+	uint8_t Priority;	 ///< Higher runs first when several tasks are due.
+	uint32_t Runs;		 ///< Executions count.
+	uint32_t Overruns;	 ///< Missed releases count.
+	uint32_t MaxJitter;	 ///< Worst start lateness in us.
+	uint32_t LastJitter; ///< Last start lateness in us.
+} SchedulerTask_t;
+
+/** @brief Deadline-ordered cooperative scheduler.
+ *
+ *  Releases are kept in a min-heap by deadline. Every release is anchored
+ *  to the previous one, so periods do not drift with the execution time.
+ */
+class CoopSchedulerClass
+{
+protected:
+#pragma region Variables
+
+	/** @brief Registered tasks. */
+	SchedulerTask_t m_tasks[SCHEDULER_MAX_TASKS];
+
+	/** @brief Min-heap of task indexes ordered by deadline. */
+	uint8_t m_heap[SCHEDULER_MAX_TASKS];
+
+	/** @brief Registered tasks count. */
+	uint8_t m_tasksCount = 0;
+
+	/** @brief Tasks in the heap. */
+	uint8_t m_heapCount = 0;
+
+	/** @brief Idle callback. */
+	void (*callbackIdle)(uint32_t);
+
+#pragma endregion
+
+#pragma region Methods
+
+	/** @brief Deadline order of two tasks, wrap safe.
+	 *  @return bool, True when task a is due before task b.
+	 */
+	bool before(uint8_t a, uint8_t b);
+
+	/** @brief Push a task to the heap.
+	 *  @param index uint8_t, Task index.
+	 *  @return Void.
+	 */
+	void push(uint8_t index);
+
+	/** @brief Pop the earliest task from the heap.
+	 *  @return uint8_t, Task index.
+	 */
+	uint8_t pop();
+
+#pragma endregion
+
+public:
+#pragma region Methods
+
+	/** @brief Register a periodic task.
+	 *  @param callback, Task function.
+	 *  @param period uint32_t, Period in us.
+	 *  @param phase uint32_t, Offset of the first release in us.
+	 *  @param priority uint8_t, Higher runs first when several tasks are due.
+	 *  @return int, Task id or -1 when full.
+	 */
+	int addTask(void (*callback)(), uint32_t period, uint32_t phase, uint8_t priority);
+
+	/** @brief Set the idle callback, it gets the time to the next release.
+	 *  @param callback, Idle callback.
+	 *  @return Void.
+	 */
+	void setCbIdle(void (*callback)(uint32_t));
+
+	/** @brief Run all due tasks, call it from loop().
+	 *  @return uint32_t, Time to the next release in us.
+	 */
+	uint32_t run();
+
+	/** @brief Get the task description and statistics.
+	 *  @param id int, Task id.
+	 *  @return const SchedulerTask_t*, Task or nullptr.
+	 */
+	const SchedulerTask_t *getTask(int id);
+
+	/** @brief Clear the task statistics.
+	 *  @param id int, Task id.
+	 *  @return Void.
+	 */
+	void resetStats(int id);
+
+#pragma endregion
+};
+
+/** @brief Instance of the scheduler. */
+extern CoopSchedulerClass CoopScheduler;
+
+#endif
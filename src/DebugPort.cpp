@@ -35,12 +35,22 @@ void configure_debug_port()
 #ifdef ENABLE_DEBUG_OUT
 
 	DEBUG_PORT.begin(DEBUG_PORT_BAUDRATE, SERIAL_8N1);
-	DEBUG_PORT.print("\r\n\r\n\r\n");
 	// DEBUG_PORT.setDebugOutput(true);
 
-	DEBUGLOG("\r\n");
-	DEBUGLOG(__PRETTY_FUNCTION__);
-	DEBUGLOG("\r\n");
+	LOG_INFO("%s", __PRETTY_FUNCTION__);
+
+#endif // ENABLE_DEBUG_OUT
+}
+
+/** @brief Send the queued log records to the debug port, never blocks.
+ *  @return Void
+ */
+void drain_debug_port()
+{
+
+#ifdef ENABLE_DEBUG_OUT
+
+	Log.drain(DEBUG_PORT);
 
 #endif // ENABLE_DEBUG_OUT
 }
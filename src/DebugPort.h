@@ -37,6 +37,8 @@ SOFTWARE.
 
 #pragma region Headers
 
+#include "Log.h"
+
 #pragma endregion
 
 #pragma region Definitions
@@ -45,13 +47,7 @@ SOFTWARE.
 
 #define DEBUG_PORT Serial
 
-#define DEBUG_PORT_BAUDRATE 9600
-
-#ifdef ENABLE_DEBUG_OUT
-#define DEBUGLOG(...) DEBUG_PORT.print(__VA_ARGS__)
-#else
-#define DEBUGLOG(...)
-#endif
+#define DEBUG_PORT_BAUDRATE 115200
 
 #pragma endregion
 
@@ -62,6 +58,11 @@ SOFTWARE.
  */
 void configure_debug_port();
 
+/** @brief Send the queued log records to the debug port, never blocks.
+ *  @return Void
+ */
+void drain_debug_port();
+
 #pragma endregion
 
 #endif
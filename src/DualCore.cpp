@@ -0,0 +1,131 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "DualCore.h"
+
+#if defined(ESP32)
+
+/** @brief Control task body.
+ *  @param arg void*, Runtime instance.
+ *  @return Void.
+ */
+void DualCoreClass::controlTask(void *arg)
+{
+	DualCoreClass *RuntimeL = (DualCoreClass *)arg;
+	TickType_t LastWakeL = xTaskGetTickCount();
+
+	for (;;)
+	{
+		RuntimeL->callbackControl();
+		RuntimeL->m_cycles++;
+
+		// The next release is already in the past.
+		if ((TickType_t)(xTaskGetTickCount() - LastWakeL) >= RuntimeL->m_period)
+		{
+			RuntimeL->m_overruns++;
+		}
+
+		vTaskDelayUntil(&LastWakeL, RuntimeL->m_period);
+	}
+}
+
+/** @brief Comms task body.
+ *  @param arg void*, Runtime instance.
+ *  @return Void.
+ */
+void DualCoreClass::commsTask(void *arg)
+{
+	DualCoreClass *RuntimeL = (DualCoreClass *)arg;
+
+	for (;;)
+	{
+		RuntimeL->callbackComms();
+
+		// Let the idle task feed the watchdog.
+		vTaskDelay(1);
+	}
+}
+
+/** @brief Start both tasks.
+ *  @param control, Control function, must not block.
+ *  @param periodMs uint32_t, Control period in ms.
+ *  @param comms, Comms function, may block.
+ *  @return bool, True when both tasks are created.
+ */
+bool DualCoreClass::begin(void (*control)(), uint32_t periodMs, void (*comms)())
+{
+	if (control == nullptr || comms == nullptr || m_controlTask != nullptr)
+	{
+		return false;
+	}
+
+	callbackControl = control;
+	callbackComms = comms;
+	m_period = max(pdMS_TO_TICKS(periodMs), (TickType_t)1);
+
+	if (xTaskCreatePinnedToCore(controlTask, "control", DUALCORE_STACK_SIZE, this,
+								DUALCORE_CONTROL_PRIORITY, &m_controlTask, DUALCORE_CONTROL_CORE) != pdPASS)
+	{
+		m_controlTask = nullptr;
+		return false;
+	}
+
+	if (xTaskCreatePinnedToCore(commsTask, "comms", DUALCORE_STACK_SIZE, this,
+								DUALCORE_COMMS_PRIORITY, &m_commsTask, DUALCORE_COMMS_CORE) != pdPASS)
+	{
+		// Leave nothing running, a later begin() may try again.
+		vTaskDelete(m_controlTask);
+		m_controlTask = nullptr;
+		m_commsTask = nullptr;
+		return false;
+	}
+
+	return true;
+}
+
+/** @brief Get control cycles count.
+ *  @return uint32_t, Count.
+ */
+uint32_t DualCoreClass::getCycles()
+{
+	return m_cycles;
+}
+
+/** @brief Get control overruns count.
+ *  @return uint32_t, Count.
+ */
+uint32_t DualCoreClass::getOverruns()
+{
+	return m_overruns;
+}
+
+/**
+ * @brief Dual core runtime instance.
+ *
+ */
+DualCoreClass DualCore;
+
+#endif // ESP32
@@ -0,0 +1,146 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// DualCore.h
+
+#ifndef _DUALCORE_h
+#define _DUALCORE_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include "SPSCQueue.h"
+
+#if defined(ESP32)
+
+/**
+ * @brief Core for sensing and motor control.
+ */
+#define DUALCORE_CONTROL_CORE 1
+
+/**
+ * @brief Core for networking and logging, shared with the Wi-Fi stack.
+ */
+#define DUALCORE_COMMS_CORE 0
+
+/**
+ * @brief Control task priority.
+ */
+#define DUALCORE_CONTROL_PRIORITY (configMAX_PRIORITIES - 2)
+
+/**
+ * @brief Comms task priority.
+ */
+#define DUALCORE_COMMS_PRIORITY 1
+
+/**
+ * @brief Tasks stack size in bytes.
+ */
+#define DUALCORE_STACK_SIZE 4096
+
+/** @brief Two core FreeRTOS runtime for ESP32.
+ *
+ *  The control function runs at a fixed rate on its own core, the comms
+ *  function runs continuously on the other one. Data between them should
+ *  only pass through SPSCQueue instances, one per direction.
+ */
+class DualCoreClass
+{
+protected:
+#pragma region Variables
+
+	/** @brief Control function. */
+	void (*callbackControl)();
+
+	/** @brief Comms function. */
+	void (*callbackComms)();
+
+	/** @brief Control period in ticks. */
+	TickType_t m_period;
+
+	/** @brief Control cycles count. */
+	volatile uint32_t m_cycles = 0;
+
+	/** @brief Control cycles that ran past their period. */
+	volatile uint32_t m_overruns = 0;
+
+	/** @brief Control task handle. */
+	TaskHandle_t m_controlTask = nullptr;
+
+	/** @brief Comms task handle. */
+	TaskHandle_t m_commsTask = nullptr;
+
+#pragma endregion
+
+#pragma region Methods
+
+	/** @brief Control task body.
+	 *  @param arg void*, Runtime instance.
+	 *  @return Void.
+	 */
+	static void controlTask(void *arg);
+
+	/** @brief Comms task body.
+	 *  @param arg void*, Runtime instance.
+	 *  @return Void.
+	 */
+	static void commsTask(void *arg);
+
+#pragma endregion
+
+public:
+#pragma region Methods
+
+	/** @brief Start both tasks.
+	 *  @param control, Control function, must not block.
+	 *  @param periodMs uint32_t, Control period in ms.
+	 *  @param comms, Comms function, may block.
+	 *  @return bool, True when both tasks are created.
+	 */
+	bool begin(void (*control)(), uint32_t periodMs, void (*comms)());
+
+	/** @brief Get control cycles count.
+	 *  @return uint32_t, Count.
+	 */
+	uint32_t getCycles();
+
+	/** @brief Get control overruns count.
+	 *  @return uint32_t, Count.
+	 */
+	uint32_t getOverruns();
+
+#pragma endregion
+};
+
+/** @brief Instance of the dual core runtime. */
+extern DualCoreClass DualCore;
+
+#endif // ESP32
+
+#endif
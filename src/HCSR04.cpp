@@ -24,9 +24,9 @@ SOFTWARE.
 
 */
 
-#include <stdlib.h>
-#include <string.h>
 #include "HCSR04.h"
+#include "Profiler.h"
+#include "IOCapture.h"
 
 void HCSR04::init(int tp, int ep)
 {
@@ -36,156 +36,141 @@ void HCSR04::init(int tp, int ep)
 	m_echoPin = ep;
 	m_cmDivisor = 27.6233;
 	m_inDivisor = 70.1633;
+	m_asyncState = ASYNC_IDLE;
+	m_timeout = HCSR04_TIMEOUT_US;
+	m_cbMeasurement = nullptr;
 }
 
 long HCSR04::timing()
 {
+	PROFILE_ZONE("HCSR04.timing");
+
 	digitalWrite(m_trigPin, LOW);
 	delayMicroseconds(2);
 	digitalWrite(m_trigPin, HIGH);
 	delayMicroseconds(10);
 	digitalWrite(m_trigPin, LOW);
-	return pulseIn(m_echoPin, HIGH);
+	return CAPTURE_SONAR((long)pulseIn(m_echoPin, HIGH, m_timeout));
 }
 
-float HCSR04::convert(long microsec, int metric)
+bool HCSR04::trigger()
 {
-	// microsec / 29 / 2;
-	if (metric)
-		return microsec / m_cmDivisor / 2.0; // CM
-	// microsec / 74 / 2;
-	else
-		return microsec / m_inDivisor / 2.0; // IN
-}
+	if (isBusy())
+		return false;
 
-void HCSR04::setDivisor(float value, int metric)
-{
-	if (metric)
-		m_cmDivisor = value;
-	else
-		m_inDivisor = value;
+	m_asyncState = ASYNC_WAIT_ECHO;
+	digitalWrite(m_trigPin, LOW);
+	delayMicroseconds(2);
+	digitalWrite(m_trigPin, HIGH);
+	delayMicroseconds(10);
+	digitalWrite(m_trigPin, LOW);
+	m_trigTime = micros();
+	return true;
 }
 
-#ifdef COMPILE_STD_DEV
-bool HCSR04::sampleCreate(size_t numBufs, ...)
+void HCSR04::echoISR()
 {
-	bool result = false;
-	va_list ap;
-	m_numBufs = numBufs;
+	unsigned long now = micros();
 
-	if ((m_pBuffers = (BufCtl *)calloc(numBufs, sizeof(BufCtl))) != NULL)
+	if (digitalRead(m_echoPin) == HIGH)
 	{
-		va_start(ap, numBufs);
-		BufCtl *buf;
-		size_t smpSize;
-
-		for (size_t i = 0; i < m_numBufs; i++)
+		if (m_asyncState == ASYNC_WAIT_ECHO)
 		{
-			buf = &m_pBuffers[i];
-			smpSize = va_arg(ap, size_t);
-
-			if ((buf->pBegin = (float *)calloc(smpSize, sizeof(float))) != NULL)
-			{
-				buf->pIndex = buf->pBegin;
-				buf->length = smpSize;
-				buf->filled = false;
-				result = true;
-			}
-			else
-			{
-				result = false;
-				break;
-			}
+			m_echoStart = now;
+			m_asyncState = ASYNC_ECHO;
 		}
-
-		va_end(ap);
 	}
-
-	if (!result)
-		freeBuffers();
-	return result;
+	else if (m_asyncState == ASYNC_ECHO)
+	{
+		m_echoEnd = now;
+		m_asyncState = ASYNC_DONE;
+	}
 }
 
-void HCSR04::sampleClear()
+bool HCSR04::poll(long *microsec)
 {
-	if (m_pBuffers)
+	long result = -1;
+
+	if (m_asyncState == ASYNC_DONE)
+	{
+		// The ISR does not touch a finished measurement.
+		result = m_echoEnd - m_echoStart;
+	}
+	else if (m_asyncState != ASYNC_IDLE && (micros() - m_trigTime) > m_timeout)
 	{
-		BufCtl *buf;
+		// No echo, report zero the same way pulseIn() does.
+		result = 0;
+	}
 
-		for (size_t i = 0; i < m_numBufs; i++)
-		{
-			buf = &m_pBuffers[i];
-			memset(buf, '\0', sizeof(float) * buf->length);
-			buf->pIndex = buf->pBegin;
-			buf->filled = false;
-		}
+	// A replay decides when the measurement is done.
+	result = CAPTURE_SONAR(result);
+	if (result < 0)
+	{
+		return false;
 	}
+
+	noInterrupts();
+	m_asyncState = ASYNC_IDLE;
+	interrupts();
+
+	if (microsec != nullptr)
+		*microsec = result;
+	if (m_cbMeasurement != nullptr)
+		m_cbMeasurement(result);
+	return true;
 }
 
-float HCSR04::unbiasedStdDev(float value, size_t bufNum)
+bool HCSR04::isBusy()
 {
-	float result = 0.0;
+	return m_asyncState == ASYNC_WAIT_ECHO || m_asyncState == ASYNC_ECHO;
+}
 
-	if (m_pBuffers)
-	{
-		BufCtl *buf = &m_pBuffers[bufNum];
+void HCSR04::setTimeout(unsigned long microsec)
+{
+	m_timeout = microsec;
+}
 
-		if (buf->length > 1)
-		{
-			sampleUpdate(buf, float(value));
-
-			if (buf->filled)
-			{
-				float sum = 0.0, mean, tmp;
-
-				for (size_t i = 0; i < buf->length; i++)
-					sum += buf->pBegin[i];
-
-				mean = sum / buf->length;
-				sum = 0.0;
-
-				for (size_t i = 0; i < buf->length; i++)
-				{
-					tmp = buf->pBegin[i] - mean;
-					sum += (tmp * tmp);
-				}
-
-				result = sqrt(sum / (buf->length - 1));
-				// DEBUGLOG(bufNum);
-				// DEBUGLOG(" : ");
-				// DEBUGLOG(result);
-				// DEBUGLOG("\r\n");
-			}
-		}
-	}
+void HCSR04::setCbMeasurement(void (*callback)(long))
+{
+	m_cbMeasurement = callback;
+}
 
-	return result;
+float HCSR04::convert(long microsec, int metric)
+{
+	// microsec / 29 / 2;
+	if (metric)
+		return microsec / m_cmDivisor / 2.0; // CM
+	// microsec / 74 / 2;
+	else
+		return microsec / m_inDivisor / 2.0; // IN
 }
 
-void HCSR04::sampleUpdate(BufCtl *buf, float msec)
+void HCSR04::setDivisor(float value, int metric)
 {
-	if (buf->pIndex >= (buf->pBegin + buf->length))
-	{
-		buf->pIndex = buf->pBegin;
-		buf->filled = true;
-	}
+	if (metric)
+		m_cmDivisor = value;
+	else
+		m_inDivisor = value;
+}
 
-	*(buf->pIndex++) = msec;
+#ifdef COMPILE_STD_DEV
+void HCSR04::sampleClear()
+{
+	m_stats.clear();
 }
 
-void HCSR04::freeBuffers()
+float HCSR04::unbiasedStdDev(float value)
 {
-	if (m_pBuffers)
-	{
-		BufCtl *buf;
+	m_stats.update(value);
 
-		for (size_t i = 0; i < m_numBufs; i++)
-		{
-			buf = &m_pBuffers[i];
-			free(buf->pBegin);
-		}
+	if (m_stats.filled())
+		return m_stats.stdDev();
 
-		free(m_pBuffers);
-	}
+	return 0.0;
+}
+
+SlidingStats<HCSR04_STATS_WINDOW> &HCSR04::stats()
+{
+	return m_stats;
 }
 #endif // COMPILE_STD_DEV
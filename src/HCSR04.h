@@ -38,13 +38,17 @@ SOFTWARE.
 // Undefine COMPILE_STD_DEV if you don't want Standard Deviation.
 #define COMPILE_STD_DEV
 
-typedef struct bufferCtl
-{
-	float *pBegin;
-	float *pIndex;
-	size_t length;
-	bool filled;
-} BufCtl;
+#ifdef COMPILE_STD_DEV
+#include "SlidingStats.h"
+
+// Statistics window size in samples.
+#ifndef HCSR04_STATS_WINDOW
+#define HCSR04_STATS_WINDOW 10
+#endif
+#endif // COMPILE_STD_DEV
+
+// Echo timeout in microseconds, about 5 m round trip.
+#define HCSR04_TIMEOUT_US 30000UL
 
 class HCSR04
 {
@@ -55,11 +59,16 @@ protected:
 	float m_cmDivisor;
 	float m_inDivisor;
 
+	// Asynchronous ranging state.
+	volatile uint8_t m_asyncState;
+	volatile unsigned long m_echoStart;
+	volatile unsigned long m_echoEnd;
+	unsigned long m_trigTime;
+	unsigned long m_timeout;
+	void (*m_cbMeasurement)(long);
+
 #ifdef COMPILE_STD_DEV
-	size_t m_numBufs;
-	BufCtl *m_pBuffers;
-	void sampleUpdate(BufCtl *buf, float msec);
-	void freeBuffers();
+	SlidingStats<HCSR04_STATS_WINDOW> m_stats;
 #endif // COMPILE_STD_DEV
 
 public:
@@ -70,10 +79,23 @@ public:
 	static const int IN = 0;
 	static const int CM = 1;
 
+	// Asynchronous ranging, echo pin must be interrupt capable.
+	// Attach echoISR() to the echo pin on CHANGE.
+	bool trigger();
+	void echoISR();
+	bool poll(long *microsec);
+	bool isBusy();
+	void setTimeout(unsigned long microsec);
+	void setCbMeasurement(void (*callback)(long));
+	static const uint8_t ASYNC_IDLE = 0;
+	static const uint8_t ASYNC_WAIT_ECHO = 1;
+	static const uint8_t ASYNC_ECHO = 2;
+	static const uint8_t ASYNC_DONE = 3;
+
 #ifdef COMPILE_STD_DEV
-	bool sampleCreate(size_t size, ...);
 	void sampleClear();
-	float unbiasedStdDev(float value, size_t bufNum);
+	float unbiasedStdDev(float value);
+	SlidingStats<HCSR04_STATS_WINDOW> &stats();
 #endif // COMPILE_STD_DEV
 };
 
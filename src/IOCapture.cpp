@@ -0,0 +1,638 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// IOCapture.cpp
+
+#include "IOCapture.h"
+
+#if defined(__AVR__)
+#include <util/atomic.h>
+#define CAPTURE_LOCK() ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+#define CAPTURE_UNLOCK()
+#elif defined(ESP32)
+#define CAPTURE_LOCK() portENTER_CRITICAL_SAFE(&m_mux);
+#define CAPTURE_UNLOCK() portEXIT_CRITICAL_SAFE(&m_mux);
+#else
+#define CAPTURE_LOCK() noInterrupts();
+#define CAPTURE_UNLOCK() interrupts();
+#endif
+
+#pragma region Functions
+
+/** @brief Write an unsigned LEB128 varint.
+ *  @param out uint8_t*, Output.
+ *  @param value uint32_t, Value.
+ *  @return uint8_t, Written bytes count.
+ */
+static uint8_t put_varint(uint8_t *out, uint32_t value)
+{
+	uint8_t CountL = 0;
+
+	while (value >= 0x80)
+	{
+		out[CountL++] = (uint8_t)(value | 0x80);
+		value >>= 7;
+	}
+	out[CountL++] = (uint8_t)value;
+
+	return CountL;
+}
+
+/** @brief Map signed to unsigned, small magnitudes to small codes.
+ *  @param value int32_t, Value.
+ *  @return uint32_t, Code.
+ */
+static inline uint32_t zigzag(int32_t value)
+{
+	return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+/** @brief Inverse of zigzag().
+ *  @param code uint32_t, Code.
+ *  @return int32_t, Value.
+ */
+static inline int32_t unzigzag(uint32_t code)
+{
+	return (int32_t)(code >> 1) ^ -(int32_t)(code & 1);
+}
+
+#pragma endregion
+
+#pragma region Methods
+
+bool IOCaptureClass::beginRecord(size_t size)
+{
+	m_mode = IO_CAPTURE_OFF;
+
+	if (m_buffer != nullptr && m_size != size)
+	{
+		delete[] m_buffer;
+		m_buffer = nullptr;
+	}
+
+	if (m_buffer == nullptr)
+	{
+		m_buffer = new uint8_t[size];
+		if (m_buffer == nullptr)
+		{
+			return false;
+		}
+		m_size = size;
+	}
+
+	m_head = 0;
+	m_tail = 0;
+	m_lost = 0;
+	m_events = 0;
+	m_lastTime = micros();
+	clearCoding();
+
+	// The stream starts with its version.
+	uint32_t VersionL = IO_CAPTURE_VERSION;
+	append(IO_EVENT_MARK << 5, &VersionL, 1, nullptr, 0);
+
+	m_mode = IO_CAPTURE_RECORD;
+
+	return true;
+}
+
+void IOCaptureClass::end()
+{
+	m_mode = IO_CAPTURE_OFF;
+}
+
+size_t IOCaptureClass::drain(Print &out, size_t maxBytes)
+{
+	size_t WrittenL = 0;
+
+	// At most two chunks, before and after the buffer end.
+	for (uint8_t chunk = 0; chunk < 2 && WrittenL < maxBytes; chunk++)
+	{
+		size_t HeadL;
+		CAPTURE_LOCK()
+		{
+			HeadL = m_head;
+		}
+		CAPTURE_UNLOCK()
+
+		size_t TailL = m_tail;
+		size_t CountL = HeadL >= TailL ? HeadL - TailL : m_size - TailL;
+		CountL = min(CountL, maxBytes - WrittenL);
+		if (CountL == 0)
+		{
+			break;
+		}
+
+		out.write(m_buffer + TailL, CountL);
+		WrittenL += CountL;
+
+		TailL += CountL;
+		if (TailL == m_size)
+		{
+			TailL = 0;
+		}
+
+		CAPTURE_LOCK()
+		{
+			m_tail = TailL;
+		}
+		CAPTURE_UNLOCK()
+	}
+
+	return WrittenL;
+}
+
+IOCaptureMode IOCaptureClass::getMode()
+{
+	return m_mode;
+}
+
+uint32_t IOCaptureClass::getEvents()
+{
+	return m_events;
+}
+
+uint32_t IOCaptureClass::getLost()
+{
+	return m_lost;
+}
+
+#ifdef ENABLE_IO_REPLAY
+
+bool IOCaptureClass::beginReplay(const uint8_t *data, size_t size)
+{
+	m_mode = IO_CAPTURE_OFF;
+
+	m_replay = data;
+	m_replaySize = size;
+	m_replayPos = 0;
+	m_replayTime = 0;
+	m_delivering = false;
+	m_diverged = false;
+	m_lossy = false;
+	m_matches = 0;
+	m_mismatches = 0;
+	m_events = 0;
+	clearCoding();
+
+	uint32_t VersionL = 0;
+	if (!nextEvent(IO_EVENT_MARK << 5, &VersionL, 1) || VersionL != IO_CAPTURE_VERSION)
+	{
+		return false;
+	}
+
+	m_mode = IO_CAPTURE_REPLAY;
+
+	return true;
+}
+
+void IOCaptureClass::setCbEncoder(void (*callback)(uint8_t channel))
+{
+	m_cbEncoder = callback;
+}
+
+void IOCaptureClass::setCbCommand(void (*callback)(const uint8_t *data, uint8_t size))
+{
+	m_cbCommand = callback;
+}
+
+bool IOCaptureClass::isReplayDone()
+{
+	return m_replayPos >= m_replaySize;
+}
+
+bool IOCaptureClass::isDiverged()
+{
+	return m_diverged;
+}
+
+bool IOCaptureClass::isLossy()
+{
+	return m_lossy;
+}
+
+uint32_t IOCaptureClass::getMatches()
+{
+	return m_matches;
+}
+
+uint32_t IOCaptureClass::getMismatches()
+{
+	return m_mismatches;
+}
+
+uint32_t IOCaptureClass::getReplayTime()
+{
+	return m_replayTime;
+}
+
+#endif // ENABLE_IO_REPLAY
+
+#pragma endregion
+
+#pragma region Private Methods
+
+void IOCaptureClass::clearCoding()
+{
+	memset(m_lastLine, 0, sizeof(m_lastLine));
+	memset(m_lastClock, 0, sizeof(m_lastClock));
+}
+
+bool IOCaptureClass::append(uint8_t header, const uint32_t *payload, uint8_t count, const uint8_t *data, uint8_t size)
+{
+	uint8_t EventL[1 + 5 + 2 * 5 + IO_CAPTURE_COMMAND_SIZE];
+	uint8_t LostL[1 + 1 + 5];
+	bool DoneL = false;
+
+	// Payload first, the time stamp is taken under the lock to keep the ISR events in order.
+	uint8_t PayloadL[2 * 5 + IO_CAPTURE_COMMAND_SIZE];
+	uint8_t PayloadSizeL = 0;
+	for (uint8_t index = 0; index < count; index++)
+	{
+		PayloadSizeL += put_varint(PayloadL + PayloadSizeL, payload[index]);
+	}
+	if (size > 0)
+	{
+		memcpy(PayloadL + PayloadSizeL, data, size);
+		PayloadSizeL += size;
+	}
+
+	CAPTURE_LOCK()
+	{
+		uint32_t TicksL = (micros() - m_lastTime) >> IO_CAPTURE_TIME_SHIFT;
+
+		uint8_t LengthL = 0;
+		EventL[LengthL++] = header;
+		LengthL += put_varint(EventL + LengthL, TicksL);
+		memcpy(EventL + LengthL, PayloadL, PayloadSizeL);
+		LengthL += PayloadSizeL;
+
+		// Report the lost events before the first one that fits.
+		uint8_t LostLengthL = 0;
+		if (m_lost > 0)
+		{
+			LostL[LostLengthL++] = (IO_EVENT_MARK << 5) | 1;
+			LostL[LostLengthL++] = 0;
+			LostLengthL += put_varint(LostL + LostLengthL, m_lost);
+		}
+
+		size_t FreeL = m_tail + m_size - m_head - 1;
+		if (FreeL >= m_size)
+		{
+			FreeL -= m_size;
+		}
+
+		if ((size_t)LostLengthL + LengthL <= FreeL)
+		{
+			size_t HeadL = m_head;
+			for (uint8_t index = 0; index < LostLengthL; index++)
+			{
+				m_buffer[HeadL] = LostL[index];
+				if (++HeadL == m_size)
+				{
+					HeadL = 0;
+				}
+			}
+			for (uint8_t index = 0; index < LengthL; index++)
+			{
+				m_buffer[HeadL] = EventL[index];
+				if (++HeadL == m_size)
+				{
+					HeadL = 0;
+				}
+			}
+			m_head = HeadL;
+
+			m_lastTime += TicksL << IO_CAPTURE_TIME_SHIFT;
+			m_lost = 0;
+			m_events++;
+			DoneL = true;
+		}
+		else
+		{
+			m_lost++;
+		}
+	}
+	CAPTURE_UNLOCK()
+
+	return DoneL;
+}
+
+#ifdef ENABLE_IO_REPLAY
+
+bool IOCaptureClass::readVarint(uint32_t *value)
+{
+	uint32_t ValueL = 0;
+
+	for (uint8_t shift = 0; shift < 35; shift += 7)
+	{
+		if (m_replayPos >= m_replaySize)
+		{
+			return false;
+		}
+
+		uint8_t ByteL = m_replay[m_replayPos++];
+		ValueL |= (uint32_t)(ByteL & 0x7F) << shift;
+		if ((ByteL & 0x80) == 0)
+		{
+			*value = ValueL;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool IOCaptureClass::readEvent(uint8_t *header, uint32_t *payload, const uint8_t **data, uint8_t *size)
+{
+	uint32_t TicksL = 0;
+
+	if (m_replayPos >= m_replaySize)
+	{
+		return false;
+	}
+
+	*header = m_replay[m_replayPos++];
+	if (!readVarint(&TicksL))
+	{
+		return false;
+	}
+	m_replayTime += TicksL << IO_CAPTURE_TIME_SHIFT;
+
+	*size = 0;
+	switch (*header >> 5)
+	{
+	case IO_EVENT_ENCODER:
+		return true;
+	case IO_EVENT_OUTPUT:
+		return readVarint(&payload[0]) && readVarint(&payload[1]);
+	case IO_EVENT_COMMAND:
+		if (!readVarint(&payload[0]) || payload[0] > IO_CAPTURE_COMMAND_SIZE || m_replayPos + payload[0] > m_replaySize)
+		{
+			return false;
+		}
+		*data = m_replay + m_replayPos;
+		*size = (uint8_t)payload[0];
+		m_replayPos += payload[0];
+		return true;
+	default:
+		return readVarint(&payload[0]);
+	}
+}
+
+bool IOCaptureClass::nextEvent(uint8_t header, uint32_t *payload, uint8_t count)
+{
+	uint8_t HeaderL = 0;
+	uint32_t PayloadL[2] = {0, 0};
+	const uint8_t *DataL = nullptr;
+	uint8_t SizeL = 0;
+
+	deliver();
+
+	if (m_diverged || !readEvent(&HeaderL, PayloadL, &DataL, &SizeL) || HeaderL != header)
+	{
+		m_diverged = true;
+		return false;
+	}
+
+	for (uint8_t index = 0; index < count; index++)
+	{
+		payload[index] = PayloadL[index];
+	}
+	m_events++;
+
+	return true;
+}
+
+void IOCaptureClass::deliver()
+{
+	uint8_t HeaderL = 0;
+	uint32_t PayloadL[2] = {0, 0};
+	const uint8_t *DataL = nullptr;
+	uint8_t SizeL = 0;
+
+	// Hand over the asynchronous events logged before the next synchronous one.
+	while (!m_diverged)
+	{
+		size_t PosL = m_replayPos;
+		uint32_t TimeL = m_replayTime;
+
+		if (!readEvent(&HeaderL, PayloadL, &DataL, &SizeL))
+		{
+			m_replayPos = PosL;
+			m_replayTime = TimeL;
+			return;
+		}
+
+		uint8_t TypeL = HeaderL >> 5;
+		if (TypeL == IO_EVENT_ENCODER)
+		{
+			m_delivering = true;
+			if (m_cbEncoder != nullptr)
+			{
+				m_cbEncoder(HeaderL & 0x1F);
+			}
+			m_delivering = false;
+		}
+		else if (TypeL == IO_EVENT_COMMAND)
+		{
+			if (m_cbCommand != nullptr)
+			{
+				m_cbCommand(DataL, SizeL);
+			}
+		}
+		else if (HeaderL == ((IO_EVENT_MARK << 5) | 1))
+		{
+			m_lossy = true;
+		}
+		else
+		{
+			m_replayPos = PosL;
+			m_replayTime = TimeL;
+			return;
+		}
+
+		m_events++;
+	}
+}
+
+#endif // ENABLE_IO_REPLAY
+
+uint16_t IOCaptureClass::lineSensorSlow(uint8_t index, uint16_t value)
+{
+	if (index >= IO_CAPTURE_LINE_CHANNELS)
+	{
+		return value;
+	}
+
+	if (m_mode == IO_CAPTURE_RECORD)
+	{
+		uint32_t DeltaL = zigzag((int16_t)(value - m_lastLine[index]));
+		if (append((IO_EVENT_LINE << 5) | index, &DeltaL, 1, nullptr, 0))
+		{
+			m_lastLine[index] = value;
+		}
+	}
+#ifdef ENABLE_IO_REPLAY
+	else if (m_mode == IO_CAPTURE_REPLAY)
+	{
+		uint32_t DeltaL = 0;
+		if (nextEvent((IO_EVENT_LINE << 5) | index, &DeltaL, 1))
+		{
+			m_lastLine[index] += (int16_t)unzigzag(DeltaL);
+			return m_lastLine[index];
+		}
+	}
+#endif
+
+	return value;
+}
+
+bool IOCaptureClass::encoderSlow(uint8_t channel)
+{
+	if (m_mode == IO_CAPTURE_RECORD)
+	{
+		append((IO_EVENT_ENCODER << 5) | (channel & 0x1F), nullptr, 0, nullptr, 0);
+	}
+#ifdef ENABLE_IO_REPLAY
+	else if (m_mode == IO_CAPTURE_REPLAY && !m_diverged)
+	{
+		// Only the logged edges count.
+		return m_delivering;
+	}
+#endif
+
+	return true;
+}
+
+long IOCaptureClass::sonarSlow(long value)
+{
+	if (m_mode == IO_CAPTURE_RECORD)
+	{
+		uint32_t CodeL = (uint32_t)(value + 1);
+		append(IO_EVENT_SONAR << 5, &CodeL, 1, nullptr, 0);
+	}
+#ifdef ENABLE_IO_REPLAY
+	else if (m_mode == IO_CAPTURE_REPLAY)
+	{
+		uint32_t CodeL = 0;
+		if (nextEvent(IO_EVENT_SONAR << 5, &CodeL, 1))
+		{
+			return (long)CodeL - 1;
+		}
+	}
+#endif
+
+	return value;
+}
+
+uint32_t IOCaptureClass::clockSlow(uint8_t channel, uint32_t value)
+{
+	channel &= 1;
+
+	if (m_mode == IO_CAPTURE_RECORD)
+	{
+		uint32_t DeltaL = value - m_lastClock[channel];
+		if (append((IO_EVENT_CLOCK << 5) | channel, &DeltaL, 1, nullptr, 0))
+		{
+			m_lastClock[channel] = value;
+		}
+	}
+#ifdef ENABLE_IO_REPLAY
+	else if (m_mode == IO_CAPTURE_REPLAY)
+	{
+		uint32_t DeltaL = 0;
+		if (nextEvent((IO_EVENT_CLOCK << 5) | channel, &DeltaL, 1))
+		{
+			m_lastClock[channel] += DeltaL;
+			return m_lastClock[channel];
+		}
+	}
+#endif
+
+	return value;
+}
+
+int32_t IOCaptureClass::inputSlow(uint8_t channel, int32_t value)
+{
+	if (m_mode == IO_CAPTURE_RECORD)
+	{
+		uint32_t CodeL = zigzag(value);
+		append((IO_EVENT_INPUT << 5) | (channel & 0x1F), &CodeL, 1, nullptr, 0);
+	}
+#ifdef ENABLE_IO_REPLAY
+	else if (m_mode == IO_CAPTURE_REPLAY)
+	{
+		uint32_t CodeL = 0;
+		if (nextEvent((IO_EVENT_INPUT << 5) | (channel & 0x1F), &CodeL, 1))
+		{
+			return unzigzag(CodeL);
+		}
+	}
+#endif
+
+	return value;
+}
+
+void IOCaptureClass::commandSlow(const uint8_t *data, uint8_t size)
+{
+	// The replay delivers the logged commands through the callback.
+	if (m_mode == IO_CAPTURE_RECORD)
+	{
+		uint32_t SizeL = min(size, (uint8_t)IO_CAPTURE_COMMAND_SIZE);
+		append(IO_EVENT_COMMAND << 5, &SizeL, 1, data, (uint8_t)SizeL);
+	}
+}
+
+void IOCaptureClass::outputSlow(int16_t left, int16_t right)
+{
+	if (m_mode == IO_CAPTURE_RECORD)
+	{
+		uint32_t CodeL[2] = {zigzag(left), zigzag(right)};
+		append(IO_EVENT_OUTPUT << 5, CodeL, 2, nullptr, 0);
+	}
+#ifdef ENABLE_IO_REPLAY
+	else if (m_mode == IO_CAPTURE_REPLAY)
+	{
+		uint32_t CodeL[2] = {0, 0};
+		if (nextEvent(IO_EVENT_OUTPUT << 5, CodeL, 2))
+		{
+			if (unzigzag(CodeL[0]) == left && unzigzag(CodeL[1]) == right)
+			{
+				m_matches++;
+			}
+			else
+			{
+				m_mismatches++;
+			}
+		}
+	}
+#endif
+}
+
+#pragma endregion
+
+IOCaptureClass IOCapture;
@@ -0,0 +1,377 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// IOCapture.h
+
+#ifndef _IOCAPTURE_h
+#define _IOCAPTURE_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#pragma region Definitions
+
+/**
+ * @brief Compile the capture hooks, they cost a flag test while no capture runs.
+ */
+#define ENABLE_IO_CAPTURE
+
+/**
+ * @brief Replay is only useful next to the host simulation.
+ */
+#if defined(OPENMOBOT_SIM)
+#define ENABLE_IO_REPLAY
+#endif
+
+/**
+ * @brief Default record buffer size.
+ */
+#if defined(__AVR_ATmega328P__)
+#define IO_CAPTURE_BUFFER_SIZE 128
+#else
+#define IO_CAPTURE_BUFFER_SIZE 2048
+#endif
+
+/**
+ * @brief Time stamps resolution, 2^n us.
+ */
+#define IO_CAPTURE_TIME_SHIFT 4
+
+/**
+ * @brief Line sensor channels with delta coded values.
+ */
+#define IO_CAPTURE_LINE_CHANNELS 8
+
+/**
+ * @brief Longest captured command, longer ones are cut.
+ */
+#define IO_CAPTURE_COMMAND_SIZE 32
+
+/**
+ * @brief Stream format version.
+ */
+#define IO_CAPTURE_VERSION 1
+
+/**
+ * @brief Clock channels.
+ */
+#define IO_CLOCK_MILLIS 0
+#define IO_CLOCK_MICROS 1
+
+#ifdef ENABLE_IO_CAPTURE
+#define CAPTURE_LINE_SENSOR(index, value) IOCapture.lineSensor(index, value)
+#define CAPTURE_ENCODER(channel) IOCapture.encoder(channel)
+#define CAPTURE_SONAR(value) IOCapture.sonar(value)
+#define CAPTURE_MILLIS() IOCapture.clock(IO_CLOCK_MILLIS, millis())
+#define CAPTURE_MICROS() IOCapture.clock(IO_CLOCK_MICROS, micros())
+#define CAPTURE_INPUT(channel, value) IOCapture.input(channel, value)
+#define CAPTURE_COMMAND(data, size) IOCapture.command(data, size)
+#define CAPTURE_OUTPUT(left, right) IOCapture.output(left, right)
+#else
+#define CAPTURE_LINE_SENSOR(index, value) (value)
+#define CAPTURE_ENCODER(channel) (true)
+#define CAPTURE_SONAR(value) (value)
+#define CAPTURE_MILLIS() millis()
+#define CAPTURE_MICROS() micros()
+#define CAPTURE_INPUT(channel, value) (value)
+#define CAPTURE_COMMAND(data, size)
+#define CAPTURE_OUTPUT(left, right)
+#endif
+
+#pragma endregion
+
+#pragma region Enums
+
+/** @brief Capture mode. */
+enum IOCaptureMode : uint8_t
+{
+	IO_CAPTURE_OFF = 0U, ///< Hooks pass the live values.
+	IO_CAPTURE_RECORD,	 ///< Hooks log the live values.
+	IO_CAPTURE_REPLAY,	 ///< Hooks return the logged values.
+};
+
+/** @brief Event type, upper 3 bits of the event header, the lower 5 are the channel. */
+enum IOEventType : uint8_t
+{
+	IO_EVENT_MARK = 0U, ///< Channel 0 stream start, channel 1 lost events count.
+	IO_EVENT_LINE,		///< Line sensor callback value, delta coded per channel.
+	IO_EVENT_ENCODER,	///< Encoder edge, channel 0 left, 1 right.
+	IO_EVENT_SONAR,		///< Sonar result + 1, zero while busy.
+	IO_EVENT_CLOCK,		///< millis() or micros() read, delta coded per channel.
+	IO_EVENT_INPUT,		///< Sketch input.
+	IO_EVENT_COMMAND,	///< Received command, size and bytes.
+	IO_EVENT_OUTPUT,	///< Left and right PWM.
+};
+
+#pragma endregion
+
+/** @brief Timestamped capture of the robot inputs and motor outputs.
+ *
+ *  Every event is a header byte, the time since the previous event in
+ *  2^IO_CAPTURE_TIME_SHIFT us as varint and a varint payload. The record
+ *  goes to a ring buffer, drained to any Print from the loop. The replay
+ *  returns the logged inputs to the same hooks, delivers the encoder edges
+ *  and commands logged before each of them and compares the outputs.
+ */
+class IOCaptureClass
+{
+protected:
+#pragma region Variables
+
+	volatile IOCaptureMode m_mode = IO_CAPTURE_OFF;
+
+	/** @brief Record ring buffer. */
+	uint8_t *m_buffer = nullptr;
+	size_t m_size = 0;
+	volatile size_t m_head = 0;
+	volatile size_t m_tail = 0;
+
+	/** @brief Events lost to a full buffer, logged once there is room. */
+	uint32_t m_lost = 0;
+
+	/** @brief Events count. */
+	uint32_t m_events = 0;
+
+	/** @brief Time of the last event, aligned to the resolution. */
+	uint32_t m_lastTime = 0;
+
+	/** @brief Delta coding state. */
+	uint16_t m_lastLine[IO_CAPTURE_LINE_CHANNELS];
+	uint32_t m_lastClock[2];
+
+#if defined(ESP32)
+	portMUX_TYPE m_mux = portMUX_INITIALIZER_UNLOCKED;
+#endif
+
+#ifdef ENABLE_IO_REPLAY
+	const uint8_t *m_replay = nullptr;
+	size_t m_replaySize = 0;
+	size_t m_replayPos = 0;
+	uint32_t m_replayTime = 0;
+	bool m_delivering = false;
+	bool m_diverged = false;
+	bool m_lossy = false;
+	uint32_t m_matches = 0;
+	uint32_t m_mismatches = 0;
+	void (*m_cbEncoder)(uint8_t channel) = nullptr;
+	void (*m_cbCommand)(const uint8_t *data, uint8_t size) = nullptr;
+#endif
+
+#pragma endregion
+
+#pragma region Methods
+
+	void clearCoding();
+	bool append(uint8_t header, const uint32_t *payload, uint8_t count, const uint8_t *data, uint8_t size);
+
+#ifdef ENABLE_IO_REPLAY
+	bool readVarint(uint32_t *value);
+	bool readEvent(uint8_t *header, uint32_t *payload, const uint8_t **data, uint8_t *size);
+	bool nextEvent(uint8_t header, uint32_t *payload, uint8_t count);
+	void deliver();
+#endif
+
+	uint16_t lineSensorSlow(uint8_t index, uint16_t value);
+	bool encoderSlow(uint8_t channel);
+	long sonarSlow(long value);
+	uint32_t clockSlow(uint8_t channel, uint32_t value);
+	int32_t inputSlow(uint8_t channel, int32_t value);
+	void commandSlow(const uint8_t *data, uint8_t size);
+	void outputSlow(int16_t left, int16_t right);
+
+#pragma endregion
+
+public:
+#pragma region Methods
+
+	/** @brief Start recording.
+	 *  @param size size_t, Ring buffer size.
+	 *  @return bool, False when the buffer can not be allocated.
+	 */
+	bool beginRecord(size_t size = IO_CAPTURE_BUFFER_SIZE);
+
+	/** @brief Stop recording or replaying, the hooks pass the live values.
+	 *  @return Void.
+	 */
+	void end();
+
+	/** @brief Move the recorded bytes to an output.
+	 *  @param out Print&, Output.
+	 *  @param maxBytes size_t, Most bytes to write in this call.
+	 *  @return size_t, Written bytes count.
+	 */
+	size_t drain(Print &out, size_t maxBytes = (size_t)-1);
+
+	/** @brief Get capture mode.
+	 *  @return IOCaptureMode, Mode.
+	 */
+	IOCaptureMode getMode();
+
+	/** @brief Get logged or replayed events count.
+	 *  @return uint32_t, Count.
+	 */
+	uint32_t getEvents();
+
+	/** @brief Get events lost to a full buffer.
+	 *  @return uint32_t, Count.
+	 */
+	uint32_t getLost();
+
+#ifdef ENABLE_IO_REPLAY
+	/** @brief Start replaying a capture.
+	 *  @param data const uint8_t*, Capture, kept by the caller.
+	 *  @param size size_t, Capture size.
+	 *  @return bool, False when it is not a capture.
+	 */
+	bool beginReplay(const uint8_t *data, size_t size);
+
+	/** @brief Set the callback that delivers the replayed encoder edges.
+	 *  @param callback void (*)(uint8_t), Callback, gets the channel.
+	 *  @return Void.
+	 */
+	void setCbEncoder(void (*callback)(uint8_t channel));
+
+	/** @brief Set the callback that delivers the replayed commands.
+	 *  @param callback void (*)(const uint8_t*, uint8_t), Callback.
+	 *  @return Void.
+	 */
+	void setCbCommand(void (*callback)(const uint8_t *data, uint8_t size));
+
+	/** @brief Replay reached the capture end.
+	 *  @return bool, True when done.
+	 */
+	bool isReplayDone();
+
+	/** @brief The code asked for another event than the capture holds.
+	 *  @return bool, True after the first difference, the hooks pass the live values from there.
+	 */
+	bool isDiverged();
+
+	/** @brief The capture lost events when recorded.
+	 *  @return bool, True when lossy.
+	 */
+	bool isLossy();
+
+	/** @brief Get outputs equal to the capture.
+	 *  @return uint32_t, Count.
+	 */
+	uint32_t getMatches();
+
+	/** @brief Get outputs different from the capture.
+	 *  @return uint32_t, Count.
+	 */
+	uint32_t getMismatches();
+
+	/** @brief Get the capture time of the last replayed event.
+	 *  @return uint32_t, Time in us.
+	 */
+	uint32_t getReplayTime();
+#endif
+
+	/** @brief Line sensor callback value hook.
+	 *  @param index uint8_t, Sensor index.
+	 *  @param value uint16_t, Live value.
+	 *  @return uint16_t, Value to use.
+	 */
+	inline uint16_t lineSensor(uint8_t index, uint16_t value)
+	{
+		return m_mode == IO_CAPTURE_OFF ? value : lineSensorSlow(index, value);
+	}
+
+	/** @brief Encoder edge hook, called from the ISR.
+	 *  @param channel uint8_t, 0 left, 1 right.
+	 *  @return bool, True when the edge counts.
+	 */
+	inline bool encoder(uint8_t channel)
+	{
+		return m_mode == IO_CAPTURE_OFF ? true : encoderSlow(channel);
+	}
+
+	/** @brief Sonar result hook.
+	 *  @param value long, Echo time in us, -1 while busy.
+	 *  @return long, Value to use.
+	 */
+	inline long sonar(long value)
+	{
+		return m_mode == IO_CAPTURE_OFF ? value : sonarSlow(value);
+	}
+
+	/** @brief Clock read hook.
+	 *  @param channel uint8_t, IO_CLOCK_MILLIS or IO_CLOCK_MICROS.
+	 *  @param value uint32_t, Live time.
+	 *  @return uint32_t, Time to use.
+	 */
+	inline uint32_t clock(uint8_t channel, uint32_t value)
+	{
+		return m_mode == IO_CAPTURE_OFF ? value : clockSlow(channel, value);
+	}
+
+	/** @brief Sketch input hook.
+	 *  @param channel uint8_t, Sketch defined channel 0 to 31.
+	 *  @param value int32_t, Live value.
+	 *  @return int32_t, Value to use.
+	 */
+	inline int32_t input(uint8_t channel, int32_t value)
+	{
+		return m_mode == IO_CAPTURE_OFF ? value : inputSlow(channel, value);
+	}
+
+	/** @brief Received command hook.
+	 *  @param data const uint8_t*, Command bytes.
+	 *  @param size uint8_t, Command size.
+	 *  @return Void.
+	 */
+	inline void command(const uint8_t *data, uint8_t size)
+	{
+		if (m_mode != IO_CAPTURE_OFF)
+		{
+			commandSlow(data, size);
+		}
+	}
+
+	/** @brief Motor output hook.
+	 *  @param left int16_t, Left PWM.
+	 *  @param right int16_t, Right PWM.
+	 *  @return Void.
+	 */
+	inline void output(int16_t left, int16_t right)
+	{
+		if (m_mode != IO_CAPTURE_OFF)
+		{
+			outputSlow(left, right);
+		}
+	}
+
+#pragma endregion
+};
+
+/** @brief I/O capture instance. */
+extern IOCaptureClass IOCapture;
+
+#endif
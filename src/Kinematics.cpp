@@ -0,0 +1,96 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "Kinematics.h"
+
+/** @brief Precompute the geometry constants.
+ *  @param model MotorModel_t*, Wheel diameter and distance between wheels in mm.
+ *  @param maxRPM int32_t, Wheel speed limit.
+ *  @return Void.
+ */
+void Kinematics::init(MotorModel_t *model, int32_t maxRPM)
+{
+	double CircumferenceL = model->WheelDiameter * PI;
+
+	m_kRPM = (int32_t)(60.0 / CircumferenceL * (1L << KINEMATICS_Q) + 0.5);
+	m_kMMS = (int32_t)(CircumferenceL / 60.0 * (1L << KINEMATICS_Q) + 0.5);
+	m_kHalfTrack = (int32_t)(model->DistanceBetweenWheels / 2000.0 * (1L << KINEMATICS_Q) + 0.5);
+	m_kOmega = (int32_t)(1000.0 / model->DistanceBetweenWheels * (1L << KINEMATICS_Q_OMEGA) + 0.5);
+	m_maxRPM = maxRPM;
+}
+
+/** @brief Convert body velocity to wheel speeds.
+ *  @param vw VWData_t, Linear and angular velocity.
+ *  @return LRData_t Left and Right wheel RPM.
+ */
+LRData_t Kinematics::toWheels(VWData_t vw)
+{
+	LRData_t LRDataL;
+
+	// Common and differential wheel speeds in RPM.
+	int32_t CommonL = (vw.V * m_kRPM) >> KINEMATICS_Q;
+	int32_t TurnL = (((vw.W * m_kHalfTrack) >> KINEMATICS_Q) * m_kRPM) >> KINEMATICS_Q;
+
+	if (abs(TurnL) <= m_maxRPM)
+	{
+		// Give up linear velocity to keep the turn rate.
+		int32_t RoomL = m_maxRPM - abs(TurnL);
+		CommonL = constrain(CommonL, -RoomL, RoomL);
+	}
+
+	int32_t LeftL = CommonL - TurnL;
+	int32_t RightL = CommonL + TurnL;
+
+	// Turn alone saturates, scale both wheels proportionally.
+	int32_t MaxL = max(abs(LeftL), abs(RightL));
+	if (MaxL > m_maxRPM)
+	{
+		LeftL = LeftL * m_maxRPM / MaxL;
+		RightL = RightL * m_maxRPM / MaxL;
+	}
+
+	LRDataL.L = LeftL;
+	LRDataL.R = RightL;
+
+	return LRDataL;
+}
+
+/** @brief Convert wheel speeds to body velocity.
+ *  @param rpm LRData_t, Left and Right wheel RPM.
+ *  @return VWData_t Linear and angular velocity.
+ */
+VWData_t Kinematics::toBody(LRData_t rpm)
+{
+	VWData_t VWDataL;
+
+	int32_t LeftL = ((int32_t)rpm.L * m_kMMS) >> KINEMATICS_Q;
+	int32_t RightL = ((int32_t)rpm.R * m_kMMS) >> KINEMATICS_Q;
+
+	VWDataL.V = (LeftL + RightL) / 2;
+	VWDataL.W = ((RightL - LeftL) * m_kOmega) >> KINEMATICS_Q_OMEGA;
+
+	return VWDataL;
+}
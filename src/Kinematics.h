@@ -0,0 +1,105 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// Kinematics.h
+
+#ifndef _KINEMATICS_h
+#define _KINEMATICS_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include "MotorController.h"
+#include "LRData.h"
+#include "VWData.h"
+
+/**
+ * @brief Fraction bits of the geometry constants.
+ */
+#define KINEMATICS_Q 16
+
+/**
+ * @brief Fraction bits of the wheel speeds to angular velocity constant.
+ */
+#define KINEMATICS_Q_OMEGA 10
+
+/** @brief Unicycle model of the differential drive in fixed point. */
+class Kinematics
+{
+protected:
+#pragma region Variables
+
+	/** @brief Wheel RPM per mm/s. */
+	int32_t m_kRPM;
+
+	/** @brief Wheel mm/s per RPM. */
+	int32_t m_kMMS;
+
+	/** @brief Half track in mm per mrad/s. */
+	int32_t m_kHalfTrack;
+
+	/** @brief mrad/s per mm/s of wheel speed difference. */
+	int32_t m_kOmega;
+
+	/** @brief Wheel speed limit in RPM. */
+	int32_t m_maxRPM;
+
+#pragma endregion
+
+public:
+#pragma region Methods
+
+	/** @brief Precompute the geometry constants.
+	 *  @param model MotorModel_t*, Wheel diameter and distance between wheels in mm.
+	 *  @param maxRPM int32_t, Wheel speed limit.
+	 *  @return Void.
+	 */
+	void init(MotorModel_t *model, int32_t maxRPM);
+
+	/** @brief Convert body velocity to wheel speeds.
+	 *
+	 *  When a wheel exceeds the limit the linear velocity is reduced first,
+	 *  so the turn rate is kept. Only when the turn alone exceeds the limit
+	 *  both wheels are scaled down proportionally.
+	 *
+	 *  @param vw VWData_t, Linear and angular velocity.
+	 *  @return LRData_t Left and Right wheel RPM.
+	 */
+	LRData_t toWheels(VWData_t vw);
+
+	/** @brief Convert wheel speeds to body velocity.
+	 *  @param rpm LRData_t, Left and Right wheel RPM.
+	 *  @return VWData_t Linear and angular velocity.
+	 */
+	VWData_t toBody(LRData_t rpm);
+
+#pragma endregion
+};
+
+#endif
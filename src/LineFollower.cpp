@@ -0,0 +1,245 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// LineFollower.cpp
+
+#include "LineFollower.h"
+
+#include "IOCapture.h"
+
+#pragma region Private Methods
+
+/** @brief Least squares slope of y against x.
+ *  @param x const float*, Abscissas.
+ *  @param y const float*, Ordinates.
+ *  @param count uint8_t, Points count.
+ *  @return float, Slope, zero when x does not spread.
+ */
+static float least_squares_slope(const float *x, const float *y, uint8_t count)
+{
+	float MeanXL = 0;
+	float MeanYL = 0;
+	for (uint8_t index = 0; index < count; index++)
+	{
+		MeanXL += x[index];
+		MeanYL += y[index];
+	}
+	MeanXL /= count;
+	MeanYL /= count;
+
+	float CovarianceL = 0;
+	float VarianceL = 0;
+	for (uint8_t index = 0; index < count; index++)
+	{
+		float DxL = x[index] - MeanXL;
+		CovarianceL += DxL * (y[index] - MeanYL);
+		VarianceL += DxL * DxL;
+	}
+
+	if (VarianceL <= 0)
+	{
+		return 0;
+	}
+
+	return CovarianceL / VarianceL;
+}
+
+void LineFollower::updateRate(float error, uint32_t now)
+{
+	m_errors[m_index] = error;
+	m_times[m_index] = now;
+	m_index = (m_index + 1) % LINE_FOLLOWER_HISTORY;
+	if (m_count < LINE_FOLLOWER_HISTORY)
+	{
+		m_count++;
+	}
+
+	if (m_count < 2)
+	{
+		m_rate = 0;
+		return;
+	}
+
+	// Times relative to the newest frame, the wrap of micros() cancels out.
+	float TimesL[LINE_FOLLOWER_HISTORY];
+	float ErrorsL[LINE_FOLLOWER_HISTORY];
+	for (uint8_t index = 0; index < m_count; index++)
+	{
+		uint8_t SlotL = (m_index + LINE_FOLLOWER_HISTORY - 1 - index) % LINE_FOLLOWER_HISTORY;
+		TimesL[index] = -(float)(now - m_times[SlotL]) * 1e-6f;
+		ErrorsL[index] = m_errors[SlotL];
+	}
+
+	m_rate = least_squares_slope(TimesL, ErrorsL, m_count);
+}
+
+void LineFollower::updateSlope(float offset, float distance)
+{
+	uint8_t LastL = (m_angleIndex + LINE_FOLLOWER_ANGLE_SAMPLES - 1) % LINE_FOLLOWER_ANGLE_SAMPLES;
+
+	// A reset odometer starts over.
+	if (m_angleCount > 0 && distance < m_distances[LastL])
+	{
+		m_angleCount = 0;
+	}
+
+	// Sample by distance, the encoder steps are coarse and a stop holds the angle.
+	if (m_angleCount > 0 && distance - m_distances[LastL] < LINE_FOLLOWER_ANGLE_STEP_MM)
+	{
+		return;
+	}
+
+	m_offsets[m_angleIndex] = offset;
+	m_distances[m_angleIndex] = distance;
+	m_angleIndex = (m_angleIndex + 1) % LINE_FOLLOWER_ANGLE_SAMPLES;
+	if (m_angleCount < LINE_FOLLOWER_ANGLE_SAMPLES)
+	{
+		m_angleCount++;
+	}
+
+	if (m_angleCount < 2)
+	{
+		return;
+	}
+
+	m_slope = least_squares_slope(m_distances, m_offsets, m_angleCount);
+	m_slope = constrain(m_slope, -LINE_FOLLOWER_MAX_SLOPE, LINE_FOLLOWER_MAX_SLOPE);
+}
+
+#pragma endregion
+
+#pragma region Methods
+
+void LineFollower::init(uint8_t sensorsCount, int resolution, float sensorsPitch)
+{
+	m_center = (sensorsCount - 1) * resolution / 2.0;
+	m_halfWidth = (sensorsCount - 1) * sensorsPitch / 2.0;
+
+	reset();
+}
+
+void LineFollower::setGains(const LineFollowerGains_t &slow, const LineFollowerGains_t &fast)
+{
+	m_slow = slow;
+	m_fast = fast;
+}
+
+void LineFollower::setMaxSpeed(float maxSpeed)
+{
+	m_maxSpeed = maxSpeed;
+}
+
+void LineFollower::setLookahead(float lookahead)
+{
+	m_lookahead = lookahead;
+}
+
+void LineFollower::reset()
+{
+	m_index = 0;
+	m_count = 0;
+	m_angleIndex = 0;
+	m_angleCount = 0;
+
+	m_error = 0;
+	m_rate = 0;
+	m_slope = 0;
+	m_integral = 0;
+	m_steering = 0;
+}
+
+LRData_t LineFollower::update(float position, float speed, float distance)
+{
+	LRData_t LRDataL;
+
+	uint32_t NowL = CAPTURE_MICROS();
+	uint8_t PreviousL = (m_index + LINE_FOLLOWER_HISTORY - 1) % LINE_FOLLOWER_HISTORY;
+	float DtL = m_count > 0 ? (float)(NowL - m_times[PreviousL]) * 1e-6f : 0;
+
+	m_error = m_center > 0 ? (position - m_center) / m_center : 0;
+	updateRate(m_error, NowL);
+	updateSlope(getOffset(), distance);
+
+	// Steer on the offset where the sensors will be.
+	float AheadL = (getOffset() + m_lookahead * m_slope) / m_halfWidth;
+
+	// Schedule the gains on the speed.
+	float RatioL = m_maxSpeed > 0 ? constrain(fabs(speed) / m_maxSpeed, 0.0f, 1.0f) : 0;
+	float KpL = m_slow.Kp + (m_fast.Kp - m_slow.Kp) * RatioL;
+	float KiL = m_slow.Ki + (m_fast.Ki - m_slow.Ki) * RatioL;
+	float KdL = m_slow.Kd + (m_fast.Kd - m_slow.Kd) * RatioL;
+
+	// The integral can not hold more than the whole output alone.
+	if (KiL > 0)
+	{
+		float LimitL = m_maxSpeed / KiL;
+		m_integral = constrain(m_integral + m_error * DtL, -LimitL, LimitL);
+	}
+	else
+	{
+		m_integral = 0;
+	}
+
+	m_steering = KpL * AheadL + KiL * m_integral + KdL * m_rate;
+	m_steering = constrain(m_steering, -m_maxSpeed, m_maxSpeed);
+
+	// Keep the steering, give up the common speed.
+	float RoomL = m_maxSpeed - fabs(m_steering);
+	float CommonL = constrain(speed, -RoomL, RoomL);
+
+	// The last sensor is on the left, a positive error turns left.
+	LRDataL.L = (int)(CommonL - m_steering);
+	LRDataL.R = (int)(CommonL + m_steering);
+
+	return LRDataL;
+}
+
+float LineFollower::getError()
+{
+	return m_error;
+}
+
+float LineFollower::getErrorRate()
+{
+	return m_rate;
+}
+
+float LineFollower::getOffset()
+{
+	return m_error * m_halfWidth;
+}
+
+float LineFollower::getAngle()
+{
+	return atan(m_slope);
+}
+
+float LineFollower::getSteering()
+{
+	return m_steering;
+}
+
+#pragma endregion
@@ -0,0 +1,197 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// LineFollower.h
+
+#ifndef _LINEFOLLOWER_h
+#define _LINEFOLLOWER_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include "LRData.h"
+
+#pragma region Definitions
+
+/**
+ * @brief Frames kept for the error derivative.
+ */
+#define LINE_FOLLOWER_HISTORY 8
+
+/**
+ * @brief Samples kept for the line angle.
+ */
+#define LINE_FOLLOWER_ANGLE_SAMPLES 4
+
+/**
+ * @brief Travelled distance between two line angle samples, mm.
+ */
+#define LINE_FOLLOWER_ANGLE_STEP_MM 10.0
+
+/**
+ * @brief Largest line angle tangent, about 63 degrees.
+ */
+#define LINE_FOLLOWER_MAX_SLOPE 2.0
+
+#pragma endregion
+
+/** @brief Steering gains on the normalized line error, in output units. */
+typedef struct
+{
+	float Kp; ///< Per unit of error.
+	float Ki; ///< Per unit of error and second.
+	float Kd; ///< Per unit of error per second.
+} LineFollowerGains_t;
+
+/** @brief Line following controller.
+ *
+ *  The line position of LineSensor is normalized to an error of -1 on the
+ *  first sensor to +1 on the last one. The derivative is the least squares
+ *  slope over the last LINE_FOLLOWER_HISTORY frames, it does not amplify
+ *  the position quantization the way a two frame difference does.
+ *
+ *  The line angle is the slope of the line offset against the travelled
+ *  distance. The steering acts on the offset projected this far ahead, so
+ *  the robot turns in before the curve reaches the sensors.
+ *
+ *  The gains move from the slow set at standstill to the fast set at the
+ *  speed limit. The output is the wheel setpoints, in the units of the
+ *  speed: PWM for an open loop, RPM for a speed loop. A saturated wheel
+ *  gives up common speed first, the steering is kept.
+ */
+class LineFollower
+{
+protected:
+#pragma region Variables
+
+	float m_center = 0;
+	float m_halfWidth = 1;
+
+	LineFollowerGains_t m_slow = {0, 0, 0};
+	LineFollowerGains_t m_fast = {0, 0, 0};
+	float m_maxSpeed = 255;
+	float m_lookahead = 0;
+
+	float m_errors[LINE_FOLLOWER_HISTORY];
+	uint32_t m_times[LINE_FOLLOWER_HISTORY];
+	uint8_t m_index = 0;
+	uint8_t m_count = 0;
+
+	float m_offsets[LINE_FOLLOWER_ANGLE_SAMPLES];
+	float m_distances[LINE_FOLLOWER_ANGLE_SAMPLES];
+	uint8_t m_angleIndex = 0;
+	uint8_t m_angleCount = 0;
+
+	float m_error = 0;
+	float m_rate = 0;
+	float m_slope = 0;
+	float m_integral = 0;
+	float m_steering = 0;
+
+#pragma endregion
+
+#pragma region Methods
+
+	void updateRate(float error, uint32_t now);
+	void updateSlope(float offset, float distance);
+
+#pragma endregion
+
+public:
+#pragma region Methods
+
+	/** @brief Set the sensor geometry.
+	 *  @param sensorsCount uint8_t, Line sensors count.
+	 *  @param resolution int, LineSensor resolution.
+	 *  @param sensorsPitch float, Distance between two sensors, mm.
+	 *  @return Void.
+	 */
+	void init(uint8_t sensorsCount, int resolution, float sensorsPitch);
+
+	/** @brief Set the scheduled gains.
+	 *  @param slow const LineFollowerGains_t&, Gains at standstill.
+	 *  @param fast const LineFollowerGains_t&, Gains at the speed limit.
+	 *  @return Void.
+	 */
+	void setGains(const LineFollowerGains_t &slow, const LineFollowerGains_t &fast);
+
+	/** @brief Set the wheel setpoint limit.
+	 *  @param maxSpeed float, Limit, output units.
+	 *  @return Void.
+	 */
+	void setMaxSpeed(float maxSpeed);
+
+	/** @brief Set the lookahead.
+	 *  @param lookahead float, Projection ahead of the sensors, mm, zero to disable.
+	 *  @return Void.
+	 */
+	void setLookahead(float lookahead);
+
+	/** @brief Forget the history, call it before a run.
+	 *  @return Void.
+	 */
+	void reset();
+
+	/** @brief Compute the wheel setpoints of one frame.
+	 *  @param position float, LineSensor line position.
+	 *  @param speed float, Forward speed, output units.
+	 *  @param distance float, Travelled distance, mm.
+	 *  @return LRData_t, Left and Right wheel setpoints.
+	 */
+	LRData_t update(float position, float speed, float distance);
+
+	/** @brief Get the normalized line error.
+	 *  @return float, -1 at the first sensor to +1 at the last one.
+	 */
+	float getError();
+
+	/** @brief Get the line error rate.
+	 *  @return float, Error per second.
+	 */
+	float getErrorRate();
+
+	/** @brief Get the line offset.
+	 *  @return float, Offset from the array center, mm.
+	 */
+	float getOffset();
+
+	/** @brief Get the line angle to the robot heading.
+	 *  @return float, Angle, rad.
+	 */
+	float getAngle();
+
+	/** @brief Get the steering term.
+	 *  @return float, Half the wheel setpoints difference, output units.
+	 */
+	float getSteering();
+
+#pragma endregion
+};
+
+#endif
@@ -25,6 +25,8 @@ SOFTWARE.
 */
 
 #include "LineSensor.h"
+#include "Profiler.h"
+#include "IOCapture.h"
 
 /** @brief Configure the sensor.
  *  @param sensorCount int, Sensor count.
@@ -63,6 +65,8 @@ void LineSensorClass::init(int sensorCount)
  */
 void LineSensorClass::update()
 {
+	PROFILE_ZONE("LineSensor.update");
+
 	static uint16_t MaxValueL;
 	static uint16_t MinValueL;
 
@@ -71,6 +75,11 @@ void LineSensorClass::update()
 		m_curSensorsValues[index] = readFilteredSensor(index);
 	}
 
+	if (m_tracking)
+	{
+		track();
+	}
+
 	// Clamp and scale to resolution.
 	for (uint8_t index = 0; index < m_sensorsCount; index++)
 	{
@@ -103,11 +112,181 @@ void LineSensorClass::update()
 	}
 }
 
+/** @brief Get the line level of a sensor within its envelope.
+ *  @param index uint8_t, Sensor index.
+ *  @return int32_t, Percent, 0 on the background and 100 on the line, it runs past both.
+ */
+int32_t LineSensorClass::trackLevel(uint8_t index)
+{
+	int32_t SpanL = (int32_t)m_maxSensorsValues[index] - m_minSensorsValues[index];
+	int32_t LevelL = ((int32_t)m_curSensorsValues[index] - m_minSensorsValues[index]) * 100 / SpanL;
+
+	return m_invertedReadings ? 100 - LevelL : LevelL;
+}
+
+/** @brief Move the envelopes toward the current frame, when it is confident.
+ *  @return Void.
+ */
+void LineSensorClass::track()
+{
+	PROFILE_ZONE("LineSensor.track");
+
+	uint8_t PeakL = 0;
+	int32_t PeakLevelL = 0;
+	int32_t FloorLevelL = 0;
+
+	for (uint8_t index = 0; index < m_sensorsCount; index++)
+	{
+		// Not calibrated yet.
+		if (m_maxSensorsValues[index] <= m_minSensorsValues[index])
+		{
+			return;
+		}
+
+		// The line is under the sensor reading highest in its own envelope.
+		int32_t LevelL = trackLevel(index);
+		if (index == 0 || LevelL > PeakLevelL)
+		{
+			PeakL = index;
+			PeakLevelL = LevelL;
+		}
+		if (index == 0 || LevelL < FloorLevelL)
+		{
+			FloorLevelL = LevelL;
+		}
+	}
+
+	// A frame is confident when it shows both the line and the background,
+	// a lifted robot or a light flash shows no such contrast.
+	if (PeakLevelL < 100 - LINE_SENSOR_TRACK_MARGIN || FloorLevelL > LINE_SENSOR_TRACK_MARGIN)
+	{
+		return;
+	}
+
+	// Bounded rate, one count per period.
+	if (++m_trackFrames < LINE_SENSOR_TRACK_PERIOD)
+	{
+		return;
+	}
+	m_trackFrames = 0;
+
+	// Line center between the peak and its neighbours.
+	int32_t LeftL = PeakL + 1 < m_sensorsCount ? max(trackLevel(PeakL + 1), (int32_t)0) : 0;
+	int32_t RightL = PeakL > 0 ? max(trackLevel(PeakL - 1), (int32_t)0) : 0;
+	float CenterL = PeakL + (float)(LeftL - RightL) / (LeftL + PeakLevelL + RightL);
+
+	int16_t SumL = 0;
+	uint8_t CountL = 0;
+
+	for (uint8_t index = 0; index < m_sensorsCount; index++)
+	{
+		bool LineL = index == PeakL;
+		bool BackgroundL = !LineL && trackBackground(index, CenterL);
+		if (!LineL && !BackgroundL)
+		{
+			continue;
+		}
+
+		// The line end of the envelope, the other one is the background.
+		bool UpperL = LineL != m_invertedReadings;
+		int32_t DeltaL = (int32_t)m_curSensorsValues[index] - (UpperL ? m_maxSensorsValues[index] : m_minSensorsValues[index]);
+		int8_t StepL = 0;
+		if (DeltaL > LINE_SENSOR_TRACK_DEADBAND)
+		{
+			StepL = 1;
+		}
+		else if (DeltaL < -LINE_SENSOR_TRACK_DEADBAND)
+		{
+			StepL = -1;
+		}
+
+		trackStep(index, UpperL, StepL);
+
+		if (BackgroundL)
+		{
+			SumL += StepL;
+			CountL++;
+		}
+	}
+
+	if (CountL == 0)
+	{
+		return;
+	}
+
+	// The ambient light moves the whole bar, the sensors that did not see
+	// the background take the common step, a stale one would read a line.
+	int8_t CommonL = 0;
+	if (2 * SumL >= CountL)
+	{
+		CommonL = 1;
+	}
+	else if (2 * SumL <= -CountL)
+	{
+		CommonL = -1;
+	}
+
+	for (uint8_t index = 0; index < m_sensorsCount; index++)
+	{
+		if (index == PeakL || !trackBackground(index, CenterL))
+		{
+			trackStep(index, m_invertedReadings, CommonL);
+		}
+	}
+}
+
+/** @brief Tell a sensor reads the background.
+ *  @param index uint8_t, Sensor index.
+ *  @param center float, Line center, sensor index.
+ *  @return bool, True when away from the line and near the background end.
+ */
+bool LineSensorClass::trackBackground(uint8_t index, float center)
+{
+	// The sensors near the line see its edge and read in between.
+	if (fabs(index - center) < LINE_SENSOR_TRACK_GUARD)
+	{
+		return false;
+	}
+
+	// Off the line but not on the background, a stain or a crossing.
+	return trackLevel(index) <= LINE_SENSOR_TRACK_MARGIN;
+}
+
+/** @brief Move one envelope end by a step.
+ *  @param index uint8_t, Sensor index.
+ *  @param upper bool, True for the maximum, false for the minimum.
+ *  @param step int8_t, ADC counts, the envelope keeps the minimum span when narrowing.
+ *  @return Void.
+ */
+void LineSensorClass::trackStep(uint8_t index, bool upper, int8_t step)
+{
+	uint16_t &MinL = m_minSensorsValues[index];
+	uint16_t &MaxL = m_maxSensorsValues[index];
+
+	uint16_t &EndL = upper ? MaxL : MinL;
+
+	bool NarrowL = upper ? step < 0 : step > 0;
+	if (step == 0 || (NarrowL && MaxL - MinL <= LINE_SENSOR_TRACK_MIN_SPAN))
+	{
+		return;
+	}
+
+	// Any ADC width, only the zero end can wrap.
+	if (step < 0 && EndL == 0)
+	{
+		return;
+	}
+
+	EndL += step;
+}
+
 /** @brief Calibrate sensor array.
  *  @return bool, True when calibrated.
  */
 void LineSensorClass::calibrate()
 {
+	PROFILE_ZONE("LineSensor.calibrate");
+
 	static uint16_t MaxValueL;
 	static uint16_t MinValueL;
 
@@ -158,39 +337,10 @@ void LineSensorClass::calibrate()
 		m_actSensorsValues[index] = map(m_actSensorsValues[index], MinValueL, MaxValueL, 0, m_resolution);
 	}
 
-	DEBUGLOG("\r\n");
-	DEBUGLOG("Actual: ");
-	for (uint8_t index = 0; index < m_sensorsCount; index++)
-	{
-		DEBUGLOG(m_actSensorsValues[index]);
-		DEBUGLOG(", ");
-	}
-	DEBUGLOG("\r\n");
-
-	DEBUGLOG("\r\n");
-	DEBUGLOG("Current: ");
-	for (uint8_t index = 0; index < m_sensorsCount; index++)
-	{
-		DEBUGLOG(m_curSensorsValues[index]);
-		DEBUGLOG(", ");
-	}
-	DEBUGLOG("\r\n");
-
-	DEBUGLOG("Minimum: ");
-	for (uint8_t index = 0; index < m_sensorsCount; index++)
-	{
-		DEBUGLOG(m_minSensorsValues[index]);
-		DEBUGLOG(", ");
-	}
-	DEBUGLOG("\r\n");
-
-	DEBUGLOG("Maximum: ");
-	for (uint8_t index = 0; index < m_sensorsCount; index++)
-	{
-		DEBUGLOG(m_maxSensorsValues[index]);
-		DEBUGLOG(", ");
-	}
-	DEBUGLOG("\r\n");
+	LOG_DEBUG("Actual: %v", LogValues(m_actSensorsValues, m_sensorsCount));
+	LOG_DEBUG("Current: %v", LogValues(m_curSensorsValues, m_sensorsCount));
+	LOG_DEBUG("Minimum: %v", LogValues(m_minSensorsValues, m_sensorsCount));
+	LOG_DEBUG("Maximum: %v", LogValues(m_maxSensorsValues, m_sensorsCount));
 }
 
 /** @brief Set the read callback.
@@ -211,6 +361,24 @@ void LineSensorClass::setInvertedReadings(bool value)
 	m_invertedReadings = value;
 }
 
+/** @brief Set the background calibration.
+ *  @param value bool, Tracking flag.
+ *  @return Void.
+ */
+void LineSensorClass::setTracking(bool value)
+{
+	m_tracking = value;
+	m_trackFrames = 0;
+}
+
+/** @brief Get the background calibration flag.
+ *  @return bool, Tracking flag.
+ */
+bool LineSensorClass::getTracking()
+{
+	return m_tracking;
+}
+
 /** @brief Get inverted readings flag.
  *  @return bool, Inverted flag value.
  */
@@ -244,7 +412,7 @@ uint16_t LineSensorClass::readSensor(int sensorIndex)
 {
 	if (callbackGetSensorValue != nullptr)
 	{
-		return callbackGetSensorValue(sensorIndex);
+		return CAPTURE_LINE_SENSOR(sensorIndex, callbackGetSensorValue(sensorIndex));
 	}
 
 	return 0;
@@ -301,7 +469,6 @@ float LineSensorClass::getLinePosition()
 {
 	m_weightedTotal = 0;
 	m_denominator = 0;
-	m_linePosition = 0;
 	m_onTheLineFlag = false;
 
 	// Determine line position.
@@ -342,19 +509,20 @@ float LineSensorClass::getLinePosition()
 		}
 	}
 
-	DEBUGLOG("\r\n");
-	DEBUGLOG("Actual: ");
-	for (uint8_t index = 0; index < m_sensorsCount; index++)
-	{
-		DEBUGLOG(m_actSensorsValues[index]);
-		DEBUGLOG(", ");
-	}
-	DEBUGLOG("\r\n");
+	LOG_DEBUG("Actual: %v", LogValues(m_actSensorsValues, m_sensorsCount));
 
 	m_linePosition = m_weightedTotal / m_denominator;
 	return m_linePosition;
 }
 
+/** @brief The last getLinePosition() saw the line.
+ *  @return bool, True when on the line.
+ */
+bool LineSensorClass::getOnTheLine()
+{
+	return m_onTheLineFlag;
+}
+
 /**
  * @brief Get the specified sensor value.
  *
@@ -35,16 +35,28 @@ SOFTWARE.
 #include "WProgram.h"
 #endif
 
-// #include "DebugPort.h"
-#ifndef DEBUGLOG
-#define DEBUGLOG(...)
-#endif
+#include "Log.h"
 
 #define UPPER_HIGH 100
 #define UPPER_LOW 80
 #define LOWER_HIGH 20
 #define LOWER_LOW 0
 
+/** @brief Tracking, a reading within this percent of the span from an envelope end is confident. */
+#define LINE_SENSOR_TRACK_MARGIN 25
+
+/** @brief Tracking, confident frames per one ADC count envelope step. */
+#define LINE_SENSOR_TRACK_PERIOD 8
+
+/** @brief Tracking, sensors closer to the line center may see its edge, in sensor pitches. */
+#define LINE_SENSOR_TRACK_GUARD 1.75
+
+/** @brief Tracking, readings this close to an envelope end are noise and leave it, ADC counts. */
+#define LINE_SENSOR_TRACK_DEADBAND 10
+
+/** @brief Tracking, the envelope never narrows under this span, ADC counts. */
+#define LINE_SENSOR_TRACK_MIN_SPAN 100
+
 /** @brief Logic state description enum. */
 enum SensorState : uint8_t
 {
@@ -85,6 +97,12 @@ private:
 	/* @brief Inverted readings flag. */
 	bool m_invertedReadings = false;
 
+	/* @brief Background calibration flag. */
+	bool m_tracking = false;
+
+	/* @brief Confident frames since the last envelope step. */
+	uint8_t m_trackFrames = 0;
+
 	/* @brief Average sensors values. */
 	uint16_t *m_curSensorsValues;
 
@@ -114,6 +132,32 @@ protected:
 	 */
 	uint16_t readFilteredSensor(int sensorIndex);
 
+	/** @brief Get the line level of a sensor within its envelope.
+	 *  @param index uint8_t, Sensor index.
+	 *  @return int32_t, Percent, 0 on the background and 100 on the line, it runs past both.
+	 */
+	int32_t trackLevel(uint8_t index);
+
+	/** @brief Tell a sensor reads the background.
+	 *  @param index uint8_t, Sensor index.
+	 *  @param center float, Line center, sensor index.
+	 *  @return bool, True when away from the line and near the background end.
+	 */
+	bool trackBackground(uint8_t index, float center);
+
+	/** @brief Move one envelope end by a step.
+	 *  @param index uint8_t, Sensor index.
+	 *  @param upper bool, True for the maximum, false for the minimum.
+	 *  @param step int8_t, ADC counts, the envelope keeps the minimum span when narrowing.
+	 *  @return Void.
+	 */
+	void trackStep(uint8_t index, bool upper, int8_t step);
+
+	/** @brief Move the envelopes toward the current frame, when it is confident.
+	 *  @return Void.
+	 */
+	void track();
+
 #pragma endregion
 
 public:
@@ -164,11 +208,35 @@ public:
 	 */
 	void calibrate();
 
+	/** @brief Set the background calibration.
+	 *
+	 *  The update() frames that show both the line and the background
+	 *  move the minimum and maximum of every sensor reading near one of
+	 *  them toward it, one ADC count per LINE_SENSOR_TRACK_PERIOD frames
+	 *  at most, so the calibration follows the ambient light and the
+	 *  surface wear and one glitch can not corrupt it. The sensors that
+	 *  stay near the line take the background step of the others. Enable
+	 *  it after calibrate().
+	 *  @param value bool, Tracking flag.
+	 *  @return Void.
+	 */
+	void setTracking(bool value);
+
+	/** @brief Get the background calibration flag.
+	 *  @return bool, Tracking flag.
+	 */
+	bool getTracking();
+
 	/** @brief Read line position.
 	 *  @return float, Weighted position determination.
 	 */
 	float getLinePosition();
 
+	/** @brief The last getLinePosition() saw the line.
+	 *  @return bool, True when on the line, otherwise the position holds the last side.
+	 */
+	bool getOnTheLine();
+
 	/** @brief Create hysteresis binarization.
 	 *  @param int sensor, Sensor index.
 	 *  @return bool, Threshold level.
@@ -0,0 +1,155 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// LinkLatency.cpp
+
+#include "LinkLatency.h"
+
+#pragma region Methods
+
+LinkLatency::LinkLatency()
+{
+	clear();
+}
+
+bool LinkLatency::ping(Print &out)
+{
+	unsigned long NowL = millis();
+	if (NowL - m_pingTime < LINK_PING_INTERVAL_MS)
+	{
+		return false;
+	}
+	m_pingTime = NowL;
+
+	uint32_t StampL = micros();
+	uint8_t ArgsL[4] = {(uint8_t)StampL, (uint8_t)(StampL >> 8), (uint8_t)(StampL >> 16), (uint8_t)(StampL >> 24)};
+
+	return CommandCodec::write(out, LINK_PING_ID, ArgsL, sizeof(ArgsL)) > 0;
+}
+
+bool LinkLatency::echo(const uint8_t *args, uint8_t size)
+{
+	if (size != 4)
+	{
+		return false;
+	}
+
+	uint32_t StampL = (uint32_t)args[0] | ((uint32_t)args[1] << 8) | ((uint32_t)args[2] << 16) | ((uint32_t)args[3] << 24);
+	add(&m_rtt, micros() - StampL);
+
+	return true;
+}
+
+void LinkLatency::command(uint32_t delay)
+{
+	m_commandTime = micros();
+	m_pending = true;
+
+	// Without an echo yet only the measured delay is known.
+	add(&m_age, getRttMin() / 2 + delay);
+}
+
+void LinkLatency::actuated()
+{
+	if (!m_pending)
+	{
+		return;
+	}
+
+	m_pending = false;
+	add(&m_actuation, micros() - m_commandTime);
+}
+
+uint32_t LinkLatency::getRttMin()
+{
+	uint32_t MinL = 0xFFFFFFFFUL;
+	for (uint8_t index = 0; index < m_rtt.Count; index++)
+	{
+		MinL = min(MinL, m_rtt.Samples[index]);
+	}
+
+	return m_rtt.Count > 0 ? MinL : 0;
+}
+
+void LinkLatency::report(LatencyReport_t *report)
+{
+	percentiles(&m_rtt, &report->RttP50, &report->RttP95);
+	percentiles(&m_age, &report->AgeP50, &report->AgeP95);
+	percentiles(&m_actuation, &report->ActuationP50, &report->ActuationP95);
+}
+
+void LinkLatency::clear()
+{
+	m_rtt.Index = m_rtt.Count = 0;
+	m_age.Index = m_age.Count = 0;
+	m_actuation.Index = m_actuation.Count = 0;
+	m_pending = false;
+}
+
+#pragma endregion
+
+#pragma region Private Methods
+
+void LinkLatency::add(LatencyWindow_t *window, uint32_t value)
+{
+	window->Samples[window->Index] = value;
+	window->Index = (window->Index + 1) % LINK_LATENCY_WINDOW;
+	if (window->Count < LINK_LATENCY_WINDOW)
+	{
+		window->Count++;
+	}
+}
+
+void LinkLatency::percentiles(const LatencyWindow_t *window, float *p50, float *p95)
+{
+	uint32_t SortedL[LINK_LATENCY_WINDOW];
+	uint8_t CountL = window->Count;
+
+	if (CountL == 0)
+	{
+		*p50 = *p95 = 0;
+		return;
+	}
+
+	// Insertion sort, the window is small.
+	for (uint8_t index = 0; index < CountL; index++)
+	{
+		uint32_t ValueL = window->Samples[index];
+		uint8_t PositionL = index;
+		while (PositionL > 0 && SortedL[PositionL - 1] > ValueL)
+		{
+			SortedL[PositionL] = SortedL[PositionL - 1];
+			PositionL--;
+		}
+		SortedL[PositionL] = ValueL;
+	}
+
+	// Nearest rank.
+	*p50 = SortedL[(CountL - 1) * 50 / 100] / 1000.0;
+	*p95 = SortedL[(CountL - 1) * 95 / 100] / 1000.0;
+}
+
+#pragma endregion
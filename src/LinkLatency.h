@@ -0,0 +1,161 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// LinkLatency.h
+
+#ifndef _LINKLATENCY_h
+#define _LINKLATENCY_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include "CommandCodec.h"
+
+#pragma region Definitions
+
+/**
+ * @brief Samples kept for the percentiles.
+ */
+#define LINK_LATENCY_WINDOW 32
+
+/**
+ * @brief Ping frame id, the argument is the sender micros().
+ */
+#define LINK_PING_ID 'P'
+
+/**
+ * @brief Echo frame id, the ping arguments sent back.
+ */
+#define LINK_ECHO_ID 'p'
+
+/**
+ * @brief Time between two pings.
+ */
+#define LINK_PING_INTERVAL_MS 500
+
+#pragma endregion
+
+/** @brief Latency report, all in ms. */
+typedef struct
+{
+	float RttP50;		///< Round trip time median.
+	float RttP95;		///< Round trip time 95th percentile.
+	float AgeP50;		///< Command one way age median.
+	float AgeP95;		///< Command one way age 95th percentile.
+	float ActuationP50; ///< Command to actuation median.
+	float ActuationP95; ///< Command to actuation 95th percentile.
+} LatencyReport_t;
+
+/** @brief Rolling samples window. */
+typedef struct
+{
+	uint32_t Samples[LINK_LATENCY_WINDOW]; ///< Samples in us.
+	uint8_t Index;						   ///< Next write position.
+	uint8_t Count;						   ///< Samples count, saturates at the window size.
+} LatencyWindow_t;
+
+/** @brief Control link latency.
+ *
+ *  The robot pings with its micros() and the host echoes the frame back,
+ *  so the round trip needs no clock sync. Commands are stamped when they
+ *  are handled: their one way age is half the fastest round trip plus the
+ *  extra delay the transport measured, and the command to actuation time
+ *  runs to the next actuated() call. report() gives the percentiles.
+ */
+class LinkLatency
+{
+protected:
+#pragma region Variables
+
+	LatencyWindow_t m_rtt;
+	LatencyWindow_t m_age;
+	LatencyWindow_t m_actuation;
+
+	unsigned long m_pingTime = 0;
+	unsigned long m_commandTime = 0;
+	bool m_pending = false;
+
+#pragma endregion
+
+#pragma region Methods
+
+	void add(LatencyWindow_t *window, uint32_t value);
+	void percentiles(const LatencyWindow_t *window, float *p50, float *p95);
+
+#pragma endregion
+
+public:
+#pragma region Methods
+
+	LinkLatency();
+
+	/** @brief Send a ping when the interval elapsed.
+	 *  @param out Print&, Link.
+	 *  @return bool, True when a ping was sent.
+	 */
+	bool ping(Print &out);
+
+	/** @brief Take an echo of our ping.
+	 *  @param args const uint8_t*, Echo arguments.
+	 *  @param size uint8_t, Arguments size.
+	 *  @return bool, False when it is not a valid echo.
+	 */
+	bool echo(const uint8_t *args, uint8_t size);
+
+	/** @brief Stamp a received command.
+	 *  @param delay uint32_t, Delay over the fastest frame the transport measured, us.
+	 *  @return Void.
+	 */
+	void command(uint32_t delay = 0);
+
+	/** @brief The last command reached the actuators.
+	 *  @return Void.
+	 */
+	void actuated();
+
+	/** @brief Get the fastest round trip in the window.
+	 *  @return uint32_t, Round trip in us, zero before the first echo.
+	 */
+	uint32_t getRttMin();
+
+	/** @brief Compute the percentiles.
+	 *  @param report LatencyReport_t*, Output.
+	 *  @return Void.
+	 */
+	void report(LatencyReport_t *report);
+
+	/** @brief Drop all samples.
+	 *  @return Void.
+	 */
+	void clear();
+
+#pragma endregion
+};
+
+#endif
@@ -0,0 +1,198 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// Log.cpp
+
+#include "Log.h"
+#include "CommandCodec.h"
+
+#pragma region Methods
+
+void LogClass::drain(Print &out)
+{
+	for (;;)
+	{
+		if (m_frameSent < m_frameSize)
+		{
+			int RoomL = out.availableForWrite();
+			if (RoomL <= 0)
+			{
+				return;
+			}
+
+			m_frameSent += out.write(m_frame + m_frameSent, min(RoomL, m_frameSize - m_frameSent));
+			continue;
+		}
+
+		if (m_announce < m_formatsCount)
+		{
+			define(m_announce++);
+			continue;
+		}
+
+		if (m_recordReady)
+		{
+			uint8_t *ArgsL = m_frame + 3;
+			uint8_t IdL = lookup(m_record.Format);
+			uint8_t SizeL = min((int)m_record.Size, LOG_FRAME_SIZE - 11);
+
+			ArgsL[0] = m_record.Level;
+			ArgsL[1] = IdL;
+			ArgsL[2] = m_record.Time & 0xFF;
+			ArgsL[3] = (m_record.Time >> 8) & 0xFF;
+			ArgsL[4] = (m_record.Time >> 16) & 0xFF;
+			ArgsL[5] = m_record.Time >> 24;
+			memcpy(ArgsL + 6, m_record.Args, SizeL);
+
+			m_frameSize = CommandCodec::frame(m_frame, LOG_RECORD_ID, ArgsL, 6 + SizeL);
+			m_frameSent = 0;
+			m_recordReady = false;
+			continue;
+		}
+
+		if (!m_queue.pop(m_record))
+		{
+			return;
+		}
+		m_recordReady = true;
+
+		// A new format is defined before its first record.
+		if (lookup(m_record.Format) == 0 && m_formatsCount < LOG_MAX_FORMATS)
+		{
+			bool CaughtUpL = m_announce == m_formatsCount;
+			m_formats[m_formatsCount] = m_record.Format;
+			define(m_formatsCount++);
+			if (CaughtUpL)
+			{
+				m_announce = m_formatsCount;
+			}
+		}
+	}
+}
+
+void LogClass::announce()
+{
+	m_announce = 0;
+}
+
+uint32_t LogClass::getDropped()
+{
+	return m_dropped;
+}
+
+#pragma endregion
+
+#pragma region Private Methods
+
+void LogClass::put(LogRecord_t &record, long value)
+{
+	put(record, (unsigned long)value);
+}
+
+void LogClass::put(LogRecord_t &record, unsigned long value)
+{
+	if (record.Size + 4 > LOG_MAX_ARGS)
+	{
+		return;
+	}
+
+	uint32_t ValueL = value;
+	for (uint8_t byte = 0; byte < 4; byte++)
+	{
+		record.Args[record.Size++] = (uint8_t)(ValueL >> (8 * byte));
+	}
+}
+
+void LogClass::put(LogRecord_t &record, double value)
+{
+	if (record.Size + 4 > LOG_MAX_ARGS)
+	{
+		return;
+	}
+
+	float ValueL = value;
+	memcpy(record.Args + record.Size, &ValueL, 4);
+	record.Size += 4;
+}
+
+void LogClass::put(LogRecord_t &record, const char *value)
+{
+	if (record.Size + 1 > LOG_MAX_ARGS)
+	{
+		return;
+	}
+
+	uint8_t LengthL = min(strlen(value), (size_t)(LOG_MAX_ARGS - record.Size - 1));
+	record.Args[record.Size++] = LengthL;
+	memcpy(record.Args + record.Size, value, LengthL);
+	record.Size += LengthL;
+}
+
+void LogClass::put(LogRecord_t &record, LogArray_t value)
+{
+	if (record.Size + 1 > LOG_MAX_ARGS)
+	{
+		return;
+	}
+
+	uint8_t CountL = min((int)value.Count, (LOG_MAX_ARGS - record.Size - 1) / 2);
+	record.Args[record.Size++] = CountL | (CountL < value.Count ? LOG_ARRAY_CUT : 0);
+	for (uint8_t index = 0; index < CountL; index++)
+	{
+		record.Args[record.Size++] = value.Values[index] & 0xFF;
+		record.Args[record.Size++] = value.Values[index] >> 8;
+	}
+}
+
+void LogClass::define(uint8_t id)
+{
+	const char *TextL = m_formats[id];
+	uint8_t LengthL = min(strlen(TextL), (size_t)(LOG_FRAME_SIZE - 6));
+
+	m_frame[3] = id + 1;
+	memcpy(m_frame + 4, TextL, LengthL);
+
+	m_frameSize = CommandCodec::frame(m_frame, LOG_DEFINE_ID, m_frame + 3, LengthL + 1);
+	m_frameSent = 0;
+}
+
+uint8_t LogClass::lookup(const char *format)
+{
+	for (uint8_t index = 0; index < m_formatsCount; index++)
+	{
+		if (m_formats[index] == format)
+		{
+			return index + 1;
+		}
+	}
+
+	// Id zero, the table is full.
+	return 0;
+}
+
+#pragma endregion
+
+LogClass Log;
@@ -0,0 +1,275 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// Log.h
+
+#ifndef _LOG_h
+#define _LOG_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include "SPSCQueue.h"
+
+#pragma region Definitions
+
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+/**
+ * @brief Compiled in log level, the calls above it vanish with their arguments.
+ */
+#if !defined(LOG_LEVEL)
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+#if defined(__AVR__)
+/**
+ * @brief Records waiting for the drain, power of two.
+ */
+#define LOG_QUEUE_SIZE 8
+
+#if defined(__AVR_ATmega2560__)
+/**
+ * @brief Argument bytes of one record, a %v of the eight line sensors takes 17.
+ */
+#define LOG_MAX_ARGS 20
+#else
+/**
+ * @brief Argument bytes of one record, a %v of the six line sensors takes 13.
+ */
+#define LOG_MAX_ARGS 16
+#endif
+
+/**
+ * @brief Known format strings.
+ */
+#define LOG_MAX_FORMATS 16
+
+/**
+ * @brief Output frame buffer, bounds the format text.
+ */
+#define LOG_FRAME_SIZE 48
+#else
+#define LOG_QUEUE_SIZE 32
+#define LOG_MAX_ARGS 24
+#define LOG_MAX_FORMATS 64
+#define LOG_FRAME_SIZE 128
+#endif
+
+/**
+ * @brief Record frame id.
+ */
+#define LOG_RECORD_ID 'L'
+
+/**
+ * @brief Format definition frame id.
+ */
+#define LOG_DEFINE_ID 'D'
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) Log.write(LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define LOG_ERROR(...)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(...) Log.write(LOG_LEVEL_WARN, __VA_ARGS__)
+#else
+#define LOG_WARN(...)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(...) Log.write(LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) Log.write(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...)
+#endif
+
+#pragma endregion
+
+/**
+ * @brief Count byte flag of a %v cut to fit the record.
+ */
+#define LOG_ARRAY_CUT 0x80
+
+/** @brief Array argument, printed by %v. */
+typedef struct
+{
+	const uint16_t *Values; ///< Values.
+	uint8_t Count;			///< Values count.
+} LogArray_t;
+
+/** @brief Make an array argument.
+ *  @param values const uint16_t*, Values.
+ *  @param count uint8_t, Values count.
+ *  @return LogArray_t, Argument.
+ */
+inline LogArray_t LogValues(const uint16_t *values, uint8_t count)
+{
+	LogArray_t ArrayL = {values, count};
+	return ArrayL;
+}
+
+/** @brief Queued log record. */
+typedef struct
+{
+	uint32_t Time;				 ///< micros() of the call.
+	const char *Format;			 ///< Format string, must be a literal.
+	uint8_t Level;				 ///< Log level.
+	uint8_t Size;				 ///< Argument bytes.
+	uint8_t Args[LOG_MAX_ARGS]; ///< Raw arguments.
+} LogRecord_t;
+
+/** @brief Deferred binary logger.
+ *
+ *  A call stores the format pointer, the time and the raw arguments in a
+ *  wait-free queue and returns, nothing is formatted on the robot. Integers
+ *  take 4 bytes, floating point a float, %s a length and up to the rest of
+ *  the record, %v a count and 16 bit values. Arguments that do not fit are
+ *  left out, a %v that does not fit is cut and LOG_ARRAY_CUT marks its
+ *  count, so the decoder shows it. One context logs, ISRs must not.
+ *
+ *  drain() runs in the background, the loop idle time or the comms core,
+ *  and writes only what the port takes without blocking. The first record
+ *  of a format is preceded by a LOG_DEFINE_ID frame with its id and text,
+ *  the records go as LOG_RECORD_ID frames: level, id, time and arguments.
+ *  Both are CommandCodec frames, extras/sim/log_decoder prints them.
+ */
+class LogClass
+{
+protected:
+#pragma region Variables
+
+	SPSCQueue<LogRecord_t, LOG_QUEUE_SIZE> m_queue;
+	uint32_t m_dropped = 0;
+
+	const char *m_formats[LOG_MAX_FORMATS];
+	uint8_t m_formatsCount = 0;
+	uint8_t m_announce = 0;
+
+	LogRecord_t m_record;
+	bool m_recordReady = false;
+
+	uint8_t m_frame[LOG_FRAME_SIZE];
+	uint8_t m_frameSize = 0;
+	uint8_t m_frameSent = 0;
+
+#pragma endregion
+
+#pragma region Methods
+
+	void put(LogRecord_t &record, long value);
+	void put(LogRecord_t &record, unsigned long value);
+	void put(LogRecord_t &record, double value);
+	void put(LogRecord_t &record, const char *value);
+	void put(LogRecord_t &record, LogArray_t value);
+
+	inline void put(LogRecord_t &record, int value)
+	{
+		put(record, (long)value);
+	}
+
+	inline void put(LogRecord_t &record, unsigned int value)
+	{
+		put(record, (unsigned long)value);
+	}
+
+	inline void pack(LogRecord_t &)
+	{
+	}
+
+	template <typename T, typename... Rest>
+	inline void pack(LogRecord_t &record, T value, Rest... rest)
+	{
+		put(record, value);
+		pack(record, rest...);
+	}
+
+	void define(uint8_t id);
+	uint8_t lookup(const char *format);
+
+#pragma endregion
+
+public:
+#pragma region Methods
+
+	/** @brief Queue a record, use the LOG_* macros.
+	 *  @param level uint8_t, Log level.
+	 *  @param format const char*, Format string literal.
+	 *  @param args, Arguments.
+	 *  @return Void.
+	 */
+	template <typename... Args>
+	void write(uint8_t level, const char *format, Args... args)
+	{
+		LogRecord_t RecordL;
+		RecordL.Time = micros();
+		RecordL.Format = format;
+		RecordL.Level = level;
+		RecordL.Size = 0;
+		pack(RecordL, args...);
+
+		if (!m_queue.push(RecordL))
+		{
+			m_dropped++;
+		}
+	}
+
+	/** @brief Send the queued records as far as the port takes them.
+	 *  @param out Print&, Output, must report availableForWrite().
+	 *  @return Void.
+	 */
+	void drain(Print &out);
+
+	/** @brief Send every known format again, for a decoder started late.
+	 *  @return Void.
+	 */
+	void announce();
+
+	/** @brief Get records lost on a full queue.
+	 *  @return uint32_t, Count.
+	 */
+	uint32_t getDropped();
+
+#pragma endregion
+};
+
+/** @brief Logger instance. */
+extern LogClass Log;
+
+#endif
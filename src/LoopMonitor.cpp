@@ -0,0 +1,152 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "LoopMonitor.h"
+#include "IOCapture.h"
+
+/** @brief Configure the supervisor.
+ *  @param periodMs uint32_t, Expected control period in ms, zero for unpaced loops.
+ *  @param budgetMs uint32_t, Allowed lateness in ms, zero disables the safe stop.
+ *  @return Void.
+ */
+void LoopMonitorClass::init(uint32_t periodMs, uint32_t budgetMs)
+{
+	m_period = periodMs * 1000UL;
+	m_budget = budgetMs * 1000UL;
+	reset();
+}
+
+/** @brief Set the safe stop callback.
+ *  @param callback, Called from tick() when the budget is exceeded.
+ *  @return Void.
+ */
+void LoopMonitorClass::setCbSafeStop(void (*callback)())
+{
+	callbackSafeStop = callback;
+}
+
+/** @brief Timestamp a control cycle.
+ *  @return bool, True when the cycle started within the budget.
+ */
+bool LoopMonitorClass::tick()
+{
+	uint32_t NowL = CAPTURE_MICROS();
+	bool InBudgetL = true;
+
+	if (m_started)
+	{
+		uint32_t ElapsedL = NowL - m_lastTick;
+
+		m_lastLateness = ElapsedL > m_period ? ElapsedL - m_period : 0;
+		if (m_lastLateness > m_maxLateness)
+		{
+			m_maxLateness = m_lastLateness;
+		}
+
+		// Timer based loops fire up to one polling pass late.
+		if (m_period > 0 && m_lastLateness > m_period * LOOP_MONITOR_SLACK_PCT / 100)
+		{
+			m_misses++;
+		}
+
+		if (m_budget > 0 && m_lastLateness > m_budget)
+		{
+			m_faults++;
+			InBudgetL = false;
+
+			if (callbackSafeStop != nullptr)
+			{
+				callbackSafeStop();
+			}
+		}
+
+		m_cycles++;
+	}
+
+	m_started = true;
+	m_lastTick = NowL;
+
+	return InBudgetL;
+}
+
+/** @brief Clear the statistics.
+ *  @return Void.
+ */
+void LoopMonitorClass::reset()
+{
+	m_started = false;
+	m_cycles = 0;
+	m_misses = 0;
+	m_faults = 0;
+	m_lastLateness = 0;
+	m_maxLateness = 0;
+}
+
+/** @brief Get cycles count.
+ *  @return uint32_t, Count.
+ */
+uint32_t LoopMonitorClass::getCycles()
+{
+	return m_cycles;
+}
+
+/** @brief Get deadline misses count.
+ *  @return uint32_t, Count.
+ */
+uint32_t LoopMonitorClass::getMisses()
+{
+	return m_misses;
+}
+
+/** @brief Get budget violations count.
+ *  @return uint32_t, Count.
+ */
+uint32_t LoopMonitorClass::getFaults()
+{
+	return m_faults;
+}
+
+/** @brief Get last lateness.
+ *  @return uint32_t, Lateness in us.
+ */
+uint32_t LoopMonitorClass::getLastLateness()
+{
+	return m_lastLateness;
+}
+
+/** @brief Get worst lateness.
+ *  @return uint32_t, Lateness in us.
+ */
+uint32_t LoopMonitorClass::getMaxLateness()
+{
+	return m_maxLateness;
+}
+
+/**
+ * @brief Loop monitor instance.
+ *
+ */
+LoopMonitorClass LoopMonitor;
@@ -0,0 +1,149 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// LoopMonitor.h
+
+#ifndef _LOOPMONITOR_h
+#define _LOOPMONITOR_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+/**
+ * @brief Lateness in percent of the period tolerated before a cycle counts as a miss.
+ */
+#define LOOP_MONITOR_SLACK_PCT 10
+
+/** @brief Control loop deadline supervisor.
+ *
+ *  Call tick() once at the start of every control cycle. The time since
+ *  the previous tick is compared with the expected period, misses and the
+ *  worst lateness are counted, and the safe stop callback is fired on
+ *  every cycle whose lateness exceeds the budget, so it has to tolerate
+ *  repeated calls.
+ */
+class LoopMonitorClass
+{
+protected:
+#pragma region Variables
+
+	/** @brief Expected period in us. */
+	uint32_t m_period = 0;
+
+	/** @brief Lateness budget in us, zero disables the safe stop. */
+	uint32_t m_budget = 0;
+
+	/** @brief Previous tick time in us. */
+	uint32_t m_lastTick = 0;
+
+	/** @brief First tick flag. */
+	bool m_started = false;
+
+	/** @brief Cycles count. */
+	uint32_t m_cycles = 0;
+
+	/** @brief Deadline misses count. */
+	uint32_t m_misses = 0;
+
+	/** @brief Budget violations count. */
+	uint32_t m_faults = 0;
+
+	/** @brief Last lateness in us. */
+	uint32_t m_lastLateness = 0;
+
+	/** @brief Worst lateness in us. */
+	uint32_t m_maxLateness = 0;
+
+	/** @brief Safe stop callback. */
+	void (*callbackSafeStop)();
+
+#pragma endregion
+
+public:
+#pragma region Methods
+
+	/** @brief Configure the supervisor.
+	 *  @param periodMs uint32_t, Expected control period in ms, zero for unpaced loops.
+	 *  @param budgetMs uint32_t, Allowed lateness in ms, zero disables the safe stop.
+	 *  @return Void.
+	 */
+	void init(uint32_t periodMs, uint32_t budgetMs);
+
+	/** @brief Set the safe stop callback.
+	 *  @param callback, Called from tick() when the budget is exceeded.
+	 *  @return Void.
+	 */
+	void setCbSafeStop(void (*callback)());
+
+	/** @brief Timestamp a control cycle.
+	 *
+	 *  For unpaced loops the lateness is the full cycle time and only the
+	 *  budget is checked.
+	 *
+	 *  @return bool, True when the cycle started within the budget.
+	 */
+	bool tick();
+
+	/** @brief Clear the statistics.
+	 *  @return Void.
+	 */
+	void reset();
+
+	/** @brief Get cycles count.
+	 *  @return uint32_t, Count.
+	 */
+	uint32_t getCycles();
+
+	/** @brief Get deadline misses count.
+	 *  @return uint32_t, Count.
+	 */
+	uint32_t getMisses();
+
+	/** @brief Get budget violations count.
+	 *  @return uint32_t, Count.
+	 */
+	uint32_t getFaults();
+
+	/** @brief Get last lateness.
+	 *  @return uint32_t, Lateness in us.
+	 */
+	uint32_t getLastLateness();
+
+	/** @brief Get worst lateness.
+	 *  @return uint32_t, Lateness in us.
+	 */
+	uint32_t getMaxLateness();
+
+#pragma endregion
+};
+
+/** @brief Instance of the loop monitor. */
+extern LoopMonitorClass LoopMonitor;
+
+#endif
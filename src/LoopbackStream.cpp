@@ -0,0 +1,100 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// LoopbackStream.cpp
+
+#include "LoopbackStream.h"
+
+#pragma region Methods
+
+void LoopbackStream::connect(LoopbackStream &peer)
+{
+	m_peer = &peer;
+	peer.m_peer = this;
+}
+
+size_t LoopbackStream::write(uint8_t value)
+{
+	if (m_peer == nullptr || !m_peer->push(value))
+	{
+		return 0;
+	}
+
+	return 1;
+}
+
+int LoopbackStream::available()
+{
+	return m_count;
+}
+
+int LoopbackStream::read()
+{
+	if (m_count == 0)
+	{
+		return -1;
+	}
+
+	uint8_t ValueL = m_buffer[m_head];
+	m_head = (m_head + 1) % LOOPBACK_BUFFER_SIZE;
+	m_count--;
+
+	return ValueL;
+}
+
+int LoopbackStream::peek()
+{
+	return m_count == 0 ? -1 : m_buffer[m_head];
+}
+
+void LoopbackStream::flush()
+{
+}
+
+uint32_t LoopbackStream::getDropped()
+{
+	return m_dropped;
+}
+
+#pragma endregion
+
+#pragma region Private Methods
+
+bool LoopbackStream::push(uint8_t value)
+{
+	if (m_count >= LOOPBACK_BUFFER_SIZE)
+	{
+		m_dropped++;
+		return false;
+	}
+
+	m_buffer[(m_head + m_count) % LOOPBACK_BUFFER_SIZE] = value;
+	m_count++;
+
+	return true;
+}
+
+#pragma endregion
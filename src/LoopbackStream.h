@@ -0,0 +1,98 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// LoopbackStream.h
+
+#ifndef _LOOPBACKSTREAM_h
+#define _LOOPBACKSTREAM_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#pragma region Definitions
+
+/**
+ * @brief Receive buffer size of one end.
+ */
+#define LOOPBACK_BUFFER_SIZE 64
+
+#pragma endregion
+
+/** @brief One end of an in memory byte pipe.
+ *
+ *  Bytes written to one end are read from its peer, so a router and a
+ *  host side stand in for a remote link without any hardware.
+ *  A full receive buffer drops the bytes, as a lossy link does.
+ */
+class LoopbackStream : public Stream
+{
+protected:
+#pragma region Variables
+
+	LoopbackStream *m_peer = nullptr;
+
+	uint8_t m_buffer[LOOPBACK_BUFFER_SIZE];
+	uint8_t m_head = 0;
+	uint8_t m_count = 0;
+
+	uint32_t m_dropped = 0;
+
+#pragma endregion
+
+#pragma region Methods
+
+	bool push(uint8_t value);
+
+#pragma endregion
+
+public:
+#pragma region Methods
+
+	/** @brief Connect both ends.
+	 *  @param peer LoopbackStream&, Other end.
+	 *  @return Void.
+	 */
+	void connect(LoopbackStream &peer);
+
+	size_t write(uint8_t value) override;
+	using Print::write;
+	int available() override;
+	int read() override;
+	int peek() override;
+	void flush() override;
+
+	/** @brief Get bytes dropped on a full buffer.
+	 *  @return uint32_t, Count.
+	 */
+	uint32_t getDropped();
+
+#pragma endregion
+};
+
+#endif
@@ -25,6 +25,8 @@ SOFTWARE.
 */
 
 #include "LowPassFilter.h"
+#include "Profiler.h"
+#include "IOCapture.h"
 
 LowPassFilter::LowPassFilter(int order, float f0, float fs, bool adaptive)
 {
@@ -61,7 +63,7 @@ void LowPassFilter::setCoef()
 {
   if (m_adaptive)
   {
-    float t = micros() / 1.0e6;
+    float t = CAPTURE_MICROS() / 1.0e6;
     m_dt = t - m_tn1;
     m_tn1 = t;
   }
@@ -89,6 +91,8 @@ void LowPassFilter::setCoef()
 
 float LowPassFilter::filter(float xn)
 {
+  PROFILE_ZONE("LowPassFilter.filter");
+
   // Provide me with the current raw value: x
   // I will give you the current filtered value: y
   if (m_adaptive)
@@ -0,0 +1,50 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// MixerCurve.h
+
+#ifndef _MIXERCURVE_h
+#define _MIXERCURVE_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+/** @brief Mixer curve points, spaced by 8 on the [0 to 256] input magnitude. */
+#define MIXER_CURVE_POINTS 33
+
+/** @brief Mixer curve input magnitude to point index shift. */
+#define MIXER_CURVE_SHIFT 3
+
+/** @brief Precomputed dead zone, expo and rate curve for one mixer axis. */
+typedef struct
+{
+	uint8_t Points[MIXER_CURVE_POINTS]; ///< Output magnitude [0 to 255] per input point.
+} MixerCurve_t;
+
+#endif
@@ -25,6 +25,8 @@ SOFTWARE.
 */
 
 #include "MotorController.h"
+#include "Profiler.h"
+#include "IOCapture.h"
 
 /** @brief Initialize the H bridge for motor control.
  *  @return Void.
@@ -57,9 +59,18 @@ void MotorControllerClass::init(MotorModel_t *ModelL)
 	m_MotorSpeedTimer->setExpirationTime(RPM_UPDATE_TIME);
 	m_MotorSpeedTimer->updateLastTime();
 
+#if SPEED_ESTIMATOR == SPEED_ESTIMATOR_AB
+	// Init the model-based estimators, working in pulses and pulses per second.
+	double PulsesPerSecPerPWML = ESTIMATOR_RPM_PER_PWM * m_motorModel.EncoderTracks / 60.0;
+	m_posLeft = 0;
+	m_posRight = 0;
+	m_EstLeftSpeed = new SpeedEstimator(ESTIMATOR_ALPHA, ESTIMATOR_BETA, PulsesPerSecPerPWML, ESTIMATOR_TAU);
+	m_EstRightSpeed = new SpeedEstimator(ESTIMATOR_ALPHA, ESTIMATOR_BETA, PulsesPerSecPerPWML, ESTIMATOR_TAU);
+#else
 	// Init the low pass filters.
 	m_LPFLeftSpeed = new LowPassFilter(FILTER_ORDER, SUPPRESSION_FRQ, UPDATE_FRQ, FILTER_ADAPT);
 	m_LPFRightSpeed = new LowPassFilter(FILTER_ORDER, SUPPRESSION_FRQ, UPDATE_FRQ, FILTER_ADAPT);
+#endif // SPEED_ESTIMATOR_AB
 }
 
 void MotorControllerClass::update()
@@ -79,6 +90,12 @@ void MotorControllerClass::update()
  */
 void MotorControllerClass::UpdateLeftEncoder()
 {
+	// The replay counts only the logged edges.
+	if (!CAPTURE_ENCODER(0))
+	{
+		return;
+	}
+
 	// Increment left counter value.
 	m_encLeftPulses++;
 
@@ -99,6 +116,12 @@ void MotorControllerClass::UpdateLeftEncoder()
  */
 void MotorControllerClass::UpdateRightEncoder()
 {
+	// The replay counts only the logged edges.
+	if (!CAPTURE_ENCODER(1))
+	{
+		return;
+	}
+
 	// Increment right counter value.
 	m_encRightPulses++;
 
@@ -138,21 +161,44 @@ unsigned int MotorControllerClass::MM2Steps(float mm)
 
 void MotorControllerClass::calc_motors_speed()
 {
+	PROFILE_ZONE("calc_motors_speed");
+
 	// Declare motor speed, number of pulses and time elapsed
 	static unsigned long PreviousTimeL = 0;
 	static unsigned long CurrentTimeL = 0;
 	static unsigned long DeltaTimeL = 0;
+#if SPEED_ESTIMATOR != SPEED_ESTIMATOR_AB
 	static double LeftPulsesPerMsL = 0;
 	static double RightPulsesPerMsL = 0;
-
-	// Calculate motor speed based on the number of pulses and time elapsed
-	CurrentTimeL = millis();
-	DeltaTimeL = CurrentTimeL - PreviousTimeL;
+#endif // SPEED_ESTIMATOR_AB
 
 #if defined(__AVR_ATmega328P__) || defined(__AVR_ATmega2560__)
 	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
 	{
 #endif
+		// Calculate motor speed based on the number of pulses and time elapsed.
+		// The time is read with the pulses, no edge falls between them in a capture.
+		CurrentTimeL = CAPTURE_MILLIS();
+		DeltaTimeL = CurrentTimeL - PreviousTimeL;
+
+#if SPEED_ESTIMATOR == SPEED_ESTIMATOR_AB
+		// Accumulate the signed wheel positions.
+		m_posLeft += m_encLeftPulses * m_dirCntLeft;
+		m_posRight += m_encRightPulses * m_dirCntRight;
+
+		// Reset encoder pulse count and update previous time
+		m_encLeftPulses = 0;
+		m_encRightPulses = 0;
+		PreviousTimeL = CurrentTimeL;
+
+		// Fuse the positions with the commanded PWM.
+		m_EstLeftSpeed->update(m_posLeft, m_leftPWM, DeltaTimeL / 1000.0);
+		m_EstRightSpeed->update(m_posRight, m_rightPWM, DeltaTimeL / 1000.0);
+
+		// Convert speed to RPM.
+		m_leftMotorRPM = m_EstLeftSpeed->getVelocity() * (60.0 / m_motorModel.EncoderTracks);
+		m_rightMotorRPM = m_EstRightSpeed->getVelocity() * (60.0 / m_motorModel.EncoderTracks);
+#else
 		// Calculate motor speed in pulses per millisecond
 		LeftPulsesPerMsL = static_cast<double>(m_encLeftPulses) / static_cast<double>(DeltaTimeL);
 		RightPulsesPerMsL = static_cast<double>(m_encRightPulses) / static_cast<double>(DeltaTimeL);
@@ -173,6 +219,7 @@ void MotorControllerClass::calc_motors_speed()
 		// Apply average
 		m_avgLeft += (m_leftMotorRPM - m_avgLeft) * m_K;
 		m_avgRight += (m_leftMotorRPM - m_avgRight) * m_K;
+#endif // SPEED_ESTIMATOR_AB
 
 #if defined(__AVR_ATmega328P__) || defined(__AVR_ATmega2560__)
 	}
@@ -186,6 +233,8 @@ void MotorControllerClass::calc_motors_speed()
  */
 void MotorControllerClass::SetPWM(int16_t left, int16_t right)
 {
+	PROFILE_ZONE("SetPWM");
+
 	if (left > PWM_MAX)
 	{
 		left = PWM_MAX;
@@ -216,6 +265,8 @@ void MotorControllerClass::SetPWM(int16_t left, int16_t right)
 	m_leftPWM = left;
 	m_rightPWM = right;
 
+	CAPTURE_OUTPUT(left, right);
+
 	if (left > 0)
 	{
 		// Forward.
@@ -345,6 +396,34 @@ double MotorControllerClass::GetRightMotorRPM()
 	return this->m_rightMotorRPM;
 }
 
+/**
+ * @brief Get the Left wheel acceleration.
+ *
+ * @return double RPM per second Value, zero without model-based estimator.
+ */
+double MotorControllerClass::GetLeftMotorAccel()
+{
+#if SPEED_ESTIMATOR == SPEED_ESTIMATOR_AB
+	return m_EstLeftSpeed->getAcceleration() * (60.0 / m_motorModel.EncoderTracks);
+#else
+	return 0;
+#endif // SPEED_ESTIMATOR_AB
+}
+
+/**
+ * @brief Get the Right wheel acceleration.
+ *
+ * @return double RPM per second Value, zero without model-based estimator.
+ */
+double MotorControllerClass::GetRightMotorAccel()
+{
+#if SPEED_ESTIMATOR == SPEED_ESTIMATOR_AB
+	return m_EstRightSpeed->getAcceleration() * (60.0 / m_motorModel.EncoderTracks);
+#else
+	return 0;
+#endif // SPEED_ESTIMATOR_AB
+}
+
 /**
  * @brief Bridge controller instance.
  *
@@ -54,6 +54,47 @@ SOFTWARE.
  */
 #define RPM_UPDATE_TIME 100
 
+/**
+ * @brief Speed estimator based on the low pass filter chain.
+ */
+#define SPEED_ESTIMATOR_LPF 0
+
+/**
+ * @brief Speed estimator based on the alpha-beta motor model.
+ */
+#define SPEED_ESTIMATOR_AB 1
+
+#if !defined(SPEED_ESTIMATOR)
+/**
+ * @brief Selected wheel speed estimator.
+ */
+#define SPEED_ESTIMATOR SPEED_ESTIMATOR_LPF
+#endif // SPEED_ESTIMATOR
+
+#if SPEED_ESTIMATOR == SPEED_ESTIMATOR_AB
+
+/**
+ * @brief Alpha-beta position correction gain.
+ */
+#define ESTIMATOR_ALPHA 0.5
+
+/**
+ * @brief Alpha-beta velocity correction gain.
+ */
+#define ESTIMATOR_BETA 0.2
+
+/**
+ * @brief Motor model steady state RPM per PWM unit.
+ */
+#define ESTIMATOR_RPM_PER_PWM 2.55
+
+/**
+ * @brief Motor model time constant in seconds.
+ */
+#define ESTIMATOR_TAU 0.1
+
+#endif // SPEED_ESTIMATOR_AB
+
 /**
  * @brief PWM minimum value.
  */
@@ -72,6 +113,7 @@ SOFTWARE.
 
 #include "FxTimer.h"
 #include "LowPassFilter.h"
+#include "SpeedEstimator.h"
 // #include "DebugPort.h"
 
 #if defined(__AVR_ATmega328P__) || defined(__AVR_ATmega2560__)
@@ -161,6 +203,27 @@ protected:
 	 */
 	double m_rightMotorRPM;
 
+#if SPEED_ESTIMATOR == SPEED_ESTIMATOR_AB
+	/**
+	 * @brief Left wheel signed position in encoder pulses.
+	 */
+	double m_posLeft;
+
+	/**
+	 * @brief Right wheel signed position in encoder pulses.
+	 */
+	double m_posRight;
+
+	/**
+	 * @brief Model-based left speed estimator.
+	 */
+	SpeedEstimator *m_EstLeftSpeed;
+
+	/**
+	 * @brief Model-based right speed estimator.
+	 */
+	SpeedEstimator *m_EstRightSpeed;
+#else
 	/**
 	 * @brief Low Pass filter left speed.
 	 */
@@ -170,6 +233,7 @@ protected:
 	 * @brief Low Pass filter right speed.
 	 */
 	LowPassFilter *m_LPFRightSpeed; // (2, 5, 1e3, true);
+#endif // SPEED_ESTIMATOR_AB
 
 	/**
 	 * @brief Average to the left feedback.
@@ -316,6 +380,20 @@ public:
 	 */
 	double GetRightMotorRPM();
 
+	/**
+	 * @brief Get the Left wheel acceleration.
+	 *
+	 * @return double RPM per second Value, zero without model-based estimator.
+	 */
+	double GetLeftMotorAccel();
+
+	/**
+	 * @brief Get the Right wheel acceleration.
+	 *
+	 * @return double RPM per second Value, zero without model-based estimator.
+	 */
+	double GetRightMotorAccel();
+
 #pragma endregion
 };
 
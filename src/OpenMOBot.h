@@ -37,17 +37,42 @@ SOFTWARE.
 
 #include "HCSR04.h"
 #include "LineSensor.h"
+#include "LineFollower.h"
+#include "SpeedPlanner.h"
+#include "TrackMapper.h"
 #include "LowPassFilter.h"
 #include "MotorController.h"
+#include "BoardConfig.h"
+#include "SlidingStats.h"
+#include "SonarManager.h"
+#include "SonarScanner.h"
+#include "SpeedEstimator.h"
 #include "LRData.h"
 #include "XYData.h"
+#include "VWData.h"
+#include "Kinematics.h"
+#include "MixerCurve.h"
 #include "utils.h"
 #include "FxTimer.h"
+#include "CoopScheduler.h"
+#include "SPSCQueue.h"
+#include "DualCore.h"
+#include "Profiler.h"
+#include "LoopMonitor.h"
+#include "IOCapture.h"
+#include "CommandCodec.h"
+#include "CommandRouter.h"
+#include "LoopbackStream.h"
+#include "LinkLatency.h"
+#include "Log.h"
+#include "Telemetry.h"
+#include "CarCommands.h"
 
 #pragma region GPIO Map
 
 // Check the microcontroller type
-#if defined(__AVR_ATmega328P__)
+// The host simulation (extras/sim) runs on the UNO map.
+#if defined(__AVR_ATmega328P__) || defined(OPENMOBOT_SIM)
 
 /** @brief Line sensors count. */
 #define LINE_SENSORS_COUNT 6
@@ -243,6 +268,9 @@ SOFTWARE.
 
 #define LINE_SENSORS_CALIBRATION_SIZE 50
 
+/** @brief Distance between two line sensors in mm. */
+#define LINE_SENSORS_PITCH 12.0
+
 #pragma endregion
 
 #pragma region Wheels & Differential Model
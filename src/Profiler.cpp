@@ -0,0 +1,159 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "Profiler.h"
+
+#ifdef ENABLE_PROFILER
+
+/** @brief Clear the statistics of one zone.
+ *  @param zone ProfilerZone_t*, Zone.
+ *  @return Void.
+ */
+void ProfilerClass::clearZone(ProfilerZone_t *zone)
+{
+	zone->Count = 0;
+	zone->Min = 0xFFFFFFFF;
+	zone->Max = 0;
+	zone->Total = 0;
+	for (uint8_t bucket = 0; bucket < PROFILER_BUCKETS; bucket++)
+	{
+		zone->Histogram[bucket] = 0;
+	}
+}
+
+/** @brief Register a zone, done once per zone by PROFILE_ZONE.
+ *  @param name const char*, Zone name.
+ *  @return uint8_t, Zone id, PROFILER_MAX_ZONES when full.
+ */
+uint8_t ProfilerClass::registerZone(const char *name)
+{
+	if (m_zonesCount >= PROFILER_MAX_ZONES)
+	{
+		return PROFILER_MAX_ZONES;
+	}
+
+	// A zone runs first at any time, the others keep their statistics.
+	m_zones[m_zonesCount].Name = name;
+	clearZone(&m_zones[m_zonesCount]);
+	m_zonesCount++;
+
+	return m_zonesCount - 1;
+}
+
+/** @brief Add a duration to a zone.
+ *  @param id uint8_t, Zone id.
+ *  @param duration uint32_t, Duration in cycles.
+ *  @return Void.
+ */
+void ProfilerClass::record(uint8_t id, uint32_t duration)
+{
+	if (id >= m_zonesCount)
+	{
+		return;
+	}
+
+	ProfilerZone_t *ZoneL = &m_zones[id];
+
+	ZoneL->Count++;
+	ZoneL->Total += duration;
+	if (duration < ZoneL->Min)
+	{
+		ZoneL->Min = duration;
+	}
+	if (duration > ZoneL->Max)
+	{
+		ZoneL->Max = duration;
+	}
+
+	// Bucket is the position of the highest set bit.
+	uint8_t BucketL = 0;
+	while ((duration >>= 1) != 0 && BucketL < PROFILER_BUCKETS - 1)
+	{
+		BucketL++;
+	}
+	if (ZoneL->Histogram[BucketL] < 0xFFFF)
+	{
+		ZoneL->Histogram[BucketL]++;
+	}
+}
+
+/** @brief Clear all statistics, keep the zones.
+ *  @return Void.
+ */
+void ProfilerClass::reset()
+{
+	for (uint8_t index = 0; index < m_zonesCount; index++)
+	{
+		clearZone(&m_zones[index]);
+	}
+}
+
+/** @brief Print min, max, mean and histogram of every zone.
+ *  @param out Print&, Output.
+ *  @return Void.
+ */
+void ProfilerClass::report(Print &out)
+{
+	out.println("zone, count, min, mean, max [cycles], log2 histogram");
+
+	for (uint8_t index = 0; index < m_zonesCount; index++)
+	{
+		ProfilerZone_t *ZoneL = &m_zones[index];
+
+		out.print(ZoneL->Name);
+		out.print(", ");
+		out.print(ZoneL->Count);
+		out.print(", ");
+		out.print(ZoneL->Count ? ZoneL->Min : 0);
+		out.print(", ");
+		out.print(ZoneL->Count ? (uint32_t)(ZoneL->Total / ZoneL->Count) : 0);
+		out.print(", ");
+		out.print(ZoneL->Max);
+		out.print(",");
+
+		// Print only the populated buckets.
+		for (uint8_t bucket = 0; bucket < PROFILER_BUCKETS; bucket++)
+		{
+			if (ZoneL->Histogram[bucket] == 0)
+			{
+				continue;
+			}
+			out.print(" 2^");
+			out.print(bucket);
+			out.print(":");
+			out.print(ZoneL->Histogram[bucket]);
+		}
+		out.println();
+	}
+}
+
+/**
+ * @brief Profiler instance.
+ *
+ */
+ProfilerClass Profiler;
+
+#endif // ENABLE_PROFILER
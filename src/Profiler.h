@@ -0,0 +1,194 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// Profiler.h
+
+#ifndef _PROFILER_h
+#define _PROFILER_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#pragma region Definitions
+
+/**
+ * @brief Enable the hot-path profiler, zones compile to nothing without it.
+ */
+// #define ENABLE_PROFILER
+
+/**
+ * @brief Maximum profiled zones.
+ */
+#define PROFILER_MAX_ZONES 16
+
+/**
+ * @brief Histogram buckets, bucket n holds durations in [2^n, 2^(n+1)) cycles.
+ */
+#define PROFILER_BUCKETS 24
+
+#define PROFILER_CONCAT_(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_(a, b)
+
+#ifdef ENABLE_PROFILER
+/**
+ * @brief Profile the rest of the enclosing scope.
+ */
+#define PROFILE_ZONE(name)                                                                     \
+	static uint8_t PROFILER_CONCAT(ProfilerZoneL, __LINE__) = Profiler.registerZone(name); \
+	ProfilerScope PROFILER_CONCAT(ProfilerScopeL, __LINE__)(PROFILER_CONCAT(ProfilerZoneL, __LINE__))
+
+/**
+ * @brief Print the profiler report.
+ */
+#define PROFILE_REPORT(out) Profiler.report(out)
+
+/**
+ * @brief Clear the profiler statistics.
+ */
+#define PROFILE_RESET() Profiler.reset()
+#else
+#define PROFILE_ZONE(name)
+#define PROFILE_REPORT(out)
+#define PROFILE_RESET()
+#endif
+
+#pragma endregion
+
+#ifdef ENABLE_PROFILER
+
+/** @brief Profiled zone statistics. */
+typedef struct
+{
+	const char *Name;					  ///< Zone name.
+	uint32_t Count;						  ///< Executions count.
+	uint32_t Min;						  ///< Shortest duration in cycles.
+	uint32_t Max;						  ///< Longest duration in cycles.
+	uint64_t Total;						  ///< Sum of durations in cycles.
+	uint16_t Histogram[PROFILER_BUCKETS]; ///< Log2 duration histogram.
+} ProfilerZone_t;
+
+/** @brief Fixed table of profiled zones. */
+class ProfilerClass
+{
+protected:
+#pragma region Variables
+
+	/** @brief Zones table. */
+	ProfilerZone_t m_zones[PROFILER_MAX_ZONES];
+
+	/** @brief Registered zones count. */
+	uint8_t m_zonesCount = 0;
+
+#pragma endregion
+
+#pragma region Methods
+
+	/** @brief Clear the statistics of one zone.
+	 *  @param zone ProfilerZone_t*, Zone.
+	 *  @return Void.
+	 */
+	void clearZone(ProfilerZone_t *zone);
+
+#pragma endregion
+
+public:
+#pragma region Methods
+
+	/** @brief Read the cycle counter.
+	 *
+	 *  ESP32 reads CCOUNT. AVR derives it from the timer 0 based micros(),
+	 *  timer 1 is left to the motor PWM and the servo.
+	 *
+	 *  @return uint32_t, CPU cycles.
+	 */
+	static inline uint32_t cycles()
+	{
+#if defined(ESP32)
+		return ESP.getCycleCount();
+#else
+		return micros() * (F_CPU / 1000000UL);
+#endif
+	}
+
+	/** @brief Register a zone, done once per zone by PROFILE_ZONE.
+	 *  @param name const char*, Zone name.
+	 *  @return uint8_t, Zone id, PROFILER_MAX_ZONES when full.
+	 */
+	uint8_t registerZone(const char *name);
+
+	/** @brief Add a duration to a zone.
+	 *  @param id uint8_t, Zone id.
+	 *  @param duration uint32_t, Duration in cycles.
+	 *  @return Void.
+	 */
+	void record(uint8_t id, uint32_t duration);
+
+	/** @brief Clear all statistics, keep the zones.
+	 *  @return Void.
+	 */
+	void reset();
+
+	/** @brief Print min, max, mean and histogram of every zone.
+	 *  @param out Print&, Output.
+	 *  @return Void.
+	 */
+	void report(Print &out);
+
+#pragma endregion
+};
+
+/** @brief Instance of the profiler. */
+extern ProfilerClass Profiler;
+
+/** @brief Measures its own lifetime into a zone. */
+class ProfilerScope
+{
+protected:
+	/** @brief Zone id. */
+	uint8_t m_id;
+
+	/** @brief Start cycles. */
+	uint32_t m_start;
+
+public:
+	ProfilerScope(uint8_t id)
+	{
+		m_id = id;
+		m_start = ProfilerClass::cycles();
+	}
+
+	~ProfilerScope()
+	{
+		Profiler.record(m_id, ProfilerClass::cycles() - m_start);
+	}
+};
+
+#endif // ENABLE_PROFILER
+
+#endif
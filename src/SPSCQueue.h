@@ -0,0 +1,144 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// SPSCQueue.h
+
+#ifndef _SPSCQUEUE_h
+#define _SPSCQUEUE_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+/** @brief Wait-free single producer, single consumer ring buffer.
+ *
+ *  One task or ISR may push and one other may pop. The indexes are free
+ *  running and published with release/acquire ordering, so neither side
+ *  ever waits or disables interrupts.
+ *
+ *  @tparam T Item type, copied in and out.
+ *  @tparam N Capacity, power of two.
+ */
+template <typename T, size_t N>
+class SPSCQueue
+{
+#if defined(__AVR__)
+	// Byte wide indexes are read atomically on AVR.
+	typedef uint8_t Index_t;
+	static_assert(N <= 128, "SPSCQueue capacity must not exceed 128 on AVR");
+#else
+	typedef uint32_t Index_t;
+#endif
+	static_assert(N > 0 && (N & (N - 1)) == 0, "SPSCQueue capacity must be a power of two");
+
+protected:
+	/** @brief Items storage. */
+	T m_items[N];
+
+	/** @brief Write index, owned by the producer. */
+	Index_t m_head = 0;
+
+	/** @brief Read index, owned by the consumer. */
+	Index_t m_tail = 0;
+
+public:
+	/** @brief Producer side, add an item.
+	 *  @param item const T&, Item to copy in.
+	 *  @return bool, False when full.
+	 */
+	bool push(const T &item)
+	{
+		Index_t HeadL = __atomic_load_n(&m_head, __ATOMIC_RELAXED);
+		Index_t TailL = __atomic_load_n(&m_tail, __ATOMIC_ACQUIRE);
+
+		if ((Index_t)(HeadL - TailL) >= N)
+		{
+			return false;
+		}
+
+		m_items[HeadL & (N - 1)] = item;
+		__atomic_store_n(&m_head, (Index_t)(HeadL + 1), __ATOMIC_RELEASE);
+		return true;
+	}
+
+	/** @brief Consumer side, take the oldest item.
+	 *  @param item T&, Item to copy out.
+	 *  @return bool, False when empty.
+	 */
+	bool pop(T &item)
+	{
+		Index_t TailL = __atomic_load_n(&m_tail, __ATOMIC_RELAXED);
+		Index_t HeadL = __atomic_load_n(&m_head, __ATOMIC_ACQUIRE);
+
+		if (HeadL == TailL)
+		{
+			return false;
+		}
+
+		item = m_items[TailL & (N - 1)];
+		__atomic_store_n(&m_tail, (Index_t)(TailL + 1), __ATOMIC_RELEASE);
+		return true;
+	}
+
+	/** @brief Consumer side, drop everything but the newest item.
+	 *  @param item T&, Item to copy out.
+	 *  @return bool, False when empty.
+	 */
+	bool popLatest(T &item)
+	{
+		Index_t TailL = __atomic_load_n(&m_tail, __ATOMIC_RELAXED);
+		Index_t HeadL = __atomic_load_n(&m_head, __ATOMIC_ACQUIRE);
+
+		if (HeadL == TailL)
+		{
+			return false;
+		}
+
+		item = m_items[(Index_t)(HeadL - 1) & (N - 1)];
+		__atomic_store_n(&m_tail, HeadL, __ATOMIC_RELEASE);
+		return true;
+	}
+
+	/** @brief Items waiting, exact only from the producer or consumer side.
+	 *  @return size_t, Count.
+	 */
+	size_t size()
+	{
+		return (Index_t)(__atomic_load_n(&m_head, __ATOMIC_ACQUIRE) - __atomic_load_n(&m_tail, __ATOMIC_ACQUIRE));
+	}
+
+	/** @brief Queue capacity.
+	 *  @return size_t, Capacity.
+	 */
+	size_t capacity()
+	{
+		return N;
+	}
+};
+
+#endif
@@ -0,0 +1,353 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// SlidingStats.h
+
+#ifndef _SLIDINGSTATS_h
+#define _SLIDINGSTATS_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+/** @brief Constant time sliding window statistics.
+ *
+ *  Sums are kept relative to a reference value close to the mean. A shadow
+ *  pair of sums is accumulated while the ring is refilled, so after every
+ *  full window the drifting sums are replaced by exact ones and the
+ *  reference is moved to the current mean.
+ *
+ *  @tparam N Window size.
+ */
+template <size_t N>
+class SlidingStats
+{
+protected:
+#pragma region Variables
+
+	/** @brief Samples ring buffer. */
+	float m_samples[N];
+
+	/** @brief Next write position. */
+	size_t m_index;
+
+	/** @brief Samples count, saturates at N. */
+	size_t m_count;
+
+	/** @brief Reference the sums are centered on. */
+	float m_ref;
+
+	/** @brief Sum of (x - ref) over the window. */
+	float m_sum;
+
+	/** @brief Sum of (x - ref)^2 over the window. */
+	float m_sumSq;
+
+	/** @brief Shadow sum of the current pass. */
+	float m_shadowSum;
+
+	/** @brief Shadow sum of squares of the current pass. */
+	float m_shadowSumSq;
+
+	/** @brief Monotonic queue of minimum candidates, sample sequence numbers. */
+	uint32_t m_minQueue[N];
+
+	/** @brief Monotonic queue of maximum candidates, sample sequence numbers. */
+	uint32_t m_maxQueue[N];
+
+	/** @brief Minimum queue head and length. */
+	size_t m_minHead, m_minLen;
+
+	/** @brief Maximum queue head and length. */
+	size_t m_maxHead, m_maxLen;
+
+	/** @brief Sequence number of the next sample. */
+	uint32_t m_seq;
+
+#pragma endregion
+
+#pragma region Methods
+
+	/** @brief Sample value by sequence number, must be inside the window. */
+	float at(uint32_t seq)
+	{
+		return m_samples[seq % N];
+	}
+
+	/** @brief Push a sequence number to a monotonic queue.
+	 *  @param queue Queue storage.
+	 *  @param head Queue head.
+	 *  @param len Queue length.
+	 *  @param value New sample value.
+	 *  @param isMin True for the minimum queue.
+	 */
+	void pushMonotonic(uint32_t *queue, size_t &head, size_t &len, float value, bool isMin)
+	{
+		// Drop the candidate leaving the window.
+		if (len > 0 && queue[head] + N <= m_seq)
+		{
+			head = (head + 1) % N;
+			len--;
+		}
+
+		// Drop candidates that can never win again.
+		while (len > 0)
+		{
+			float TailL = at(queue[(head + len - 1) % N]);
+			if (isMin ? (TailL < value) : (TailL > value))
+			{
+				break;
+			}
+			len--;
+		}
+
+		queue[(head + len) % N] = m_seq;
+		len++;
+	}
+
+#pragma endregion
+
+public:
+#pragma region Methods
+
+	SlidingStats()
+	{
+		clear();
+	}
+
+	/** @brief Drop all samples.
+	 *  @return Void.
+	 */
+	void clear()
+	{
+		m_index = 0;
+		m_count = 0;
+		m_ref = 0;
+		m_sum = 0;
+		m_sumSq = 0;
+		m_shadowSum = 0;
+		m_shadowSumSq = 0;
+		m_minHead = m_minLen = 0;
+		m_maxHead = m_maxLen = 0;
+		m_seq = 0;
+	}
+
+	/** @brief Add a sample, constant time.
+	 *  @param value float, New sample.
+	 *  @return Void.
+	 */
+	void update(float value)
+	{
+		float NewL = value - m_ref;
+
+		if (m_count == N)
+		{
+			float OldL = m_samples[m_index] - m_ref;
+			m_sum -= OldL;
+			m_sumSq -= OldL * OldL;
+		}
+		else
+		{
+			m_count++;
+		}
+
+		m_sum += NewL;
+		m_sumSq += NewL * NewL;
+		m_shadowSum += NewL;
+		m_shadowSumSq += NewL * NewL;
+
+		m_samples[m_index] = value;
+		pushMonotonic(m_minQueue, m_minHead, m_minLen, value, true);
+		pushMonotonic(m_maxQueue, m_maxHead, m_maxLen, value, false);
+		m_seq++;
+
+		if (++m_index >= N)
+		{
+			m_index = 0;
+
+			// The shadow sums now hold exactly the current window.
+			m_sum = m_shadowSum;
+			m_sumSq = m_shadowSumSq;
+
+			// Re-center on the mean: sum((x - r') ^ 2) = S2 - 2dS + Nd^2.
+			float DeltaL = m_sum / N;
+			m_sumSq -= DeltaL * (2 * m_sum - N * DeltaL);
+			m_sum = 0;
+			m_ref += DeltaL;
+
+			m_shadowSum = 0;
+			m_shadowSumSq = 0;
+		}
+	}
+
+	/** @brief Window is full.
+	 *  @return bool, True when N samples are collected.
+	 */
+	bool filled()
+	{
+		return m_count == N;
+	}
+
+	/** @brief Samples in the window.
+	 *  @return size_t, Count.
+	 */
+	size_t count()
+	{
+		return m_count;
+	}
+
+	/** @brief Window mean.
+	 *  @return float, Mean value.
+	 */
+	float mean()
+	{
+		if (m_count == 0)
+		{
+			return 0;
+		}
+		return m_ref + m_sum / m_count;
+	}
+
+	/** @brief Unbiased window variance.
+	 *  @return float, Variance.
+	 */
+	float variance()
+	{
+		if (m_count < 2)
+		{
+			return 0;
+		}
+		float VarL = (m_sumSq - m_sum * m_sum / m_count) / (m_count - 1);
+		return VarL > 0 ? VarL : 0;
+	}
+
+	/** @brief Unbiased window standard deviation.
+	 *  @return float, Standard deviation.
+	 */
+	float stdDev()
+	{
+		return sqrt(variance());
+	}
+
+	/** @brief Window minimum.
+	 *  @return float, Minimum value.
+	 */
+	float minimum()
+	{
+		return m_minLen ? at(m_minQueue[m_minHead]) : 0;
+	}
+
+	/** @brief Window maximum.
+	 *  @return float, Maximum value.
+	 */
+	float maximum()
+	{
+		return m_maxLen ? at(m_maxQueue[m_maxHead]) : 0;
+	}
+
+	/** @brief Check a value against the window spread.
+	 *  @param value float, Value to test.
+	 *  @param k float, Allowed standard deviations from the mean.
+	 *  @return bool, True when the value is an outlier.
+	 */
+	bool isOutlier(float value, float k)
+	{
+		if (!filled())
+		{
+			return false;
+		}
+		return fabs(value - mean()) > k * stdDev();
+	}
+
+#pragma endregion
+};
+
+/** @brief Median of the last K samples, rejects single spikes.
+ *
+ *  @tparam K Median window size, small and odd.
+ */
+template <size_t K>
+class MedianFilter
+{
+protected:
+	/** @brief Samples ring buffer. */
+	float m_samples[K];
+
+	/** @brief Next write position. */
+	size_t m_index;
+
+	/** @brief Samples count, saturates at K. */
+	size_t m_count;
+
+public:
+	MedianFilter()
+	{
+		clear();
+	}
+
+	/** @brief Drop all samples.
+	 *  @return Void.
+	 */
+	void clear()
+	{
+		m_index = 0;
+		m_count = 0;
+	}
+
+	/** @brief Add a sample and get the median.
+	 *  @param value float, New sample.
+	 *  @return float, Median of the collected samples.
+	 */
+	float filter(float value)
+	{
+		m_samples[m_index] = value;
+		m_index = (m_index + 1) % K;
+		if (m_count < K)
+		{
+			m_count++;
+		}
+
+		// Insertion sort of a copy, K is small.
+		float SortedL[K];
+		for (size_t i = 0; i < m_count; i++)
+		{
+			float ValueL = m_samples[i];
+			size_t j = i;
+			while (j > 0 && SortedL[j - 1] > ValueL)
+			{
+				SortedL[j] = SortedL[j - 1];
+				j--;
+			}
+			SortedL[j] = ValueL;
+		}
+
+		return SortedL[m_count / 2];
+	}
+};
+
+#endif // _SLIDINGSTATS_h
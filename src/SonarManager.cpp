@@ -0,0 +1,133 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "SonarManager.h"
+
+/** @brief Register an initialized sonar.
+ *  @param sonar HCSR04*, Sonar instance.
+ *  @return int, Channel index or -1 when full.
+ */
+int SonarManagerClass::addChannel(HCSR04 *sonar)
+{
+	if (m_channelsCount >= SONAR_MAX_CHANNELS)
+	{
+		return -1;
+	}
+
+	m_sonars[m_channelsCount] = sonar;
+	m_distances[m_channelsCount] = 0;
+	m_timestamps[m_channelsCount] = 0;
+
+	return m_channelsCount++;
+}
+
+/** @brief Set guard interval between pings.
+ *  @param microsec unsigned long, Guard time in us.
+ *  @return Void.
+ */
+void SonarManagerClass::setGuard(unsigned long microsec)
+{
+	m_guard = microsec;
+}
+
+/** @brief Advance the schedule, never blocks longer than a trigger pulse.
+ *  @return bool, True when a new measurement was published.
+ */
+bool SonarManagerClass::update()
+{
+	if (m_channelsCount == 0)
+	{
+		return false;
+	}
+
+	if (m_inFlight)
+	{
+		long MicrosecL;
+		if (!m_sonars[m_current]->poll(&MicrosecL))
+		{
+			return false;
+		}
+
+		// Publish and move to the next channel.
+		m_distances[m_current] = m_sonars[m_current]->convert(MicrosecL, HCSR04::CM);
+		m_timestamps[m_current] = millis();
+		m_lastDone = micros();
+		m_inFlight = false;
+		m_current = (m_current + 1) % m_channelsCount;
+		return true;
+	}
+
+	// Wait for the echoes of the previous ping to die out.
+	if (micros() - m_lastDone < m_guard)
+	{
+		return false;
+	}
+
+	m_inFlight = m_sonars[m_current]->trigger();
+	return false;
+}
+
+/** @brief Get the latest distance.
+ *  @param channel uint8_t, Channel index.
+ *  @return float, Distance in CM, zero when no echo.
+ */
+float SonarManagerClass::getDistance(uint8_t channel)
+{
+	if (channel >= m_channelsCount)
+	{
+		return 0;
+	}
+
+	return m_distances[channel];
+}
+
+/** @brief Get the age of the latest distance.
+ *  @param channel uint8_t, Channel index.
+ *  @return unsigned long, Age in ms, maximum value before the first result.
+ */
+unsigned long SonarManagerClass::getAge(uint8_t channel)
+{
+	if (channel >= m_channelsCount || m_timestamps[channel] == 0)
+	{
+		return (unsigned long)-1;
+	}
+
+	return millis() - m_timestamps[channel];
+}
+
+/** @brief Get registered channels count.
+ *  @return uint8_t, Count.
+ */
+uint8_t SonarManagerClass::getChannelsCount()
+{
+	return m_channelsCount;
+}
+
+/**
+ * @brief Sonar manager instance.
+ *
+ */
+SonarManagerClass SonarManager;
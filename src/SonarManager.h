@@ -0,0 +1,130 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// SonarManager.h
+
+#ifndef _SONARMANAGER_h
+#define _SONARMANAGER_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include "HCSR04.h"
+
+/**
+ * @brief Maximum sonar channels.
+ */
+#define SONAR_MAX_CHANNELS 5
+
+/**
+ * @brief Quiet time between two pings, lets late echoes die out.
+ */
+#define SONAR_GUARD_US 10000UL
+
+/** @brief Round-robin scheduler for several asynchronous sonars.
+ *
+ *  Only one sonar is in flight at a time and the next one is fired after
+ *  the guard interval, so echoes of one channel are not heard by another.
+ *  The echo ISR of every channel must be attached by the application.
+ */
+class SonarManagerClass
+{
+protected:
+#pragma region Variables
+
+	/** @brief Registered sonars. */
+	HCSR04 *m_sonars[SONAR_MAX_CHANNELS];
+
+	/** @brief Latest distance per channel in CM, zero when no echo. */
+	float m_distances[SONAR_MAX_CHANNELS];
+
+	/** @brief Latest measurement time per channel in ms. */
+	unsigned long m_timestamps[SONAR_MAX_CHANNELS];
+
+	/** @brief Registered channels count. */
+	uint8_t m_channelsCount = 0;
+
+	/** @brief Channel in flight or next to fire. */
+	uint8_t m_current = 0;
+
+	/** @brief Channel in flight flag. */
+	bool m_inFlight = false;
+
+	/** @brief End of the last measurement in us. */
+	unsigned long m_lastDone = 0;
+
+	/** @brief Guard interval in us. */
+	unsigned long m_guard = SONAR_GUARD_US;
+
+#pragma endregion
+
+public:
+#pragma region Methods
+
+	/** @brief Register an initialized sonar.
+	 *  @param sonar HCSR04*, Sonar instance.
+	 *  @return int, Channel index or -1 when full.
+	 */
+	int addChannel(HCSR04 *sonar);
+
+	/** @brief Set guard interval between pings.
+	 *  @param microsec unsigned long, Guard time in us.
+	 *  @return Void.
+	 */
+	void setGuard(unsigned long microsec);
+
+	/** @brief Advance the schedule, never blocks longer than a trigger pulse.
+	 *  @return bool, True when a new measurement was published.
+	 */
+	bool update();
+
+	/** @brief Get the latest distance.
+	 *  @param channel uint8_t, Channel index.
+	 *  @return float, Distance in CM, zero when no echo.
+	 */
+	float getDistance(uint8_t channel);
+
+	/** @brief Get the age of the latest distance.
+	 *  @param channel uint8_t, Channel index.
+	 *  @return unsigned long, Age in ms, maximum value before the first result.
+	 */
+	unsigned long getAge(uint8_t channel);
+
+	/** @brief Get registered channels count.
+	 *  @return uint8_t, Count.
+	 */
+	uint8_t getChannelsCount();
+
+#pragma endregion
+};
+
+/** @brief Instance of the sonar manager. */
+extern SonarManagerClass SonarManager;
+
+#endif // _SONARMANAGER_h
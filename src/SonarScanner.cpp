@@ -0,0 +1,186 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "SonarScanner.h"
+
+/** @brief Configure the scanner and start the sweep.
+ *  @param sonar HCSR04*, Initialized sonar with attached echo ISR.
+ *  @param callback, Servo write callback taking angle in degrees.
+ *  @param minAngle int, First bin angle.
+ *  @param maxAngle int, Last bin angle.
+ *  @param step int, Angle step between bins.
+ *  @return Void.
+ */
+void SonarScannerClass::init(HCSR04 *sonar, void (*callback)(int), int minAngle, int maxAngle, int step)
+{
+	m_sonar = sonar;
+	callbackServoWrite = callback;
+	m_minAngle = minAngle;
+	m_step = max(step, 1);
+	m_binsCount = constrain((maxAngle - minAngle) / m_step + 1, 1, SCAN_MAX_BINS);
+	m_direction = 1;
+	m_inFlight = false;
+	m_pingBin = 0;
+
+	for (uint8_t index = 0; index < m_binsCount; index++)
+	{
+		m_ranges[index] = 0;
+		m_timestamps[index] = 0;
+	}
+
+	// Unknown start position, assume the full travel.
+	m_servoBin = m_binsCount - 1;
+	moveTo(0);
+}
+
+/** @brief Command the servo to a bin and model its settle time.
+ *  @param bin uint8_t, Target bin.
+ *  @return Void.
+ */
+void SonarScannerClass::moveTo(uint8_t bin)
+{
+	unsigned long TravelL = abs((int)bin - (int)m_servoBin) * m_step;
+
+	m_servoBin = bin;
+	m_settleTime = millis() + SCAN_SERVO_DEAD_MS + TravelL * SCAN_SERVO_MS_PER_DEG;
+
+	if (callbackServoWrite != nullptr)
+	{
+		callbackServoWrite(getAngle(bin));
+	}
+}
+
+/** @brief Advance the scan, never blocks longer than a trigger pulse.
+ *  @return bool, True when a bin was updated.
+ */
+bool SonarScannerClass::update()
+{
+	if (m_binsCount == 0)
+	{
+		return false;
+	}
+
+	if (m_inFlight)
+	{
+		long MicrosecL;
+		if (!m_sonar->poll(&MicrosecL))
+		{
+			return false;
+		}
+
+		m_ranges[m_pingBin] = (uint16_t)(m_sonar->convert(MicrosecL, HCSR04::CM) * 10.0);
+		// Zero marks a bin never measured, the wrapping clock skips it.
+		uint16_t NowL = (uint16_t)millis();
+		m_timestamps[m_pingBin] = NowL == 0 ? 1 : NowL;
+		m_inFlight = false;
+		return true;
+	}
+
+	// Wait for the servo to reach the bin.
+	if ((long)(millis() - m_settleTime) < 0)
+	{
+		return false;
+	}
+
+	if (!m_sonar->trigger())
+	{
+		return false;
+	}
+
+	m_inFlight = true;
+	m_pingBin = m_servoBin;
+
+	// Overlap the next servo move with the echo wait.
+	if (m_binsCount > 1)
+	{
+		if ((m_direction > 0 && m_servoBin == m_binsCount - 1) || (m_direction < 0 && m_servoBin == 0))
+		{
+			m_direction = -m_direction;
+		}
+		moveTo(m_servoBin + m_direction);
+	}
+
+	return false;
+}
+
+/** @brief Get bins count.
+ *  @return uint8_t, Count.
+ */
+uint8_t SonarScannerClass::getBinsCount()
+{
+	return m_binsCount;
+}
+
+/** @brief Get bin angle.
+ *  @param bin uint8_t, Bin index.
+ *  @return int, Angle in degrees.
+ */
+int SonarScannerClass::getAngle(uint8_t bin)
+{
+	return m_minAngle + bin * m_step;
+}
+
+/** @brief Get bin range.
+ *  @param bin uint8_t, Bin index.
+ *  @return uint16_t, Range in mm, zero when no echo.
+ */
+uint16_t SonarScannerClass::getRange(uint8_t bin)
+{
+	if (bin >= m_binsCount)
+	{
+		return 0;
+	}
+
+	return m_ranges[bin];
+}
+
+/** @brief Get bin age.
+ *  @param bin uint8_t, Bin index.
+ *  @return uint16_t, Age in ms, valid up to 65 s, 0xFFFF when never measured.
+ */
+uint16_t SonarScannerClass::getAge(uint8_t bin)
+{
+	if (bin >= m_binsCount || m_timestamps[bin] == 0)
+	{
+		return 0xFFFF;
+	}
+
+	return (uint16_t)millis() - m_timestamps[bin];
+}
+
+/** @brief Get the last updated bin.
+ *  @return uint8_t, Bin index.
+ */
+uint8_t SonarScannerClass::getLastBin()
+{
+	return m_pingBin;
+}
+
+/**
+ * @brief Sonar scanner instance.
+ *
+ */
+SonarScannerClass SonarScanner;
@@ -0,0 +1,175 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// SonarScanner.h
+
+#ifndef _SONARSCANNER_h
+#define _SONARSCANNER_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include "HCSR04.h"
+
+#if !defined(SCAN_MAX_BINS)
+#if defined(__AVR_ATmega328P__)
+/**
+ * @brief Maximum polar map bins.
+ */
+#define SCAN_MAX_BINS 37
+#else
+/**
+ * @brief Maximum polar map bins.
+ */
+#define SCAN_MAX_BINS 181
+#endif
+#endif // SCAN_MAX_BINS
+
+/**
+ * @brief Servo dead time before it starts to move, one PWM frame.
+ */
+#define SCAN_SERVO_DEAD_MS 20
+
+/**
+ * @brief Servo travel time per degree.
+ */
+#define SCAN_SERVO_MS_PER_DEG 2
+
+/** @brief Servo sweep sonar scanner.
+ *
+ *  The servo is commanded to the next bin right after the ping is fired,
+ *  so the servo travel overlaps with the echo wait. A ping is fired only
+ *  when the modeled servo settle time has elapsed.
+ */
+class SonarScannerClass
+{
+protected:
+#pragma region Variables
+
+	/** @brief Sonar in asynchronous mode. */
+	HCSR04 *m_sonar;
+
+	/** @brief Servo write callback. */
+	void (*callbackServoWrite)(int);
+
+	/** @brief Range per bin in mm, zero when no echo. */
+	uint16_t m_ranges[SCAN_MAX_BINS];
+
+	/** @brief Measurement time per bin, lower 16 bits of millis(). */
+	uint16_t m_timestamps[SCAN_MAX_BINS];
+
+	/** @brief First bin angle. */
+	int m_minAngle;
+
+	/** @brief Angle step between bins. */
+	int m_step;
+
+	/** @brief Bins count. */
+	uint8_t m_binsCount = 0;
+
+	/** @brief Bin the servo is commanded to. */
+	uint8_t m_servoBin;
+
+	/** @brief Bin of the ping in flight. */
+	uint8_t m_pingBin;
+
+	/** @brief Sweep direction, 1 or -1. */
+	int8_t m_direction;
+
+	/** @brief Ping in flight flag. */
+	bool m_inFlight;
+
+	/** @brief Time the servo is expected to be settled. */
+	unsigned long m_settleTime;
+
+#pragma endregion
+
+#pragma region Methods
+
+	/** @brief Command the servo to a bin and model its settle time.
+	 *  @param bin uint8_t, Target bin.
+	 *  @return Void.
+	 */
+	void moveTo(uint8_t bin);
+
+#pragma endregion
+
+public:
+#pragma region Methods
+
+	/** @brief Configure the scanner and start the sweep.
+	 *  @param sonar HCSR04*, Initialized sonar with attached echo ISR.
+	 *  @param callback, Servo write callback taking angle in degrees.
+	 *  @param minAngle int, First bin angle.
+	 *  @param maxAngle int, Last bin angle.
+	 *  @param step int, Angle step between bins.
+	 *  @return Void.
+	 */
+	void init(HCSR04 *sonar, void (*callback)(int), int minAngle, int maxAngle, int step);
+
+	/** @brief Advance the scan, never blocks longer than a trigger pulse.
+	 *  @return bool, True when a bin was updated.
+	 */
+	bool update();
+
+	/** @brief Get bins count.
+	 *  @return uint8_t, Count.
+	 */
+	uint8_t getBinsCount();
+
+	/** @brief Get bin angle.
+	 *  @param bin uint8_t, Bin index.
+	 *  @return int, Angle in degrees.
+	 */
+	int getAngle(uint8_t bin);
+
+	/** @brief Get bin range.
+	 *  @param bin uint8_t, Bin index.
+	 *  @return uint16_t, Range in mm, zero when no echo.
+	 */
+	uint16_t getRange(uint8_t bin);
+
+	/** @brief Get bin age.
+	 *  @param bin uint8_t, Bin index.
+	 *  @return uint16_t, Age in ms, valid up to 65 s, 0xFFFF when never measured.
+	 */
+	uint16_t getAge(uint8_t bin);
+
+	/** @brief Get the last updated bin.
+	 *  @return uint8_t, Bin index.
+	 */
+	uint8_t getLastBin();
+
+#pragma endregion
+};
+
+/** @brief Instance of the sonar scanner. */
+extern SonarScannerClass SonarScanner;
+
+#endif // _SONARSCANNER_h
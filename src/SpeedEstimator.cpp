@@ -0,0 +1,88 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "SpeedEstimator.h"
+
+SpeedEstimator::SpeedEstimator(float alpha, float beta, float gain, float tau)
+{
+	m_alpha = alpha;
+	m_beta = beta;
+	m_gain = gain;
+	m_tau = tau;
+
+	reset(0);
+}
+
+void SpeedEstimator::reset(float position)
+{
+	m_position = position;
+	m_velocity = 0;
+	m_acceleration = 0;
+}
+
+float SpeedEstimator::update(float position, float input, float dt)
+{
+	if (dt <= 0)
+	{
+		return m_velocity;
+	}
+
+	// Acceleration predicted by the first order motor model.
+	float ModelAccelerationL = 0;
+	if (m_tau > 0)
+	{
+		ModelAccelerationL = (m_gain * input - m_velocity) / m_tau;
+	}
+
+	// Predict.
+	float PredPositionL = m_position + (m_velocity + 0.5 * ModelAccelerationL * dt) * dt;
+	float PredVelocityL = m_velocity + ModelAccelerationL * dt;
+
+	// Correct with the measured position residual.
+	float ResidualL = position - PredPositionL;
+	float VelocityL = PredVelocityL + (m_beta / dt) * ResidualL;
+
+	m_acceleration = (VelocityL - m_velocity) / dt;
+	m_position = PredPositionL + m_alpha * ResidualL;
+	m_velocity = VelocityL;
+
+	return m_velocity;
+}
+
+float SpeedEstimator::getPosition()
+{
+	return m_position;
+}
+
+float SpeedEstimator::getVelocity()
+{
+	return m_velocity;
+}
+
+float SpeedEstimator::getAcceleration()
+{
+	return m_acceleration;
+}
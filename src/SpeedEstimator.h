@@ -0,0 +1,115 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// SpeedEstimator.h
+
+#ifndef _SPEEDESTIMATOR_h
+#define _SPEEDESTIMATOR_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+/** @brief Model-based alpha-beta wheel speed estimator.
+ *
+ *  The state is the wheel position and velocity. Between encoder readings
+ *  the state is predicted with a first order motor model driven by the
+ *  commanded PWM, then corrected with the measured position residual.
+ */
+class SpeedEstimator
+{
+protected:
+#pragma region Variables
+
+	/** @brief Position correction gain. */
+	float m_alpha;
+
+	/** @brief Velocity correction gain. */
+	float m_beta;
+
+	/** @brief Steady state velocity per PWM unit. */
+	float m_gain;
+
+	/** @brief Motor time constant in seconds, zero disables the model. */
+	float m_tau;
+
+	/** @brief Estimated position. */
+	float m_position;
+
+	/** @brief Estimated velocity. */
+	float m_velocity;
+
+	/** @brief Estimated acceleration. */
+	float m_acceleration;
+
+#pragma endregion
+
+public:
+#pragma region Methods
+
+	/** @brief Create the estimator.
+	 *  @param alpha float, Position correction gain [0 to 1].
+	 *  @param beta float, Velocity correction gain [0 to 2].
+	 *  @param gain float, Steady state velocity per PWM unit.
+	 *  @param tau float, Motor time constant in seconds.
+	 */
+	SpeedEstimator(float alpha, float beta, float gain, float tau);
+
+	/** @brief Reset the state to a standstill at the given position.
+	 *  @param position float, Current measured position.
+	 *  @return Void.
+	 */
+	void reset(float position);
+
+	/** @brief Run one predict and correct step.
+	 *  @param position float, Measured position.
+	 *  @param input float, Commanded PWM applied over the last period.
+	 *  @param dt float, Elapsed time in seconds.
+	 *  @return float, Estimated velocity.
+	 */
+	float update(float position, float input, float dt);
+
+	/** @brief Get the estimated position.
+	 *  @return float, Position.
+	 */
+	float getPosition();
+
+	/** @brief Get the estimated velocity.
+	 *  @return float, Velocity per second.
+	 */
+	float getVelocity();
+
+	/** @brief Get the estimated acceleration.
+	 *  @return float, Acceleration per second squared.
+	 */
+	float getAcceleration();
+
+#pragma endregion
+};
+
+#endif // _SPEEDESTIMATOR_h
@@ -0,0 +1,164 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// SpeedPlanner.cpp
+
+#include "SpeedPlanner.h"
+
+#include "IOCapture.h"
+
+#pragma region Private Methods
+
+void SpeedPlanner::updateCurvature(float heading, float distance)
+{
+	uint8_t LastL = (m_index + SPEED_PLANNER_SAMPLES - 1) % SPEED_PLANNER_SAMPLES;
+
+	// A reset odometer starts over.
+	if (m_count > 0 && distance < m_distances[LastL])
+	{
+		m_count = 0;
+	}
+
+	if (m_count > 0 && distance - m_distances[LastL] < SPEED_PLANNER_STEP_MM)
+	{
+		return;
+	}
+
+	m_headings[m_index] = heading;
+	m_distances[m_index] = distance;
+	m_index = (m_index + 1) % SPEED_PLANNER_SAMPLES;
+	if (m_count < SPEED_PLANNER_SAMPLES)
+	{
+		m_count++;
+	}
+
+	if (m_count < 2)
+	{
+		return;
+	}
+
+	// Heading change over the whole window, the oldest sample against the newest.
+	uint8_t OldestL = (m_index + SPEED_PLANNER_SAMPLES - m_count) % SPEED_PLANNER_SAMPLES;
+	m_curvature = (heading - m_headings[OldestL]) / (distance - m_distances[OldestL]);
+}
+
+#pragma endregion
+
+#pragma region Methods
+
+void SpeedPlanner::init(float wheelsDistance)
+{
+	m_wheelsDistance = wheelsDistance;
+
+	reset();
+}
+
+void SpeedPlanner::setLimits(float maxSpeed, float lateralAccel, float accel)
+{
+	m_maxSpeed = maxSpeed;
+	m_lateralAccel = lateralAccel;
+	m_accel = accel;
+}
+
+void SpeedPlanner::setMaxSpeed(float maxSpeed)
+{
+	m_maxSpeed = maxSpeed;
+}
+
+void SpeedPlanner::setMinSpeed(float minSpeed)
+{
+	m_minSpeed = minSpeed;
+}
+
+void SpeedPlanner::setRisk(float safeError, float minRatio)
+{
+	m_safeError = safeError;
+	m_minRatio = minRatio;
+}
+
+void SpeedPlanner::reset()
+{
+	m_index = 0;
+	m_count = 0;
+	m_curvature = 0;
+	m_speed = 0;
+	m_time = CAPTURE_MICROS();
+}
+
+float SpeedPlanner::update(float leftDistance, float rightDistance, float lineAngle, float lineError)
+{
+	uint32_t NowL = CAPTURE_MICROS();
+	float DtL = (float)(NowL - m_time) * 1e-6f;
+	m_time = NowL;
+
+	// The line heading, the robot heading plus the line angle to it.
+	float HeadingL = (rightDistance - leftDistance) / m_wheelsDistance + lineAngle;
+	updateCurvature(HeadingL, (leftDistance + rightDistance) / 2.0);
+
+	float TargetL = m_maxSpeed;
+
+	// Lateral acceleration limit.
+	float CurvatureL = fabs(m_curvature);
+	if (m_lateralAccel > 0 && CurvatureL > SPEED_PLANNER_MIN_CURVATURE)
+	{
+		TargetL = min(TargetL, (float)sqrt(m_lateralAccel / CurvatureL));
+	}
+
+	// Line loss limit, down to the minimum ratio at the edge of the array.
+	float ErrorL = fabs(lineError);
+	if (ErrorL > m_safeError && m_safeError < 1)
+	{
+		float RatioL = 1.0 - (1.0 - m_minRatio) * (ErrorL - m_safeError) / (1.0 - m_safeError);
+		TargetL = min(TargetL, m_maxSpeed * max(RatioL, m_minRatio));
+	}
+
+	// Speed up at the acceleration limit, slow down at once.
+	if (m_accel > 0 && TargetL > m_speed)
+	{
+		m_speed = min(TargetL, m_speed + m_accel * DtL);
+	}
+	else
+	{
+		m_speed = TargetL;
+	}
+
+	// Never below the stall speed, unless the knob asks for less.
+	m_speed = max(m_speed, min(m_minSpeed, m_maxSpeed));
+
+	return m_speed;
+}
+
+float SpeedPlanner::getCurvature()
+{
+	return m_curvature;
+}
+
+float SpeedPlanner::getSpeed()
+{
+	return m_speed;
+}
+
+#pragma endregion
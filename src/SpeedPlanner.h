@@ -0,0 +1,165 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// SpeedPlanner.h
+
+#ifndef _SPEEDPLANNER_h
+#define _SPEEDPLANNER_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#pragma region Definitions
+
+/**
+ * @brief Samples of the curvature window.
+ */
+#define SPEED_PLANNER_SAMPLES 6
+
+/**
+ * @brief Travelled distance between two curvature samples, mm.
+ */
+#define SPEED_PLANNER_STEP_MM 20.0
+
+/**
+ * @brief Smallest curvature that limits the speed, 1/mm.
+ */
+#define SPEED_PLANNER_MIN_CURVATURE 1e-5
+
+#pragma endregion
+
+/** @brief Curvature aware forward speed planner.
+ *
+ *  The path curvature is the change of the line heading over the last
+ *  SPEED_PLANNER_SAMPLES distance samples. The line heading is the robot
+ *  heading from the wheel distance difference plus the line angle to the
+ *  robot from LineFollower, so the encoder quantization and the steering
+ *  wobble do not read as curves.
+ *
+ *  Each frame the speed is the lowest of the speed limit, the speed that
+ *  keeps the lateral acceleration v^2 * k under its limit and the line
+ *  loss limit, which slows down as the line error leaves the safe band.
+ *  Speeding up is rate limited, slowing down is immediate, and the speed
+ *  stays above the minimum the motors still turn at.
+ */
+class SpeedPlanner
+{
+protected:
+#pragma region Variables
+
+	float m_wheelsDistance = 130;
+
+	float m_maxSpeed = 0;
+	float m_minSpeed = 0;
+	float m_lateralAccel = 0;
+	float m_accel = 0;
+	float m_safeError = 1;
+	float m_minRatio = 1;
+
+	float m_headings[SPEED_PLANNER_SAMPLES];
+	float m_distances[SPEED_PLANNER_SAMPLES];
+	uint8_t m_index = 0;
+	uint8_t m_count = 0;
+
+	float m_curvature = 0;
+	float m_speed = 0;
+	uint32_t m_time = 0;
+
+#pragma endregion
+
+#pragma region Methods
+
+	void updateCurvature(float heading, float distance);
+
+#pragma endregion
+
+public:
+#pragma region Methods
+
+	/** @brief Set the wheel geometry.
+	 *  @param wheelsDistance float, Distance between wheels, mm.
+	 *  @return Void.
+	 */
+	void init(float wheelsDistance);
+
+	/** @brief Set the speed limits.
+	 *  @param maxSpeed float, Forward speed limit, mm/s.
+	 *  @param lateralAccel float, Lateral acceleration limit, mm/s^2.
+	 *  @param accel float, Forward acceleration limit, mm/s^2.
+	 *  @return Void.
+	 */
+	void setLimits(float maxSpeed, float lateralAccel, float accel);
+
+	/** @brief Set the forward speed limit alone, a throttle knob.
+	 *  @param maxSpeed float, Forward speed limit, mm/s.
+	 *  @return Void.
+	 */
+	void setMaxSpeed(float maxSpeed);
+
+	/** @brief Set the lowest planned speed, the motors stall below it.
+	 *  @param minSpeed float, Forward speed, mm/s.
+	 *  @return Void.
+	 */
+	void setMinSpeed(float minSpeed);
+
+	/** @brief Set the line loss limit.
+	 *  @param safeError float, Largest line error at full speed, 0 to 1.
+	 *  @param minRatio float, Speed ratio left at the edge of the array, 0 to 1.
+	 *  @return Void.
+	 */
+	void setRisk(float safeError, float minRatio);
+
+	/** @brief Forget the history and stand still, call it before a run.
+	 *  @return Void.
+	 */
+	void reset();
+
+	/** @brief Plan the speed of one frame.
+	 *  @param leftDistance float, Left wheel travelled distance, mm.
+	 *  @param rightDistance float, Right wheel travelled distance, mm.
+	 *  @param lineAngle float, Line angle to the robot heading, rad.
+	 *  @param lineError float, Normalized line error, -1 to +1.
+	 *  @return float, Forward speed, mm/s.
+	 */
+	float update(float leftDistance, float rightDistance, float lineAngle, float lineError);
+
+	/** @brief Get the path curvature.
+	 *  @return float, Curvature, 1/mm, counter-clockwise positive.
+	 */
+	float getCurvature();
+
+	/** @brief Get the planned speed.
+	 *  @return float, Forward speed, mm/s.
+	 */
+	float getSpeed();
+
+#pragma endregion
+};
+
+#endif
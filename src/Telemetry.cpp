@@ -0,0 +1,234 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// Telemetry.cpp
+
+#include "Telemetry.h"
+
+#pragma region Methods
+
+bool Telemetry::addChannel(uint8_t id, const float *value, float scale, uint8_t width, uint8_t decimation)
+{
+	return add(id, SourceFloat, value, scale, width, decimation);
+}
+
+bool Telemetry::addChannel(uint8_t id, const double *value, float scale, uint8_t width, uint8_t decimation)
+{
+	return add(id, SourceDouble, value, scale, width, decimation);
+}
+
+bool Telemetry::addChannel(uint8_t id, const int *value, uint8_t width, uint8_t decimation)
+{
+	return add(id, SourceInt, value, 1.0, width, decimation);
+}
+
+bool Telemetry::addChannel(uint8_t id, const long *value, uint8_t width, uint8_t decimation)
+{
+	return add(id, SourceLong, value, 1.0, width, decimation);
+}
+
+bool Telemetry::addChannel(uint8_t id, float (*getter)(), float scale, uint8_t width, uint8_t decimation)
+{
+	return add(id, SourceGetter, (const void *)getter, scale, width, decimation);
+}
+
+void Telemetry::setBudget(uint16_t bytesPerSecond)
+{
+	m_budget = bytesPerSecond;
+	m_tokens = 0;
+	m_refillTime = millis();
+}
+
+bool Telemetry::update(Print &out)
+{
+	uint8_t *ValuesL = m_frame + 3;
+	uint16_t SizeL = TELEMETRY_HEADER_SIZE;
+	uint16_t MaskL = 0;
+
+	for (uint8_t index = 0; index < m_channelsCount; index++)
+	{
+		TelemetryChannel_t *ChannelL = &m_channels[index];
+
+		if (--ChannelL->Countdown > 0)
+		{
+			continue;
+		}
+		ChannelL->Countdown = ChannelL->Decimation;
+		MaskL |= (uint16_t)1 << index;
+
+		// Round and saturate to the packed width.
+		float ScaledL = read(ChannelL) * ChannelL->Scale;
+		int32_t LimitL = ChannelL->Width >= 4 ? 0x7FFFFFFFL : ((int32_t)1 << (8 * ChannelL->Width - 1)) - 1;
+		int32_t PackedL;
+		if (ScaledL >= (float)LimitL)
+		{
+			PackedL = LimitL;
+		}
+		else if (ScaledL <= -(float)LimitL)
+		{
+			PackedL = -LimitL;
+		}
+		else
+		{
+			PackedL = (int32_t)(ScaledL + (ScaledL < 0 ? -0.5f : 0.5f));
+		}
+
+		for (uint8_t byte = 0; byte < ChannelL->Width; byte++)
+		{
+			ValuesL[SizeL++] = (uint8_t)(PackedL >> (8 * byte));
+		}
+	}
+
+	if (MaskL == 0)
+	{
+		return false;
+	}
+
+	// The samples are taken even without room, the decimation stays in phase
+	// and the sequence gap shows the drop on the receiver.
+	if (!spend(SizeL + 5))
+	{
+		m_sequence++;
+		m_dropped++;
+		return false;
+	}
+
+	uint16_t TimeL = (uint16_t)millis();
+	ValuesL[0] = m_sequence++;
+	ValuesL[1] = TimeL & 0xFF;
+	ValuesL[2] = TimeL >> 8;
+	ValuesL[3] = MaskL & 0xFF;
+	ValuesL[4] = MaskL >> 8;
+
+	uint16_t LengthL = CommandCodec::frame(m_frame, TELEMETRY_FRAME_ID, ValuesL, SizeL);
+	out.write(m_frame, LengthL);
+
+	m_frames++;
+	m_bytes += LengthL;
+
+	return true;
+}
+
+void Telemetry::describe(Print &out)
+{
+	uint8_t ArgsL[8];
+
+	for (uint8_t index = 0; index < m_channelsCount; index++)
+	{
+		TelemetryChannel_t *ChannelL = &m_channels[index];
+
+		ArgsL[0] = index;
+		ArgsL[1] = ChannelL->Id;
+		ArgsL[2] = ChannelL->Width;
+		ArgsL[3] = ChannelL->Decimation;
+		memcpy(ArgsL + 4, &ChannelL->Scale, 4);
+
+		m_bytes += CommandCodec::write(out, TELEMETRY_DESCRIPTOR_ID, ArgsL, sizeof(ArgsL));
+	}
+}
+
+uint32_t Telemetry::getFrames()
+{
+	return m_frames;
+}
+
+uint32_t Telemetry::getDropped()
+{
+	return m_dropped;
+}
+
+uint32_t Telemetry::getBytes()
+{
+	return m_bytes;
+}
+
+#pragma endregion
+
+#pragma region Private Methods
+
+bool Telemetry::add(uint8_t id, uint8_t source, const void *value, float scale, uint8_t width, uint8_t decimation)
+{
+	if (m_channelsCount >= TELEMETRY_MAX_CHANNELS || value == nullptr)
+	{
+		return false;
+	}
+
+	TelemetryChannel_t *ChannelL = &m_channels[m_channelsCount++];
+	ChannelL->Id = id;
+	ChannelL->Source = source;
+	ChannelL->Width = width >= 4 ? 4 : (width == 2 || width == 3 ? 2 : 1);
+	ChannelL->Decimation = decimation > 0 ? decimation : 1;
+	ChannelL->Countdown = 1;
+	ChannelL->Scale = scale;
+	ChannelL->Value = value;
+
+	return true;
+}
+
+float Telemetry::read(const TelemetryChannel_t *channel)
+{
+	switch (channel->Source)
+	{
+	case SourceFloat:
+		return *(const float *)channel->Value;
+	case SourceDouble:
+		return (float)*(const double *)channel->Value;
+	case SourceInt:
+		return (float)*(const int *)channel->Value;
+	case SourceLong:
+		return (float)*(const long *)channel->Value;
+	default:
+		return ((float (*)())channel->Value)();
+	}
+}
+
+bool Telemetry::spend(uint16_t size)
+{
+	if (m_budget == 0)
+	{
+		return true;
+	}
+
+	// Token bucket, at most two full frames of burst.
+	unsigned long NowL = millis();
+	uint32_t RefillL = (uint32_t)(NowL - m_refillTime) * m_budget / 1000;
+	if (RefillL > 0)
+	{
+		m_tokens = (uint16_t)min((uint32_t)m_tokens + RefillL, (uint32_t)(2 * TELEMETRY_MAX_FRAME));
+		m_refillTime += RefillL * 1000 / m_budget;
+	}
+
+	if (m_tokens < size)
+	{
+		return false;
+	}
+
+	m_tokens -= size;
+
+	return true;
+}
+
+#pragma endregion
@@ -0,0 +1,212 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// Telemetry.h
+
+#ifndef _TELEMETRY_h
+#define _TELEMETRY_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include "CommandCodec.h"
+
+#pragma region Definitions
+
+/**
+ * @brief Maximum registered channels, one bit each in the frame mask.
+ */
+#define TELEMETRY_MAX_CHANNELS 16
+
+/**
+ * @brief Samples frame id.
+ */
+#define TELEMETRY_FRAME_ID 'T'
+
+/**
+ * @brief Channel descriptor frame id.
+ */
+#define TELEMETRY_DESCRIPTOR_ID 'C'
+
+/**
+ * @brief Sequence, time and mask before the values.
+ */
+#define TELEMETRY_HEADER_SIZE 5
+
+/**
+ * @brief Largest frame, all channels 32 bit wide.
+ */
+#define TELEMETRY_MAX_FRAME (5 + TELEMETRY_HEADER_SIZE + 4 * TELEMETRY_MAX_CHANNELS)
+
+#pragma endregion
+
+#pragma region Enums
+
+/** @brief Well known channel ids, sketch specific ones start at TM_USER. */
+enum TelemetryChannelId : uint8_t
+{
+	TM_RPM_LEFT = 1U,	///< Left wheel RPM.
+	TM_RPM_RIGHT,		///< Right wheel RPM.
+	TM_ENCODER_LEFT,	///< Left encoder count.
+	TM_ENCODER_RIGHT,	///< Right encoder count.
+	TM_PWM_LEFT,		///< Left PWM.
+	TM_PWM_RIGHT,		///< Right PWM.
+	TM_LINE_POSITION,	///< Line position.
+	TM_DISTANCE,		///< Sonar distance in cm.
+	TM_TEMPERATURE,		///< Temperature.
+	TM_RTT_P50,			///< Link round trip median, ms.
+	TM_RTT_P95,			///< Link round trip 95th percentile, ms.
+	TM_AGE_P50,			///< Command age median, ms.
+	TM_AGE_P95,			///< Command age 95th percentile, ms.
+	TM_ACTUATION_P50,	///< Command to actuation median, ms.
+	TM_ACTUATION_P95,	///< Command to actuation 95th percentile, ms.
+	TM_USER = 0x40U,	///< First sketch specific id.
+};
+
+#pragma endregion
+
+/** @brief Registered telemetry channel. */
+typedef struct
+{
+	uint8_t Id;			///< Channel id.
+	uint8_t Source;		///< Source kind.
+	uint8_t Width;		///< Packed width, 1, 2 or 4 bytes.
+	uint8_t Decimation; ///< Sent every n-th update.
+	uint8_t Countdown;	///< Updates left to the next sample.
+	float Scale;		///< Fixed point scale, packed = round(value * scale).
+	const void *Value;	///< Variable, or float (*)() getter.
+} TelemetryChannel_t;
+
+/** @brief Batched binary telemetry.
+ *
+ *  Every update() packs the due channels into one CommandCodec frame:
+ *  TELEMETRY_FRAME_ID, sequence, lower 16 bits of millis(), 16 bit mask of
+ *  the channels in the frame, then their values in registration order,
+ *  little endian fixed point. describe() sends one TELEMETRY_DESCRIPTOR_ID
+ *  frame per channel: index, id, width, decimation and the float scale.
+ *  A byte rate budget drops the frames the link has no room for.
+ *  The frames may be longer than COMMAND_MAX_PAYLOAD, it only bounds the
+ *  commands the robot receives.
+ */
+class Telemetry
+{
+protected:
+#pragma region Enums
+
+	enum TelemetrySource : uint8_t
+	{
+		SourceFloat = 0U,
+		SourceDouble,
+		SourceInt,
+		SourceLong,
+		SourceGetter,
+	};
+
+#pragma endregion
+
+#pragma region Variables
+
+	TelemetryChannel_t m_channels[TELEMETRY_MAX_CHANNELS];
+	uint8_t m_channelsCount = 0;
+
+	uint8_t m_frame[TELEMETRY_MAX_FRAME];
+	uint8_t m_sequence = 0;
+
+	uint16_t m_budget = 0;
+	uint16_t m_tokens = 0;
+	unsigned long m_refillTime = 0;
+
+	uint32_t m_frames = 0;
+	uint32_t m_dropped = 0;
+	uint32_t m_bytes = 0;
+
+#pragma endregion
+
+#pragma region Methods
+
+	bool add(uint8_t id, uint8_t source, const void *value, float scale, uint8_t width, uint8_t decimation);
+	float read(const TelemetryChannel_t *channel);
+	bool spend(uint16_t size);
+
+#pragma endregion
+
+public:
+#pragma region Methods
+
+	/** @brief Register a channel.
+	 *  @param id uint8_t, Channel id.
+	 *  @param value const float*, Variable.
+	 *  @param scale float, Fixed point scale.
+	 *  @param width uint8_t, Packed width, 1, 2 or 4 bytes.
+	 *  @param decimation uint8_t, Sent every n-th update.
+	 *  @return bool, False when the table is full.
+	 */
+	bool addChannel(uint8_t id, const float *value, float scale, uint8_t width, uint8_t decimation = 1);
+	bool addChannel(uint8_t id, const double *value, float scale, uint8_t width, uint8_t decimation = 1);
+	bool addChannel(uint8_t id, const int *value, uint8_t width, uint8_t decimation = 1);
+	bool addChannel(uint8_t id, const long *value, uint8_t width, uint8_t decimation = 1);
+	bool addChannel(uint8_t id, float (*getter)(), float scale, uint8_t width, uint8_t decimation = 1);
+
+	/** @brief Limit the link usage.
+	 *  @param bytesPerSecond uint16_t, Byte rate, zero for no limit.
+	 *  @return Void.
+	 */
+	void setBudget(uint16_t bytesPerSecond);
+
+	/** @brief Sample the due channels and send them in one frame.
+	 *  @param out Print&, Output.
+	 *  @return bool, True when a frame was sent.
+	 */
+	bool update(Print &out);
+
+	/** @brief Send the channel descriptors.
+	 *  @param out Print&, Output.
+	 *  @return Void.
+	 */
+	void describe(Print &out);
+
+	/** @brief Get sent frames count.
+	 *  @return uint32_t, Count.
+	 */
+	uint32_t getFrames();
+
+	/** @brief Get frames dropped by the budget.
+	 *  @return uint32_t, Count.
+	 */
+	uint32_t getDropped();
+
+	/** @brief Get sent bytes count.
+	 *  @return uint32_t, Count.
+	 */
+	uint32_t getBytes();
+
+#pragma endregion
+};
+
+#endif
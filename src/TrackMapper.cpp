@@ -0,0 +1,375 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// TrackMapper.cpp
+
+#include "TrackMapper.h"
+
+#pragma region Private Methods
+
+bool TrackMapper::addSegment(float length, float slope)
+{
+	if (m_count >= TRACK_MAPPER_MAX_SEGMENTS)
+	{
+		m_state = TrackFailed;
+		return false;
+	}
+
+	float CurvatureL = slope / TRACK_MAPPER_CURVATURE_UNIT;
+
+	TrackSegment_t &SegmentL = m_segments[m_count++];
+	SegmentL.Length = (uint16_t)(length + 0.5);
+	SegmentL.Curvature = (int16_t)constrain(lround(CurvatureL), -32767L, 32767L);
+	SegmentL.Limit = 0;
+	SegmentL.Entry = 0;
+
+	return true;
+}
+
+void TrackMapper::sample(float distance, float heading)
+{
+	float SpanL = distance - m_doorDistance;
+
+	// The first point opens the door around the start.
+	if (!m_doorOpen)
+	{
+		m_upper = (heading + TRACK_MAPPER_TOLERANCE - m_doorHeading) / SpanL;
+		m_lower = (heading - TRACK_MAPPER_TOLERANCE - m_doorHeading) / SpanL;
+		m_doorOpen = true;
+		m_lastDistance = distance;
+		return;
+	}
+
+	float UpperL = (heading + TRACK_MAPPER_TOLERANCE - m_doorHeading) / SpanL;
+	float LowerL = (heading - TRACK_MAPPER_TOLERANCE - m_doorHeading) / SpanL;
+	UpperL = min(m_upper, UpperL);
+	LowerL = max(m_lower, LowerL);
+
+	if (LowerL > UpperL)
+	{
+		// No line holds all points, close the segment at the previous one.
+		float SlopeL = (m_upper + m_lower) / 2.0;
+		float LengthL = m_lastDistance - m_doorDistance;
+		if (!addSegment(LengthL, SlopeL))
+		{
+			return;
+		}
+
+		m_doorHeading += SlopeL * LengthL;
+		m_doorDistance = m_lastDistance;
+
+		SpanL = distance - m_doorDistance;
+		UpperL = (heading + TRACK_MAPPER_TOLERANCE - m_doorHeading) / SpanL;
+		LowerL = (heading - TRACK_MAPPER_TOLERANCE - m_doorHeading) / SpanL;
+	}
+
+	m_upper = UpperL;
+	m_lower = LowerL;
+	m_lastDistance = distance;
+}
+
+void TrackMapper::sync(float distance, float heading)
+{
+	// The first sync level sets the turn direction and the lap position mark.
+	if (m_direction == 0)
+	{
+		if (fabs(heading) >= TRACK_MAPPER_SYNC_ANGLE)
+		{
+			m_direction = heading > 0 ? 1 : -1;
+			m_syncPosition = distance;
+			m_syncDistance = distance;
+		}
+		return;
+	}
+
+	float LevelL = 2.0 * PI * (m_turns + 1) + TRACK_MAPPER_SYNC_ANGLE;
+	if (m_direction * heading < LevelL)
+	{
+		return;
+	}
+
+	m_turns++;
+	if (m_state == TrackMapping)
+	{
+		close(distance - m_syncPosition);
+	}
+	m_syncDistance = distance;
+}
+
+void TrackMapper::close(float lapLength)
+{
+	if (m_doorOpen && !addSegment(m_lastDistance - m_doorDistance, (m_upper + m_lower) / 2.0))
+	{
+		return;
+	}
+
+	// The segments run past the lap end, cut them there.
+	float StartL = 0;
+	uint8_t CountL = 0;
+	while (CountL < m_count && StartL < lapLength)
+	{
+		TrackSegment_t &SegmentL = m_segments[CountL++];
+		if (StartL + SegmentL.Length > lapLength)
+		{
+			SegmentL.Length = (uint16_t)(lapLength - StartL + 0.5);
+		}
+		StartL += SegmentL.Length;
+	}
+	m_count = CountL;
+
+	if (m_count == 0)
+	{
+		m_state = TrackFailed;
+		return;
+	}
+
+	m_lapLength = StartL;
+	m_state = TrackReady;
+	plan();
+}
+
+#pragma endregion
+
+#pragma region Methods
+
+void TrackMapper::init(float wheelsDistance)
+{
+	m_wheelsDistance = wheelsDistance;
+
+	reset();
+	m_state = TrackIdle;
+}
+
+void TrackMapper::setLimits(float maxSpeed, float lateralAccel, float accel, float decel)
+{
+	m_maxSpeed = maxSpeed;
+	m_lateralAccel = lateralAccel;
+	m_accel = accel;
+	m_decel = decel;
+
+	if (m_state == TrackReady)
+	{
+		plan();
+	}
+}
+
+void TrackMapper::setLead(float lead)
+{
+	m_lead = lead;
+}
+
+void TrackMapper::reset()
+{
+	m_count = 0;
+	m_state = TrackMapping;
+	m_started = false;
+
+	m_distance = 0;
+	m_lastSample = 0;
+	m_doorDistance = 0;
+	m_doorHeading = 0;
+	m_doorOpen = false;
+
+	m_direction = 0;
+	m_turns = 0;
+	m_lapLength = 0;
+}
+
+void TrackMapper::update(float leftDistance, float rightDistance, float lineError)
+{
+	if (m_state != TrackMapping && m_state != TrackReady)
+	{
+		return;
+	}
+
+	// Everything is relative to the first frame.
+	if (!m_started)
+	{
+		m_lastLeft = leftDistance;
+		m_lastRight = rightDistance;
+		m_left = 0;
+		m_right = 0;
+		m_started = true;
+		return;
+	}
+
+	// The encoders count no direction, the count is signed by the command,
+	// and a line follower wheel rolls forward even when the command
+	// reverses it on a sharp turn, so only the step size is taken.
+	m_left += fabs(leftDistance - m_lastLeft);
+	m_right += fabs(rightDistance - m_lastRight);
+	m_lastLeft = leftDistance;
+	m_lastRight = rightDistance;
+
+	float HeadingL = (m_right - m_left) / m_wheelsDistance;
+	m_distance = (m_left + m_right) / 2.0;
+
+	if (m_distance - m_lastSample < TRACK_MAPPER_STEP_MM)
+	{
+		return;
+	}
+	m_lastSample = m_distance;
+
+	// Off the line the robot heading is not the line heading.
+	if (m_state == TrackMapping && fabs(lineError) < TRACK_MAPPER_MAX_ERROR)
+	{
+		sample(m_distance, HeadingL);
+	}
+
+	if (m_state == TrackMapping)
+	{
+		// No closure within a lap length, a figure eight or a lost line.
+		float MarkL = m_direction != 0 ? m_syncPosition : 0;
+		if (m_distance - MarkL > TRACK_MAPPER_MAX_LAP_MM)
+		{
+			m_state = TrackFailed;
+		}
+	}
+
+	if (m_state == TrackMapping || m_state == TrackReady)
+	{
+		sync(m_distance, HeadingL);
+	}
+}
+
+void TrackMapper::plan()
+{
+	uint8_t CountL = m_count;
+	if (CountL == 0)
+	{
+		return;
+	}
+
+	// Lateral acceleration limit of each segment.
+	for (uint8_t index = 0; index < CountL; index++)
+	{
+		TrackSegment_t &SegmentL = m_segments[index];
+		float CurvatureL = fabs(SegmentL.Curvature * TRACK_MAPPER_CURVATURE_UNIT);
+		float LimitL = m_maxSpeed;
+		if (m_lateralAccel > 0 && CurvatureL > 0)
+		{
+			LimitL = min(LimitL, (float)sqrt(m_lateralAccel / CurvatureL));
+		}
+		SegmentL.Limit = (uint16_t)LimitL;
+	}
+
+	// A segment start is under the limits of both sides.
+	for (uint8_t index = 0; index < CountL; index++)
+	{
+		uint8_t PreviousL = (index + CountL - 1) % CountL;
+		m_segments[index].Entry = min(m_segments[PreviousL].Limit, m_segments[index].Limit);
+	}
+
+	// Twice around the loop, the passes wrap over the lap start.
+	for (uint16_t step = 0; step < 2 * CountL && m_accel > 0; step++)
+	{
+		TrackSegment_t &SegmentL = m_segments[step % CountL];
+		TrackSegment_t &NextL = m_segments[(step + 1) % CountL];
+		float SpeedL = sqrt((float)SegmentL.Entry * SegmentL.Entry + 2.0 * m_accel * SegmentL.Length);
+		NextL.Entry = (uint16_t)min((float)NextL.Entry, SpeedL);
+	}
+
+	for (uint16_t step = 2 * CountL; step > 0 && m_decel > 0; step--)
+	{
+		TrackSegment_t &SegmentL = m_segments[(step - 1) % CountL];
+		TrackSegment_t &NextL = m_segments[step % CountL];
+		float SpeedL = sqrt((float)NextL.Entry * NextL.Entry + 2.0 * m_decel * SegmentL.Length);
+		SegmentL.Entry = (uint16_t)min((float)SegmentL.Entry, SpeedL);
+	}
+}
+
+TrackState TrackMapper::getState()
+{
+	return m_state;
+}
+
+float TrackMapper::getSpeed()
+{
+	if (m_state != TrackReady)
+	{
+		return m_maxSpeed;
+	}
+
+	float PositionL = fmod(getPosition() + m_lead, m_lapLength);
+
+	// Find the segment under the lead point.
+	uint8_t IndexL = 0;
+	float StartL = 0;
+	while (IndexL < m_count - 1 && StartL + m_segments[IndexL].Length <= PositionL)
+	{
+		StartL += m_segments[IndexL].Length;
+		IndexL++;
+	}
+
+	const TrackSegment_t &SegmentL = m_segments[IndexL];
+	const TrackSegment_t &NextL = m_segments[(IndexL + 1) % m_count];
+	float OffsetL = constrain(PositionL - StartL, 0.0f, (float)SegmentL.Length);
+
+	// Under the segment limit, reachable from its entry and able to brake for the next one.
+	float SpeedL = SegmentL.Limit;
+	if (m_accel > 0)
+	{
+		SpeedL = min(SpeedL, (float)sqrt((float)SegmentL.Entry * SegmentL.Entry + 2.0 * m_accel * OffsetL));
+	}
+	if (m_decel > 0)
+	{
+		SpeedL = min(SpeedL, (float)sqrt((float)NextL.Entry * NextL.Entry + 2.0 * m_decel * (SegmentL.Length - OffsetL)));
+	}
+
+	return SpeedL;
+}
+
+float TrackMapper::getPosition()
+{
+	if (m_state != TrackReady)
+	{
+		return m_distance;
+	}
+
+	return fmod(m_syncPosition + (m_distance - m_syncDistance), m_lapLength);
+}
+
+float TrackMapper::getLapLength()
+{
+	return m_lapLength;
+}
+
+uint8_t TrackMapper::getSegmentsCount()
+{
+	return m_count;
+}
+
+const TrackSegment_t *TrackMapper::getSegment(uint8_t index)
+{
+	if (index >= m_count)
+	{
+		return nullptr;
+	}
+
+	return &m_segments[index];
+}
+
+#pragma endregion
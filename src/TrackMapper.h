@@ -0,0 +1,255 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// TrackMapper.h
+
+#ifndef _TRACKMAPPER_h
+#define _TRACKMAPPER_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#pragma region Definitions
+
+#if defined(__AVR__)
+/**
+ * @brief Segments of one lap.
+ */
+#define TRACK_MAPPER_MAX_SEGMENTS 24
+#else
+/**
+ * @brief Segments of one lap.
+ */
+#define TRACK_MAPPER_MAX_SEGMENTS 96
+#endif
+
+/**
+ * @brief Travelled distance between two heading samples, mm.
+ */
+#define TRACK_MAPPER_STEP_MM 10.0
+
+/**
+ * @brief Heading error a segment may hold, rad, over the encoder step and the steering wobble.
+ */
+#define TRACK_MAPPER_TOLERANCE 0.25
+
+/**
+ * @brief Heading turned from the start that marks the lap position, rad.
+ */
+#define TRACK_MAPPER_SYNC_ANGLE (PI / 2.0)
+
+/**
+ * @brief Largest line error of a heading sample, the robot is off the line past it.
+ */
+#define TRACK_MAPPER_MAX_ERROR 0.9
+
+/**
+ * @brief Longest lap, mm, a track that does not close in it is not mapped.
+ */
+#define TRACK_MAPPER_MAX_LAP_MM 30000.0
+
+/**
+ * @brief Curvature unit of the segments, 1/mm.
+ */
+#define TRACK_MAPPER_CURVATURE_UNIT 1e-5
+
+#pragma endregion
+
+#pragma region Enums
+
+/** @brief Track mapper state. */
+enum TrackState : uint8_t
+{
+	TrackIdle = 0U, ///< Not started.
+	TrackMapping,	///< First lap, recording.
+	TrackReady,		///< Profile running.
+	TrackFailed,	///< Too many segments or no lap closure.
+};
+
+#pragma endregion
+
+/** @brief Track segment of constant curvature. */
+typedef struct
+{
+	uint16_t Length;   ///< Length, mm.
+	int16_t Curvature; ///< Curvature, TRACK_MAPPER_CURVATURE_UNIT, counter-clockwise positive.
+	uint16_t Limit;	   ///< Lateral acceleration speed limit, mm/s.
+	uint16_t Entry;	   ///< Profile speed at the segment start, mm/s.
+} TrackSegment_t;
+
+/** @brief Track learning and lap speed profile.
+ *
+ *  During the first lap the robot heading, from the wheel distance
+ *  difference of the encoder step sizes, is sampled against the
+ *  travelled distance while the line is under the sensors, so the robot
+ *  heading is the line heading up to the steering wobble. A swinging
+ *  door fit cuts it into segments of constant curvature, each holds the
+ *  heading within TRACK_MAPPER_TOLERANCE, so the wobble and the encoder
+ *  steps fold into one segment per straight or arc.
+ *
+ *  A closed track turns a full circle per lap. The lap length is the
+ *  distance between the first time the heading turned
+ *  TRACK_MAPPER_SYNC_ANGLE and the time it turned that plus a circle, no
+ *  start marker is needed, wherever the run starts. The same heading
+ *  level resyncs the lap position on every later lap, so the odometry
+ *  error does not add up. A figure eight turns no net circle and is not
+ *  mapped.
+ *
+ *  Once the lap closes, the segments get the speed that keeps their
+ *  lateral acceleration under the limit, and a forward pass at the
+ *  acceleration limit and a backward pass at the braking limit, both
+ *  around the loop, give the speed at every segment start. getSpeed()
+ *  reads the profile a lead distance ahead, to cover the motor lag.
+ */
+class TrackMapper
+{
+protected:
+#pragma region Variables
+
+	float m_wheelsDistance = 130;
+
+	float m_maxSpeed = 0;
+	float m_lateralAccel = 0;
+	float m_accel = 0;
+	float m_decel = 0;
+	float m_lead = 0;
+
+	TrackSegment_t m_segments[TRACK_MAPPER_MAX_SEGMENTS];
+	uint8_t m_count = 0;
+	TrackState m_state = TrackIdle;
+
+	bool m_started = false;
+	float m_lastLeft = 0;
+	float m_lastRight = 0;
+	float m_left = 0;
+	float m_right = 0;
+	float m_lastSample = 0;
+	float m_distance = 0;
+
+	float m_doorDistance = 0;
+	float m_doorHeading = 0;
+	float m_lastDistance = 0;
+	float m_upper = 0;
+	float m_lower = 0;
+	bool m_doorOpen = false;
+
+	int8_t m_direction = 0;
+	uint8_t m_turns = 0;
+	float m_syncPosition = 0;
+	float m_syncDistance = 0;
+	float m_lapLength = 0;
+
+#pragma endregion
+
+#pragma region Methods
+
+	bool addSegment(float length, float slope);
+	void sample(float distance, float heading);
+	void sync(float distance, float heading);
+	void close(float lapLength);
+
+#pragma endregion
+
+public:
+#pragma region Methods
+
+	/** @brief Set the wheel geometry.
+	 *  @param wheelsDistance float, Distance between wheels, mm.
+	 *  @return Void.
+	 */
+	void init(float wheelsDistance);
+
+	/** @brief Set the profile limits, a ready profile is planned again.
+	 *  @param maxSpeed float, Forward speed limit, mm/s.
+	 *  @param lateralAccel float, Lateral acceleration limit, mm/s^2.
+	 *  @param accel float, Forward acceleration limit, mm/s^2.
+	 *  @param decel float, Braking limit, mm/s^2.
+	 *  @return Void.
+	 */
+	void setLimits(float maxSpeed, float lateralAccel, float accel, float decel);
+
+	/** @brief Set the lead of the profile reading.
+	 *  @param lead float, Distance ahead, mm.
+	 *  @return Void.
+	 */
+	void setLead(float lead);
+
+	/** @brief Forget the track, the mapping starts at the next update.
+	 *  @return Void.
+	 */
+	void reset();
+
+	/** @brief Take one frame.
+	 *  @param leftDistance float, Left wheel travelled distance, mm.
+	 *  @param rightDistance float, Right wheel travelled distance, mm.
+	 *  @param lineError float, Normalized line error, -1 to +1.
+	 *  @return Void.
+	 */
+	void update(float leftDistance, float rightDistance, float lineError);
+
+	/** @brief Plan the speed profile of the mapped segments.
+	 *  @return Void.
+	 */
+	void plan();
+
+	/** @brief Get the state.
+	 *  @return TrackState, State.
+	 */
+	TrackState getState();
+
+	/** @brief Get the profile speed ahead.
+	 *  @return float, Forward speed, mm/s, the speed limit until the profile is ready.
+	 */
+	float getSpeed();
+
+	/** @brief Get the lap position.
+	 *  @return float, Distance from the lap start, mm.
+	 */
+	float getPosition();
+
+	/** @brief Get the lap length.
+	 *  @return float, Length, mm, zero until the lap closed.
+	 */
+	float getLapLength();
+
+	/** @brief Get the segments count.
+	 *  @return uint8_t, Count.
+	 */
+	uint8_t getSegmentsCount();
+
+	/** @brief Get a segment.
+	 *  @param index uint8_t, Segment index.
+	 *  @return const TrackSegment_t*, Segment, nullptr when out of range.
+	 */
+	const TrackSegment_t *getSegment(uint8_t index);
+
+#pragma endregion
+};
+
+#endif
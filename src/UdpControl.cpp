@@ -0,0 +1,201 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// UdpControl.cpp
+
+#include "UdpControl.h"
+
+#if defined(ESP32)
+
+#pragma region Methods
+
+bool UdpControlClass::begin(uint16_t port, CommandCodec &codec)
+{
+	m_codec = &codec;
+	m_synced = false;
+	m_timedOut = true;
+
+	return m_udp.begin(port) == 1;
+}
+
+bool UdpControlClass::update()
+{
+	bool PendingL = false;
+	unsigned long NowL = millis();
+
+	for (uint8_t budget = 0; budget < UDP_CONTROL_BUDGET; budget++)
+	{
+		int SizeL = m_udp.parsePacket();
+		if (SizeL <= 0)
+		{
+			break;
+		}
+
+		if (SizeL > UDP_CONTROL_MAX_DATAGRAM)
+		{
+			// parsePacket() drops the rest with the next call.
+			m_errors++;
+			continue;
+		}
+
+		uint8_t PayloadL = CommandCodec::unframe(m_datagram, m_udp.read(m_datagram, SizeL));
+		if (PayloadL < 1 + UDP_CONTROL_HEADER_SIZE + 1 || m_datagram[2] != UDP_CONTROL_ID)
+		{
+			m_errors++;
+			continue;
+		}
+
+		if (accept(PayloadL, NowL))
+		{
+			if (PendingL)
+			{
+				m_superseded++;
+			}
+			PendingL = true;
+		}
+	}
+
+	if (PendingL)
+	{
+		m_timedOut = false;
+		m_applied++;
+		m_codec->dispatch(m_command, m_commandSize);
+		return true;
+	}
+
+	if (!m_timedOut && NowL - m_acceptTime > UDP_CONTROL_TIMEOUT_MS)
+	{
+		// The sender is gone, its next frame starts a new sequence.
+		m_timedOut = true;
+		m_synced = false;
+		m_timeouts++;
+
+		if (callbackTimeout != nullptr)
+		{
+			callbackTimeout();
+		}
+	}
+
+	return false;
+}
+
+void UdpControlClass::setCbTimeout(void (*callback)())
+{
+	callbackTimeout = callback;
+}
+
+bool UdpControlClass::isAlive()
+{
+	return !m_timedOut;
+}
+
+uint16_t UdpControlClass::getAge()
+{
+	return m_age;
+}
+
+uint32_t UdpControlClass::getApplied()
+{
+	return m_applied;
+}
+
+uint32_t UdpControlClass::getSuperseded()
+{
+	return m_superseded;
+}
+
+uint32_t UdpControlClass::getStale()
+{
+	return m_stale;
+}
+
+uint32_t UdpControlClass::getLate()
+{
+	return m_late;
+}
+
+uint32_t UdpControlClass::getErrors()
+{
+	return m_errors;
+}
+
+uint32_t UdpControlClass::getTimeouts()
+{
+	return m_timeouts;
+}
+
+#pragma endregion
+
+#pragma region Private Methods
+
+bool UdpControlClass::accept(uint8_t size, unsigned long now)
+{
+	const uint8_t *ArgsL = m_datagram + 3;
+	uint16_t SequenceL = (uint16_t)CommandCodec::getInt16(ArgsL);
+	uint16_t DelayL = (uint16_t)now - (uint16_t)CommandCodec::getInt16(ArgsL + 2);
+
+	if (m_synced && (int16_t)(SequenceL - m_sequence) <= 0)
+	{
+		// Duplicate or overtaken by a newer frame.
+		m_stale++;
+		return false;
+	}
+
+	if (!m_synced || (int16_t)(DelayL - m_delayMin) < 0)
+	{
+		m_delayMin = DelayL;
+		m_driftTime = now;
+	}
+	else if (now - m_driftTime >= UDP_CONTROL_DRIFT_MS)
+	{
+		m_delayMin++;
+		m_driftTime = now;
+	}
+
+	m_synced = true;
+	m_sequence = SequenceL;
+
+	uint16_t AgeL = DelayL - m_delayMin;
+	if (AgeL > UDP_CONTROL_MAX_AGE_MS)
+	{
+		// Too old to drive with, a newer one is on the way.
+		m_late++;
+		return false;
+	}
+
+	m_age = AgeL;
+	m_acceptTime = now;
+	m_commandSize = size - 1 - UDP_CONTROL_HEADER_SIZE;
+	memcpy(m_command, ArgsL + UDP_CONTROL_HEADER_SIZE, m_commandSize);
+
+	return true;
+}
+
+#pragma endregion
+
+UdpControlClass UdpControl;
+
+#endif // ESP32
@@ -0,0 +1,199 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// UdpControl.h
+
+#ifndef _UDPCONTROL_h
+#define _UDPCONTROL_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#if defined(ESP32)
+
+#include <WiFi.h>
+#include <WiFiUdp.h>
+
+#include "CommandCodec.h"
+
+/**
+ * @brief Control datagram frame id.
+ */
+#define UDP_CONTROL_ID 'U'
+
+/**
+ * @brief Sequence and send time before the command.
+ */
+#define UDP_CONTROL_HEADER_SIZE 4
+
+/**
+ * @brief Largest datagram taken, one frame with a full payload.
+ */
+#define UDP_CONTROL_MAX_DATAGRAM (COMMAND_MAX_PAYLOAD + 4)
+
+/**
+ * @brief No valid frame for this long stops the robot.
+ */
+#define UDP_CONTROL_TIMEOUT_MS 300
+
+/**
+ * @brief Frames delayed this much over the fastest one are stale.
+ */
+#define UDP_CONTROL_MAX_AGE_MS 150
+
+/**
+ * @brief The fastest delay relaxes one millisecond this often, follows the clocks drift.
+ */
+#define UDP_CONTROL_DRIFT_MS 1000
+
+/**
+ * @brief Most datagrams read in one update.
+ */
+#define UDP_CONTROL_BUDGET 8
+
+/** @brief Latest wins UDP control channel.
+ *
+ *  Datagram: one CommandCodec frame with the UDP_CONTROL_ID id, the arguments
+ *  are the 16 bit sequence, the lower 16 bits of the sender millis() and the
+ *  command payload, id and arguments, all little endian.
+ *
+ *  update() reads the waiting datagrams and drops the ones with an old
+ *  sequence or delayed more than UDP_CONTROL_MAX_AGE_MS over the fastest
+ *  seen, then dispatches only the newest command. The delay needs no clock
+ *  sync, only its change counts. No valid frame for UDP_CONTROL_TIMEOUT_MS
+ *  calls the timeout callback once and the next frame starts a new sequence.
+ */
+class UdpControlClass
+{
+protected:
+#pragma region Variables
+
+	WiFiUDP m_udp;
+	CommandCodec *m_codec = nullptr;
+
+	uint8_t m_datagram[UDP_CONTROL_MAX_DATAGRAM];
+	uint8_t m_command[COMMAND_MAX_PAYLOAD];
+	uint8_t m_commandSize = 0;
+
+	bool m_synced = false;
+	bool m_timedOut = true;
+	uint16_t m_sequence = 0;
+	uint16_t m_delayMin = 0;
+	uint16_t m_age = 0;
+	unsigned long m_acceptTime = 0;
+	unsigned long m_driftTime = 0;
+
+	uint32_t m_applied = 0;
+	uint32_t m_superseded = 0;
+	uint32_t m_stale = 0;
+	uint32_t m_late = 0;
+	uint32_t m_errors = 0;
+	uint32_t m_timeouts = 0;
+
+	/** @brief Dead man timeout callback. */
+	void (*callbackTimeout)() = nullptr;
+
+#pragma endregion
+
+#pragma region Methods
+
+	bool accept(uint8_t size, unsigned long now);
+
+#pragma endregion
+
+public:
+#pragma region Methods
+
+	/** @brief Listen for control datagrams.
+	 *  @param port uint16_t, Local port.
+	 *  @param codec CommandCodec&, Handlers of the commands.
+	 *  @return bool, False when the socket fails.
+	 */
+	bool begin(uint16_t port, CommandCodec &codec);
+
+	/** @brief Take the waiting datagrams and apply the newest, call it every loop.
+	 *  @return bool, True when a command was applied.
+	 */
+	bool update();
+
+	/** @brief Set the dead man timeout callback.
+	 *  @param callback void (*)(), Callback.
+	 *  @return Void.
+	 */
+	void setCbTimeout(void (*callback)());
+
+	/** @brief Frames arrive in time.
+	 *  @return bool, True while the sender is alive.
+	 */
+	bool isAlive();
+
+	/** @brief Get the last applied frame delay over the fastest one.
+	 *  @return uint16_t, Age in ms.
+	 */
+	uint16_t getAge();
+
+	/** @brief Get applied commands count.
+	 *  @return uint32_t, Count.
+	 */
+	uint32_t getApplied();
+
+	/** @brief Get valid frames replaced by a newer one in the same update.
+	 *  @return uint32_t, Count.
+	 */
+	uint32_t getSuperseded();
+
+	/** @brief Get frames dropped for an old sequence.
+	 *  @return uint32_t, Count.
+	 */
+	uint32_t getStale();
+
+	/** @brief Get frames dropped for too much delay.
+	 *  @return uint32_t, Count.
+	 */
+	uint32_t getLate();
+
+	/** @brief Get malformed datagrams count.
+	 *  @return uint32_t, Count.
+	 */
+	uint32_t getErrors();
+
+	/** @brief Get dead man timeouts count.
+	 *  @return uint32_t, Count.
+	 */
+	uint32_t getTimeouts();
+
+#pragma endregion
+};
+
+/** @brief UDP control channel instance. */
+extern UdpControlClass UdpControl;
+
+#endif // ESP32
+
+#endif
@@ -0,0 +1,251 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// WiFiLink.cpp
+
+#include "WiFiLink.h"
+
+#if defined(ESP32)
+
+#include <lwip/sockets.h>
+
+#pragma region Methods
+
+void WiFiLinkClass::begin(const char *ssid, const char *pass, IPAddress host, uint16_t port)
+{
+	m_ssid = ssid;
+	m_pass = pass;
+	m_host = host;
+	m_port = port;
+	m_backoff = WIFI_LINK_BACKOFF_MIN_MS;
+
+	// Joining runs in the Wi-Fi task.
+	WiFi.mode(WIFI_STA);
+	WiFi.begin(m_ssid, m_pass);
+	setState(LinkJoining);
+}
+
+void WiFiLinkClass::update()
+{
+	unsigned long ElapsedL = millis() - m_stateTime;
+
+	switch (m_state)
+	{
+	case LinkIdle:
+		break;
+
+	case LinkJoining:
+		if (WiFi.status() == WL_CONNECTED)
+		{
+			startConnect();
+		}
+		else if (ElapsedL > WIFI_LINK_JOIN_TIMEOUT_MS)
+		{
+			WiFi.disconnect();
+			fail();
+		}
+		break;
+
+	case LinkConnecting:
+		checkConnect();
+		break;
+
+	case LinkConnected:
+		if (!m_client.connected())
+		{
+			m_client.stop();
+			fail();
+		}
+		break;
+
+	case LinkBackoff:
+		if (ElapsedL >= m_backoff)
+		{
+			m_backoff = min(m_backoff * 2, (unsigned long)WIFI_LINK_BACKOFF_MAX_MS);
+
+			if (WiFi.status() == WL_CONNECTED)
+			{
+				startConnect();
+			}
+			else
+			{
+				WiFi.begin(m_ssid, m_pass);
+				setState(LinkJoining);
+			}
+		}
+		break;
+	}
+}
+
+void WiFiLinkClass::reconnect()
+{
+	if (m_state == LinkConnected)
+	{
+		m_client.stop();
+	}
+	closeSocket();
+	fail();
+}
+
+void WiFiLinkClass::setCbState(void (*callback)(LinkState state))
+{
+	callbackState = callback;
+}
+
+LinkState WiFiLinkClass::getState()
+{
+	return m_state;
+}
+
+bool WiFiLinkClass::isConnected()
+{
+	return m_state == LinkConnected;
+}
+
+WiFiClient &WiFiLinkClass::getClient()
+{
+	return m_client;
+}
+
+uint32_t WiFiLinkClass::getAttempts()
+{
+	return m_attempts;
+}
+
+uint32_t WiFiLinkClass::getConnects()
+{
+	return m_connects;
+}
+
+#pragma endregion
+
+#pragma region Private Methods
+
+void WiFiLinkClass::setState(LinkState state)
+{
+	m_state = state;
+	m_stateTime = millis();
+
+	if (callbackState != nullptr)
+	{
+		callbackState(state);
+	}
+}
+
+void WiFiLinkClass::startConnect()
+{
+	struct sockaddr_in AddressL;
+
+	m_attempts++;
+
+	m_socket = lwip_socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (m_socket < 0)
+	{
+		fail();
+		return;
+	}
+
+	// The connect returns at once and completes in the TCP/IP task.
+	lwip_fcntl(m_socket, F_SETFL, lwip_fcntl(m_socket, F_GETFL, 0) | O_NONBLOCK);
+
+	memset(&AddressL, 0, sizeof(AddressL));
+	AddressL.sin_family = AF_INET;
+	AddressL.sin_port = htons(m_port);
+	AddressL.sin_addr.s_addr = (uint32_t)m_host;
+
+	if (lwip_connect(m_socket, (struct sockaddr *)&AddressL, sizeof(AddressL)) < 0 && errno != EINPROGRESS)
+	{
+		closeSocket();
+		fail();
+		return;
+	}
+
+	setState(LinkConnecting);
+}
+
+void WiFiLinkClass::checkConnect()
+{
+	fd_set WriteSetL;
+	struct timeval TimeoutL = {0, 0};
+
+	FD_ZERO(&WriteSetL);
+	FD_SET(m_socket, &WriteSetL);
+
+	// Poll, do not wait.
+	int ReadyL = lwip_select(m_socket + 1, NULL, &WriteSetL, NULL, &TimeoutL);
+	if (ReadyL == 0)
+	{
+		if (millis() - m_stateTime > WIFI_LINK_CONNECT_TIMEOUT_MS)
+		{
+			closeSocket();
+			fail();
+		}
+		return;
+	}
+
+	int ErrorL = 0;
+	socklen_t LengthL = sizeof(ErrorL);
+	if (ReadyL < 0 || lwip_getsockopt(m_socket, SOL_SOCKET, SO_ERROR, &ErrorL, &LengthL) < 0 || ErrorL != 0)
+	{
+		closeSocket();
+		fail();
+		return;
+	}
+
+	// The client owns the socket from here.
+	m_client = WiFiClient(m_socket);
+	m_socket = -1;
+	m_connects++;
+	m_backoff = WIFI_LINK_BACKOFF_MIN_MS;
+	setState(LinkConnected);
+}
+
+void WiFiLinkClass::fail()
+{
+	// Spread the retries of several robots.
+	m_stateTime = millis() - random(0, m_backoff / 4);
+	m_state = LinkBackoff;
+
+	if (callbackState != nullptr)
+	{
+		callbackState(LinkBackoff);
+	}
+}
+
+void WiFiLinkClass::closeSocket()
+{
+	if (m_socket >= 0)
+	{
+		lwip_close(m_socket);
+		m_socket = -1;
+	}
+}
+
+#pragma endregion
+
+WiFiLinkClass WiFiLink;
+
+#endif // ESP32
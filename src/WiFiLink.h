@@ -0,0 +1,174 @@
+/*
+
+MIT License
+
+Copyright (c) [2023] [OpenMOBot]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+// WiFiLink.h
+
+#ifndef _WIFILINK_h
+#define _WIFILINK_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#if defined(ESP32)
+
+#include <WiFi.h>
+
+/**
+ * @brief First retry delay.
+ */
+#define WIFI_LINK_BACKOFF_MIN_MS 250
+
+/**
+ * @brief Longest retry delay.
+ */
+#define WIFI_LINK_BACKOFF_MAX_MS 8000
+
+/**
+ * @brief Time to join the access point before a retry.
+ */
+#define WIFI_LINK_JOIN_TIMEOUT_MS 10000
+
+/**
+ * @brief Time for the host to accept the socket before a retry.
+ */
+#define WIFI_LINK_CONNECT_TIMEOUT_MS 2000
+
+/** @brief Link state. */
+enum LinkState : uint8_t
+{
+	LinkIdle = 0U,	  ///< begin() not called.
+	LinkJoining,	  ///< Joining the access point.
+	LinkConnecting,	  ///< Socket connect in progress.
+	LinkConnected,	  ///< Socket connected.
+	LinkBackoff,	  ///< Waiting for the next attempt.
+};
+
+/** @brief Non blocking Wi-Fi and TCP client link.
+ *
+ *  update() makes one step of the link state machine and never waits,
+ *  the socket connect runs in the background on a non blocking socket.
+ *  Failed attempts retry after a delay doubled up to WIFI_LINK_BACKOFF_MAX_MS.
+ */
+class WiFiLinkClass
+{
+protected:
+#pragma region Variables
+
+	const char *m_ssid = nullptr;
+	const char *m_pass = nullptr;
+	IPAddress m_host;
+	uint16_t m_port = 0;
+
+	WiFiClient m_client;
+	int m_socket = -1;
+
+	LinkState m_state = LinkIdle;
+	unsigned long m_stateTime = 0;
+	unsigned long m_backoff = WIFI_LINK_BACKOFF_MIN_MS;
+
+	uint32_t m_attempts = 0;
+	uint32_t m_connects = 0;
+
+	/** @brief State change callback. */
+	void (*callbackState)(LinkState state) = nullptr;
+
+#pragma endregion
+
+#pragma region Methods
+
+	void setState(LinkState state);
+	void startConnect();
+	void checkConnect();
+	void fail();
+	void closeSocket();
+
+#pragma endregion
+
+public:
+#pragma region Methods
+
+	/** @brief Start the link, returns at once.
+	 *  @param ssid const char*, Access point name.
+	 *  @param pass const char*, Access point password.
+	 *  @param host IPAddress, Host address.
+	 *  @param port uint16_t, Host port.
+	 *  @return Void.
+	 */
+	void begin(const char *ssid, const char *pass, IPAddress host, uint16_t port);
+
+	/** @brief Advance the link, call it every loop.
+	 *  @return Void.
+	 */
+	void update();
+
+	/** @brief Drop the socket and connect again after the backoff.
+	 *  @return Void.
+	 */
+	void reconnect();
+
+	/** @brief Set the state change callback.
+	 *  @param callback void (*)(LinkState), Callback.
+	 *  @return Void.
+	 */
+	void setCbState(void (*callback)(LinkState state));
+
+	/** @brief Get link state.
+	 *  @return LinkState, State.
+	 */
+	LinkState getState();
+
+	/** @brief Socket is connected.
+	 *  @return bool, True when connected.
+	 */
+	bool isConnected();
+
+	/** @brief Get the socket client, valid while connected.
+	 *  @return WiFiClient&, Client.
+	 */
+	WiFiClient &getClient();
+
+	/** @brief Get connect attempts count.
+	 *  @return uint32_t, Count.
+	 */
+	uint32_t getAttempts();
+
+	/** @brief Get successful connects count.
+	 *  @return uint32_t, Count.
+	 */
+	uint32_t getConnects();
+
+#pragma endregion
+};
+
+/** @brief Wi-Fi link instance. */
+extern WiFiLinkClass WiFiLink;
+
+#endif // ESP32
+
+#endif
@@ -26,54 +26,126 @@ SOFTWARE.
 
 #include "utils.h"
 
-/** @brief Transform [X, Y] coordinates to [L, R] PWM values.
- *  @param xyData X and Y "joystick" data.
- *  @return LRData_t Left and Right PWM transformation values.
+/** @brief Apply a shaping curve to a signed axis value.
+ *  @param value int, Axis value [-255 to 255].
+ *  @param curve const MixerCurve_t*, Curve, nullptr for linear.
+ *  @return int Shaped value.
  */
-LRData_t xy_to_lr(XYData_t xyData)
+static inline int shape_axis(int value, const MixerCurve_t *curve)
+{
+	if (curve == nullptr)
+	{
+		return value;
+	}
+
+	// Stretch the magnitude to [0 to 256] so the full input hits the last point.
+	int MagnitudeL = min(abs(value), 255);
+	MagnitudeL += MagnitudeL >> 7;
+
+	int ShapedL;
+	uint8_t IndexL = MagnitudeL >> MIXER_CURVE_SHIFT;
+	if (IndexL >= MIXER_CURVE_POINTS - 1)
+	{
+		ShapedL = curve->Points[MIXER_CURVE_POINTS - 1];
+	}
+	else
+	{
+		uint8_t FractionL = MagnitudeL & ((1 << MIXER_CURVE_SHIFT) - 1);
+		int LowL = curve->Points[IndexL];
+		int HighL = curve->Points[IndexL + 1];
+		ShapedL = LowL + (((HighL - LowL) * FractionL) >> MIXER_CURVE_SHIFT);
+	}
+
+	return value < 0 ? -ShapedL : ShapedL;
+}
+
+/** @brief Build a mixer shaping curve, call once at setup.
+ *  @param curve MixerCurve_t*, Curve to fill.
+ *  @param deadZone uint8_t, Input magnitude [0 to 255] mapped to zero.
+ *  @param expo uint8_t, Cubic share of the curve in percent [0 to 100].
+ *  @param rate uint8_t, Output at full input in percent [0 to 100].
+ *  @return Void.
+ */
+void mixer_build_curve(MixerCurve_t *curve, uint8_t deadZone, uint8_t expo, uint8_t rate)
 {
-	static LRData_t LRDataL;
+	float ExpoL = min(expo, (uint8_t)100) / 100.0;
+	float RateL = min(rate, (uint8_t)100) / 100.0;
 
-	// Throttle (Y axis) and direction (X axis).
-	static int ThrottleL, DirectionL = 0;
+	// Points are spaced on the stretched [0 to 256] magnitude scale.
+	int DeadZoneL = deadZone + (deadZone >> 7);
 
-	// Left Motor helper variables.
-	int leftMotor;
-	float leftMotorScale = 0;
+	for (uint8_t index = 0; index < MIXER_CURVE_POINTS; index++)
+	{
+		int InputL = index << MIXER_CURVE_SHIFT;
 
-	// Right Motor helper variables.
-	int rightMotor;
-	float rightMotorScale = 0;
+		if (InputL <= DeadZoneL)
+		{
+			curve->Points[index] = 0;
+			continue;
+		}
 
-	// Holds the mixed output scaling factor.
-	float maxMotorScale = 0;
+		// Normalize the input outside of the dead zone.
+		float XL = (float)(InputL - DeadZoneL) / (256 - DeadZoneL);
+		float YL = RateL * (ExpoL * XL * XL * XL + (1.0 - ExpoL) * XL);
 
-	// Clear PWM data.
-	LRDataL.L = 0;
-	LRDataL.R = 0;
+		curve->Points[index] = constrain((int)(YL * 255.0 + 0.5), 0, 255);
+	}
+}
+
+/** @brief Transform [X, Y] coordinates to [L, R] PWM values through shaping curves.
+ *  @param xyData X and Y "joystick" data.
+ *  @param throttle const MixerCurve_t*, Y axis curve, nullptr for linear.
+ *  @param direction const MixerCurve_t*, X axis curve, nullptr for linear.
+ *  @return LRData_t Left and Right PWM transformation values.
+ */
+LRData_t xy_to_lr(XYData_t xyData, const MixerCurve_t *throttle, const MixerCurve_t *direction)
+{
+	LRData_t LRDataL;
 
 	// Acquire the analog input for X and Y.
 	// Then rescale the 0..1023 range to -255..255 range.
-	ThrottleL = (512 - xyData.Y) / 2;
-	DirectionL = -(512 - xyData.X) / 2;
+	int ThrottleL = shape_axis((512 - xyData.Y) / 2, throttle);
+	int DirectionL = shape_axis(-(512 - xyData.X) / 2, direction);
 
 	// Mix throttle and direction
-	leftMotor = ThrottleL + DirectionL;
-	rightMotor = ThrottleL - DirectionL;
+	int LeftMotorL = ThrottleL + DirectionL;
+	int RightMotorL = ThrottleL - DirectionL;
 
-	// Calculate the scale of the results in comparision base 8 bit PWM resolution
-	leftMotorScale = leftMotor / 255.0;
-	leftMotorScale = abs(leftMotorScale);
-	rightMotorScale = rightMotor / 255.0;
-	rightMotorScale = abs(rightMotorScale);
+	// Scale both down by the larger one if it is above the 8 bit PWM resolution.
+	int MaxMotorL = max(abs(LeftMotorL), abs(RightMotorL));
+	if (MaxMotorL > 255)
+	{
+		LeftMotorL = (long)LeftMotorL * 255 / MaxMotorL;
+		RightMotorL = (long)RightMotorL * 255 / MaxMotorL;
+	}
 
-	// Choose the max scale value if it is above 1
-	maxMotorScale = max(leftMotorScale, rightMotorScale);
-	maxMotorScale = max(1.0f, maxMotorScale);
-
-	// and apply it to the mixed values
-	LRDataL.L = constrain(leftMotor / maxMotorScale, -255, 255);
-	LRDataL.R = constrain(rightMotor / maxMotorScale, -255, 255);
+	LRDataL.L = constrain(LeftMotorL, -255, 255);
+	LRDataL.R = constrain(RightMotorL, -255, 255);
 
 	return LRDataL;
-}
\ No newline at end of file
+}
+
+/** @brief Transform [X, Y] coordinates to [L, R] PWM values.
+ *  @param xyData X and Y "joystick" data.
+ *  @return LRData_t Left and Right PWM transformation values.
+ */
+LRData_t xy_to_lr(XYData_t xyData)
+{
+	return xy_to_lr(xyData, nullptr, nullptr);
+}
+
+/** @brief Transform a stream of [X, Y] coordinates to [L, R] PWM values.
+ *  @param xyData const XYData_t*, Input samples.
+ *  @param lrData LRData_t*, Output samples.
+ *  @param count size_t, Samples count.
+ *  @param throttle const MixerCurve_t*, Y axis curve, nullptr for linear.
+ *  @param direction const MixerCurve_t*, X axis curve, nullptr for linear.
+ *  @return Void.
+ */
+void xy_to_lr_batch(const XYData_t *xyData, LRData_t *lrData, size_t count, const MixerCurve_t *throttle, const MixerCurve_t *direction)
+{
+	for (size_t index = 0; index < count; index++)
+	{
+		lrData[index] = xy_to_lr(xyData[index], throttle, direction);
+	}
+}
@@ -37,6 +37,7 @@ SOFTWARE.
 
 #include "XYData.h"
 #include "LRData.h"
+#include "MixerCurve.h"
 
 /** @brief Transform [X, Y] coordinates to [L, R] PWM values.
  *  @param xyData X and Y "joystick" data.
@@ -44,4 +45,31 @@ SOFTWARE.
  */
 LRData_t xy_to_lr(XYData_t xyData);
 
+/** @brief Build a mixer shaping curve, call once at setup.
+ *  @param curve MixerCurve_t*, Curve to fill.
+ *  @param deadZone uint8_t, Input magnitude [0 to 255] mapped to zero.
+ *  @param expo uint8_t, Cubic share of the curve in percent [0 to 100].
+ *  @param rate uint8_t, Output at full input in percent [0 to 100].
+ *  @return Void.
+ */
+void mixer_build_curve(MixerCurve_t *curve, uint8_t deadZone, uint8_t expo, uint8_t rate);
+
+/** @brief Transform [X, Y] coordinates to [L, R] PWM values through shaping curves.
+ *  @param xyData X and Y "joystick" data.
+ *  @param throttle const MixerCurve_t*, Y axis curve, nullptr for linear.
+ *  @param direction const MixerCurve_t*, X axis curve, nullptr for linear.
+ *  @return LRData_t Left and Right PWM transformation values.
+ */
+LRData_t xy_to_lr(XYData_t xyData, const MixerCurve_t *throttle, const MixerCurve_t *direction);
+
+/** @brief Transform a stream of [X, Y] coordinates to [L, R] PWM values.
+ *  @param xyData const XYData_t*, Input samples.
+ *  @param lrData LRData_t*, Output samples.
+ *  @param count size_t, Samples count.
+ *  @param throttle const MixerCurve_t*, Y axis curve, nullptr for linear.
+ *  @param direction const MixerCurve_t*, X axis curve, nullptr for linear.
+ *  @return Void.
+ */
+void xy_to_lr_batch(const XYData_t *xyData, LRData_t *lrData, size_t count, const MixerCurve_t *throttle, const MixerCurve_t *direction);
+
 #endif